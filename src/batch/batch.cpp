@@ -0,0 +1,335 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../emu/cpu/8086_cpu.h"
+#include "../emu/hardware/a20.h"
+#include "../emu/rom_file.h"
+
+// Headless batch runner.
+//
+// Every line of the job list is "image script cycles", with - for
+// no image or script. Jobs run on their own machine in slices, so a
+// worker that runs out of jobs can steal the rest of a long one.
+// Prints a hash of the final CPU state and RAM and the host time of
+// every job once all are done.
+//
+// There's no disk controller yet, so the image is loaded where the
+// IPL would have read it to and started there directly, without the
+// BIOS setting anything up first. Jobs without an image run the BIOS.
+// Script lines are "cycle irq n", "cycle nmi" or
+// "cycle poke address byte", fired by the scheduler.
+
+// Short enough that long jobs get spread out over idle workers
+static constexpr size_t slice_cycles = 1000000;
+
+// Where the PC-98 IPL loads the boot sector
+static constexpr size_t ipl_address = 0x1FC00;
+
+struct ScriptEvent {
+    enum Kind {
+        Irq,
+        Nmi,
+        Poke
+    };
+    size_t clock;
+    Kind kind;
+    uint32_t address;
+    uint8_t value;
+};
+
+struct Job {
+    const char* image;
+    const char* script;
+    size_t budget;
+
+    std::vector<ScriptEvent> events;
+    z86Machine* machine;
+    HW_A20 a20;
+    size_t cycles;
+    uint64_t hash;
+    std::chrono::steady_clock::duration time;
+    bool failed;
+};
+
+struct WorkQueue {
+    std::mutex lock;
+    std::deque<Job*> jobs;
+};
+
+static const void* bios;
+static size_t bios_size;
+
+static std::vector<WorkQueue> queues;
+static std::atomic<size_t> unfinished;
+
+// Idle workers sleep until a job is requeued or the last one finishes
+static std::mutex idle_lock;
+static std::condition_variable idle;
+static size_t requeued;
+
+static void fire_event(void* data, size_t clock) {
+    const ScriptEvent& event = *(const ScriptEvent*)data;
+    switch (event.kind) {
+        case ScriptEvent::Irq: z86_interrupt(event.value); break;
+        case ScriptEvent::Nmi: z86_nmi(); break;
+        case ScriptEvent::Poke: z86_mem_write(event.address, event.value); break;
+    }
+}
+
+static bool load_script(Job& job) {
+    if (!strcmp(job.script, "-")) {
+        return true;
+    }
+    FILE* file = fopen(job.script, "r");
+    if (!file) {
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        ScriptEvent event = {};
+        char kind[16];
+        unsigned long long clock;
+        unsigned int address, value;
+        if (line[0] == '#' || sscanf(line, "%llu %15s", &clock, kind) != 2) {
+            continue;
+        }
+        event.clock = clock;
+        if (!strcmp(kind, "irq") && sscanf(line, "%*s %*s %i", &value) == 1) {
+            event.kind = ScriptEvent::Irq;
+            event.value = value;
+        }
+        else if (!strcmp(kind, "nmi")) {
+            event.kind = ScriptEvent::Nmi;
+        }
+        else if (!strcmp(kind, "poke") && sscanf(line, "%*s %*s %i %i", &address, &value) == 2) {
+            event.kind = ScriptEvent::Poke;
+            event.address = address;
+            event.value = value;
+        }
+        else {
+            fprintf(stderr, "%s: bad line: %s", job.script, line);
+            continue;
+        }
+        job.events.push_back(event);
+    }
+    fclose(file);
+    return true;
+}
+
+// Builds the job's machine, which is selected afterwards
+static bool start_job(Job& job) {
+    job.machine = z86_create_machine();
+    if (!job.machine) {
+        return false;
+    }
+    z86_select_machine(job.machine);
+    z86_map_rom(0xE8000, bios, bios_size);
+    z86_map_byte_ports(&job.a20, HW_A20::first_port, HW_A20::last_port, HW_A20::port_stride);
+
+    if (strcmp(job.image, "-")) {
+        FILE* file = fopen(job.image, "rb");
+        if (!file) {
+            return false;
+        }
+        // Up to the end of conventional memory
+        std::vector<uint8_t> image(0xA0000 - ipl_address);
+        size_t length = fread(image.data(), 1, image.size(), file);
+        fclose(file);
+        z86_mem_write(ipl_address, image.data(), length);
+    }
+
+    z86_init();
+    if (strcmp(job.image, "-")) {
+        z86_jump(ipl_address >> 4, 0);
+    }
+    for (const ScriptEvent& event : job.events) {
+        z86_schedule(event.clock, fire_event, (void*)&event);
+    }
+    return true;
+}
+
+// FNV-1a
+static void hash_bytes(uint64_t& hash, const void* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ ((const uint8_t*)data)[i]) * 0x100000001B3;
+    }
+}
+
+// Registers, flags, segments and clock, then all of RAM
+static uint64_t hash_state() {
+    uint64_t hash = 0xCBF29CE484222325;
+    z86Registers registers = {};
+    z86_get_registers(registers);
+    hash_bytes(hash, &registers, sizeof(registers));
+    uint64_t clock = z86_clock();
+    hash_bytes(hash, &clock, sizeof(clock));
+    uint8_t buffer[0x10000];
+    for (size_t addr = 0;; addr += sizeof(buffer)) {
+        size_t length = z86_mem_read(buffer, addr, sizeof(buffer));
+        if (!length) {
+            break;
+        }
+        hash_bytes(hash, buffer, length);
+    }
+    return hash;
+}
+
+static void finish_job(Job& job) {
+    if (!job.failed) {
+        job.hash = hash_state();
+    }
+    z86_select_machine(NULL);
+    z86_destroy_machine(job.machine);
+    job.machine = NULL;
+    if (!--unfinished) {
+        // Taking the lock orders this against a worker about to wait
+        { std::lock_guard<std::mutex> guard(idle_lock); }
+        idle.notify_all();
+    }
+}
+
+// Own queue from the back, other queues from the front
+static Job* take_job(size_t worker) {
+    for (size_t i = 0; i < queues.size(); ++i) {
+        WorkQueue& queue = queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (!queue.jobs.empty()) {
+            Job* job;
+            if (!i) {
+                job = queue.jobs.back();
+                queue.jobs.pop_back();
+            }
+            else {
+                job = queue.jobs.front();
+                queue.jobs.pop_front();
+            }
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static void worker_main(size_t worker) {
+    while (unfinished) {
+        size_t seen;
+        {
+            std::lock_guard<std::mutex> guard(idle_lock);
+            seen = requeued;
+        }
+        Job* job = take_job(worker);
+        if (!job) {
+            // Whatever is left is mid slice on another worker
+            std::unique_lock<std::mutex> guard(idle_lock);
+            idle.wait(guard, [=] { return requeued != seen || !unfinished; });
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (!job->machine) {
+            if (!start_job(*job)) {
+                job->failed = true;
+                finish_job(*job);
+                continue;
+            }
+        }
+        else {
+            z86_select_machine(job->machine);
+        }
+        job->cycles += z86_run((std::min)(slice_cycles, job->budget - job->cycles));
+        job->time += std::chrono::steady_clock::now() - start;
+        if (job->cycles >= job->budget) {
+            finish_job(*job);
+        }
+        else {
+            {
+                WorkQueue& queue = queues[worker];
+                std::lock_guard<std::mutex> guard(queue.lock);
+                queue.jobs.push_back(job);
+            }
+            {
+                std::lock_guard<std::mutex> guard(idle_lock);
+                ++requeued;
+            }
+            idle.notify_one();
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr,
+            "usage: %s jobs [threads]\n"
+            "Each line of jobs is \"image script cycles\", - for no image or script.\n"
+            "Images are loaded at %05zXh and started there without the BIOS.\n",
+            argv[0], ipl_address);
+        return 1;
+    }
+    size_t threads = argc > 2 ? strtoul(argv[2], NULL, 0) : std::thread::hardware_concurrency();
+    threads = (std::max)(threads, (size_t)1);
+
+    bios = map_rom_file("BIOS.ROM", bios_size);
+    if (!bios) {
+        fprintf(stderr, "BIOS.ROM not found\n");
+        return 1;
+    }
+
+    FILE* list = fopen(argv[1], "r");
+    if (!list) {
+        fprintf(stderr, "can't open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<Job> jobs;
+    char line[1024];
+    while (fgets(line, sizeof(line), list)) {
+        char image[480], script[480];
+        unsigned long long budget;
+        if (line[0] == '#' || sscanf(line, "%479s %479s %llu", image, script, &budget) != 3) {
+            continue;
+        }
+        Job job = {};
+        job.image = strdup(image);
+        job.script = strdup(script);
+        job.budget = budget;
+        if (!load_script(job)) {
+            fprintf(stderr, "can't open %s\n", script);
+            return 1;
+        }
+        jobs.push_back(std::move(job));
+    }
+    fclose(list);
+
+    queues = std::vector<WorkQueue>(threads);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        queues[i % threads].jobs.push_back(&jobs[i]);
+    }
+    unfinished = jobs.size();
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(worker_main, i);
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    printf("# image\tscript\tcycles\thash\tms\n");
+    for (const Job& job : jobs) {
+        if (job.failed) {
+            printf("%s\t%s\tfailed\n", job.image, job.script);
+            continue;
+        }
+        printf("%s\t%s\t%zu\t%016llx\t%.3f\n", job.image, job.script, job.cycles, (unsigned long long)job.hash,
+            std::chrono::duration<double, std::milli>(job.time).count());
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../emu/cpu/8086_cpu.h"
+
+// Interpreter dispatch benchmark.
+//
+// Runs a short mix of ALU, memory, stack and branch instructions
+// in a loop for a fixed number of cycles and reports host branch
+// mispredicts per guest loop alongside the emulated clock rate.
+// Built as PC98BenchThreaded with the computed goto dispatch,
+// PC98BenchSwitch with the plain opcode switch and, on x86-64 POSIX
+// hosts, PC98BenchJit with the block translator, so they can be
+// compared on the same host.
+
+// The CPU headers default to threaded where the compiler supports it
+#if defined(USE_JIT) && USE_JIT
+static constexpr const char* dispatch_name = "jit";
+#elif defined(USE_THREADED_DISPATCH) && !USE_THREADED_DISPATCH
+static constexpr const char* dispatch_name = "switch";
+#else
+static constexpr const char* dispatch_name = "threaded";
+#endif
+
+static constexpr uint16_t code_address = 0x1000;
+static constexpr size_t counter_address = 0x3000;
+
+static const uint8_t code[] = {
+    0xB9, 0xE8, 0x03,             // 1000: MOV CX, 1000
+    0x01, 0xD8,                   // 1003: ADD AX, BX
+    0x31, 0xC2,                   // 1005: XOR DX, AX
+    0x46,                         // 1007: INC SI
+    0x81, 0xE6, 0xFF, 0x0F,       // 1008: AND SI, 0FFFh
+    0x88, 0x84, 0x00, 0x20,       // 100C: MOV [SI+2000h], AL
+    0x39, 0xD0,                   // 1010: CMP AX, DX
+    0x74, 0x03,                   // 1012: JZ 1017
+    0x83, 0xEB, 0x03,             // 1014: SUB BX, 3
+    0x50,                         // 1017: PUSH AX
+    0x5B,                         // 1018: POP BX
+    0xD1, 0xE0,                   // 1019: SHL AX, 1
+    0x83, 0xD2, 0x00,             // 101B: ADC DX, 0
+    0x8B, 0x3C,                   // 101E: MOV DI, [SI]
+    0xE2, 0xE1,                   // 1020: LOOP 1003
+    0x83, 0x06, 0x00, 0x30, 0x01, // 1022: ADD WORD [3000h], 1
+    0x83, 0x16, 0x02, 0x30, 0x00, // 1027: ADC WORD [3002h], 0
+    0xEB, 0xD2                    // 102C: JMP 1000
+};
+
+static int open_counter(uint64_t config) {
+    perf_event_attr attr = {};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t read_counter(int fd) {
+    uint64_t value;
+    if (fd < 0 || read(fd, &value, sizeof(value)) != sizeof(value)) {
+        return 0;
+    }
+    return value;
+}
+
+int main(int argc, char* argv[]) {
+    static const struct {
+        const char* name;
+        CpuModel model;
+    } models[] = {
+        { "8086", Model8086 },
+        { "80186", Model80186 },
+        { "v30", ModelV30 },
+        { "80286", Model80286 },
+        { "80386", Model80386 }
+    };
+
+    CpuModel model = Model8086;
+    const char* model_name = argc > 1 ? argv[1] : "8086";
+    size_t i = 0;
+    for (; i < sizeof(models) / sizeof(models[0]); ++i) {
+        if (!strcmp(models[i].name, model_name)) {
+            model = models[i].model;
+            break;
+        }
+    }
+    size_t cycles = argc > 2 ? strtoull(argv[2], NULL, 0) : 500000000;
+    if (i == sizeof(models) / sizeof(models[0]) || !cycles) {
+        fprintf(stderr,
+            "usage: %s [8086|80186|v30|80286|80386] [cycles]\n"
+            "Run under PC98BenchThreaded, PC98BenchSwitch and PC98BenchJit to compare.\n",
+            argv[0]);
+        return 1;
+    }
+
+    z86Machine* machine = z86_create_machine(model);
+    if (!machine) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    z86_select_machine(machine);
+    z86_init();
+    z86_mem_write(code_address, code, sizeof(code));
+    z86_jump(0, code_address);
+
+    // Unavailable counters (no PMU, perf_event_paranoid) just read 0
+    int misses = open_counter(PERF_COUNT_HW_BRANCH_MISSES);
+    int branches = open_counter(PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+    if (misses < 0 || branches < 0) {
+        fprintf(stderr, "branch counters unavailable, try perf stat -e branch-misses\n");
+    }
+    for (int fd : { misses, branches }) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
+    size_t ran = z86_run(cycles);
+    auto time = std::chrono::steady_clock::now() - start;
+    for (int fd : { misses, branches }) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    uint32_t loops;
+    z86_mem_read(loops, counter_address);
+    uint64_t miss_count = read_counter(misses);
+    uint64_t branch_count = read_counter(branches);
+
+    double ms = std::chrono::duration<double, std::milli>(time).count();
+    printf("# dispatch\tmodel\tcycles\tloops\tms\tMHz\tbranches\tmisses\tmisses/loop\n");
+    printf("%s\t%s\t%zu\t%u\t%.3f\t%.2f\t%llu\t%llu\t%.3f\n", dispatch_name, model_name, ran, loops, ms,
+        ran / (ms * 1000.0), (unsigned long long)branch_count, (unsigned long long)miss_count,
+        loops ? (double)miss_count / loops : 0.0);
+
+    z86_select_machine(NULL);
+    z86_destroy_machine(machine);
+    return 0;
+}
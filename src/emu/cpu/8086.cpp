@@ -8,7 +8,10 @@
 #include <tuple>
 #include <limits>
 #include <atomic>
+#include <new>
 #include <vector>
+#include <algorithm>
+#include <initializer_list>
 
 #if __INTELLISENSE__ && !_HAS_CXX20
 #define TEMP_DEF_CXX20 1
@@ -25,24 +28,70 @@
 
 #include "../zero/util.h"
 
+#include "z86_machine.h"
+
+#if !_WIN32
+#include <sys/mman.h>
+#endif
+
+// Every CPU model gets its own build of this file, this one is the
+// 8086. Internal linkage keeps the builds' instantiations apart.
+#ifndef Z86_MODEL
+#define Z86_MODEL z8086
+#define Z86_MODEL_FACTORY z86_new_machine_8086
+#endif
+
+namespace {
+
 #include "z86_core_internal_pre.h"
+#include "z86_cycles.h"
+#include "z86_scheduler.h"
+#include "z86_ports.h"
+
+//using z8086Core = z86Core<z80286, FLAG_CPUID_MMX | FLAG_CPUID_SSE | FLAG_CPUID_SSE2 | FLAG_CPUID_SSE3 /*, FLAG_OPCODES_80186 | FLAG_OPCODES_80286 | FLAG_OPCODES_80386 | FLAG_OPCODES_80486 | FLAG_CPUID_CMOV*/>;
+using z8086Core = z86Core<Z86_MODEL>;
 
-static z86Memory<1_MB> mem;
+// 20 address lines before the 286, 24 on the 286, and
+// the 386 is capped to keep the page tables small
+static inline constexpr size_t z86_address_space = z8086Core::max_bits > 16 ? 64_MB : z8086Core::PROTECTED_MODE ? 16_MB : 1_MB;
 
-//struct z8086Context : z86Core<z80286, FLAG_CPUID_MMX | FLAG_CPUID_SSE | FLAG_CPUID_SSE2 | FLAG_CPUID_SSE3 /*, FLAG_OPCODES_80186 | FLAG_OPCODES_80286 | FLAG_OPCODES_80386 | FLAG_OPCODES_80486 | FLAG_CPUID_CMOV*/> {
-struct z8086Context : z86Core<z8086> {
+struct z8086Context : z8086Core {
 
     // Internal state
     std::atomic<bool> pending_nmi;
     std::atomic<bool> halted;
     std::atomic<int16_t> pending_einterrupt;
+    std::atomic<uint32_t> run_events;
+    std::atomic<uint32_t> wakeups; // Bumped whenever a halted CPU should recheck its state
     size_t clock;
+    uint8_t cycle_mem;
+    bool emulation_mode; // V20 8080 mode, MD clear
+    bool md_writable; // Between BRKEM and RETEM
+#if USE_DECODE_CACHE
+    // Entry of the instruction being executed, NULL when it isn't cached
+    z86DecodeEntry* decode_entry;
+#endif
+
+    static inline constexpr const z86CycleTable& cycles = z86_cycles<model>;
 
     inline constexpr void init() {
-        memset(this, 0, sizeof(*this));
+        // Only the core is plain data, everything
+        // after it is reset member by member
+        memset((void*)static_cast<z8086Core*>(this), 0, sizeof(z8086Core));
+        this->pending_nmi = false;
+        this->halted = false;
+        this->pending_einterrupt = -1;
+        this->run_events = 0;
+        this->wakeups = 0;
+        this->clock = 0;
+        this->cycle_mem = 0;
+        this->emulation_mode = false;
+        this->md_writable = false;
+#if USE_DECODE_CACHE
+        this->decode_entry = NULL;
+#endif
         this->reset_descriptors();
         this->reset_ip();
-        this->pending_einterrupt = -1;
         this->pending_sinterrupt = -1;
     }
 
@@ -56,23 +105,49 @@ struct z8086Context : z86Core<z8086> {
     // Instruction implementations
     template <typename T = uint16_t>
     inline T get_flags() const {
-        uint16_t base = 0b111100000000010;
-        base |= this->carry;
-        base |= (uint32_t)this->parity << 2;
-        base |= (uint32_t)this->auxiliary << 4;
-        base |= (uint32_t)this->zero << 6;
-        base |= (uint32_t)this->sign << 7;
+        // Bits 12-15 read as set before the 286
+        uint16_t base = PROTECTED_MODE ? 0b0000000000000010 : 0b1111000000000010;
+        base |= this->get_carry();
+        base |= (uint32_t)this->get_parity() << 2;
+        base |= (uint32_t)this->get_auxiliary() << 4;
+        base |= (uint32_t)this->get_zero() << 6;
+        base |= (uint32_t)this->get_sign() << 7;
         if constexpr (sizeof(T) == sizeof(uint16_t)) {
             base |= (uint32_t)this->trap << 8;
             base |= (uint32_t)this->interrupt << 9;
             base |= (uint32_t)this->direction << 10;
-            base |= (uint32_t)this->overflow << 11;
+            base |= (uint32_t)this->get_overflow() << 11;
+            if constexpr (OPCODES_V20) {
+                // MD, clear while running 8080 code
+                base &= ~((uint32_t)this->emulation_mode << 15);
+            }
         }
         return base;
     }
 
+    // MD only changes between BRKEM and RETEM, so native code
+    // popping a clear bit 15 doesn't drop into 8080 mode
+    inline void restore_mode(uint16_t flags) {
+        if constexpr (OPCODES_V20) {
+            if (this->md_writable) {
+                this->emulation_mode = !(flags & 0x8000);
+            }
+        }
+    }
+
+    inline void BRKEM(uint8_t number);
+
+    inline void RETEM() {
+        this->ip = this->POP();
+        this->cs = this->POP();
+        this->set_flags(this->POP());
+        this->emulation_mode = false;
+        this->md_writable = false;
+    }
+
     template <typename T = uint16_t>
     inline void set_flags(T src) {
+        this->resolve_flags();
         this->carry = src & 0x01;
         this->parity = src & 0x04;
         this->auxiliary = src & 0x10;
@@ -80,7 +155,7 @@ struct z8086Context : z86Core<z8086> {
         this->sign = src & 0x80;
         if constexpr (sizeof(T) == sizeof(uint16_t)) {
             this->trap = src & 0x0100;
-            this->interrupt = src & 0x0200;
+            this->set_interrupt(src & 0x0200);
             this->direction = src & 0x0400;
             this->overflow = src & 0x0800;
         }
@@ -100,6 +175,7 @@ struct z8086Context : z86Core<z8086> {
             if constexpr (set_halt) {
                 this->halted = false;
             }
+            this->run_events.fetch_or(EventInterrupt, std::memory_order_relaxed);
             this->call_interrupt(IntNMI);
         }
     }
@@ -112,46 +188,105 @@ struct z8086Context : z86Core<z8086> {
                 if constexpr (set_halt) {
                     this->halted = false;
                 }
+                this->run_events.fetch_or(EventInterrupt, std::memory_order_relaxed);
                 this->call_interrupt(external);
             }
         }
     }
 
-    inline void call_interrupt(uint8_t number) {
-        this->PUSH(this->get_flags());
-        this->interrupt = false;
-        bool prev_trap = this->trap;
-        this->trap = false;
-        this->PUSH(this->cs);
-        this->PUSH(this->rip);
+    // Clock accounting
+    inline void instruction_cycles(uint8_t opcode, uint8_t map) {
+        if (expect(!map, true)) {
+            this->clock += cycles.reg[opcode];
+            this->cycle_mem = cycles.mem[opcode] - cycles.reg[opcode];
+        }
+        else {
+            this->clock += cycles.extended;
+            this->cycle_mem = 0;
+        }
+    }
 
-        size_t interrupt_addr = (size_t)number << 2;
-        this->cs = mem.read<uint16_t>(interrupt_addr);
-        this->ip = mem.read<uint16_t>(interrupt_addr + 2);
+    inline void memory_operand_cycles(uint8_t ea) {
+        this->clock += this->cycle_mem + ea;
+    }
 
-        this->check_for_nmi();
-        if (prev_trap) {
-            this->call_interrupt(IntDB);
+    inline void branch_cycles(bool taken) {
+        this->clock += taken ? cycles.branch_taken : 0;
+    }
+
+    inline void shift_cycles(uint8_t count) {
+        this->clock += (size_t)count * cycles.shift_count;
+    }
+
+    inline void bcd_string_cycles() {
+        this->clock += (size_t)((this->cl + 1) >> 1) * cycles.bcd_string;
+    }
+
+    inline size_t rep_count() const {
+        return this->rep_type != NO_REP ? this->cx : 0;
+    }
+
+    // Caps a REP run at the next scheduler deadline, which
+    // a waiting interrupt has already pulled in to now
+    inline void rep_begin(uint8_t opcode, size_t deadline) {
+        this->rep_yield = false;
+        size_t cost = cycles.rep[opcode];
+        if (!cost) {
+            this->rep_limit = SIZE_MAX;
+        }
+        else {
+            this->rep_limit = this->clock < deadline ? (deadline - this->clock) / cost + 1 : 1;
+        }
+    }
+
+    // Replaces the single iteration cost charged at dispatch
+    inline void rep_cycles(uint8_t opcode, size_t start_count) {
+        if (this->rep_type != NO_REP) {
+            this->clock -= cycles.reg[opcode];
+            this->clock += cycles.rep_base + (uint16_t)(start_count - this->cx) * cycles.rep[opcode];
         }
     }
 
+    inline void call_interrupt(uint8_t number);
+
+    // Returns true if still halted
+    inline bool check_for_wakeup() {
+        this->check_for_nmi<true>();
+        this->check_for_external_interrupt<true>();
+        return this->halted;
+    }
+
+    // NMIs and external interrupts come in through the scheduler
+    // deadline instead, see run_until
     inline void execute_pending_interrupts() {
         this->check_for_software_interrupt();
-        do {
-            this->check_for_nmi<true>();
-            this->check_for_external_interrupt<true>();
-        } while (this->halted);
         if (this->trap) {
             this->call_interrupt(IntDB);
         }
     }
 
+    // Nothing for the loop head or next_instr to do, so the
+    // next instruction can start straight from its handler
+    inline bool can_chain() const {
+        bool ret = this->pending_sinterrupt < 0 && !this->trap && !this->access_faulted();
+        if constexpr (OPCODES_V20) {
+            ret &= !this->emulation_mode;
+        }
+        return ret;
+    }
+
+    inline void wake();
+    inline void halt();
+    inline void set_interrupt(bool enabled);
+
     inline void external_interrupt(uint8_t number) {
         this->pending_einterrupt = number;
+        this->wake();
     }
 
     inline void nmi() {
         this->pending_nmi = true;
+        this->wake();
     }
 
     inline void cancel_interrupt() {
@@ -159,64 +294,318 @@ struct z8086Context : z86Core<z8086> {
     }
 };
 
-static z8086Context ctx;
+#if USE_DECODE_CACHE
+// Prefix state can only be replayed when there's no size/REX prefix state
+static inline constexpr bool decode_cache_enabled = z8086Context::max_bits == 16 && !z8086Context::PROTECTED_MODE;
+#endif
+
+#if USE_JIT
+#include "z86_jit.h"
+#endif
 
-static std::vector<PortDwordDevice*> io_dword_devices;
-static std::vector<PortWordDevice*> io_word_devices;
-static std::vector<PortByteDevice*> io_byte_devices;
+// Everything one emulated PC owns. Machines share nothing,
+// so each can run on its own thread.
+struct z86MachineImpl final : z86Machine {
+    z86Memory<z86_address_space> mem;
+    z8086Context ctx;
+
+    z86PortMap<PortDwordDevice> io_dword_ports;
+    z86PortMap<PortWordDevice> io_word_ports;
+    z86PortMap<PortByteDevice> io_byte_ports;
+
+    z86Scheduler scheduler;
+
+#if USE_DECODE_CACHE
+    z86DecodeCache<8192> decode_cache;
+#endif
+#if USE_JIT
+    z86Jit<z8086Context, z86Memory<z86_address_space>> jit;
+#endif
+
+    ~z86MachineImpl() override;
+
+    void select() override;
+    size_t mem_write(size_t dst, const void* src, size_t size) override;
+    size_t mem_read(void* dst, size_t src, size_t size) override;
+    void map_memory_device(MemoryDevice* device, size_t first, size_t length) override;
+    void map_ram(size_t first, size_t length) override;
+    bool set_memory_size(size_t bytes) override;
+    void set_a20(bool enabled) override;
+    bool a20() override;
+    void map_rom(size_t first, const void* data, size_t length) override;
+    void load_rom(size_t first, const void* data, size_t length) override;
+    void add_dword_device(PortDwordDevice* device) override;
+    void add_word_device(PortWordDevice* device) override;
+    void add_byte_device(PortByteDevice* device) override;
+    bool map_dword_ports(PortDwordDevice* device, uint16_t first, uint16_t last, uint16_t stride) override;
+    bool map_word_ports(PortWordDevice* device, uint16_t first, uint16_t last, uint16_t stride) override;
+    bool map_byte_ports(PortByteDevice* device, uint16_t first, uint16_t last, uint16_t stride) override;
+    size_t unhandled_port_accesses() override;
+    void reset() override;
+    void jump(uint16_t cs, uint16_t ip) override;
+    void get_registers(z86Registers& registers) override;
+    void nmi() override;
+    void interrupt(uint8_t number) override;
+    void cancel_interrupt() override;
+    void stop() override;
+    uint32_t run_events() override;
+    size_t clock() override;
+    uint32_t schedule(size_t clock, SchedulerCallback callback, void* data) override;
+    bool deschedule(uint32_t id) override;
+    void init() override;
+    size_t run_until(uint32_t events, size_t cycles) override;
+};
+
+// Machine of this model the calling thread last selected
+static thread_local z86MachineImpl* machine = NULL;
+
+// The core helpers refer to these by name, so they resolve
+// through the current machine instead of being globals.
+// They're only defined over the core headers, the machine's
+// own methods and the execute loop use its members directly.
+#define ctx (machine->ctx)
+#define mem (machine->mem)
+#define io_dword_ports (machine->io_dword_ports)
+#define io_word_ports (machine->io_word_ports)
+#define io_byte_ports (machine->io_byte_ports)
+#define scheduler (machine->scheduler)
+
+inline void z8086Context::call_interrupt(uint8_t number) {
+    this->clock += cycles.interrupt;
+    this->PUSH(this->get_flags());
+    this->interrupt = false;
+    bool prev_trap = this->trap;
+    this->trap = false;
+    if constexpr (OPCODES_V20) {
+        // Handlers are native code, IRET restores the mode
+        this->emulation_mode = false;
+    }
+    this->PUSH(this->cs);
+    this->PUSH(this->rip);
+
+    size_t interrupt_addr = (size_t)number << 2;
+    this->ip = mem.read<uint16_t>(interrupt_addr);
+    this->cs = mem.read<uint16_t>(interrupt_addr + 2);
+
+    this->check_for_nmi();
+    if (prev_trap) {
+        this->call_interrupt(IntDB);
+    }
+}
+
+// Requests only reach the execute loop through the deadline
+inline void z8086Context::wake() {
+    scheduler.raise_attention();
+    this->wakeups.fetch_add(1, std::memory_order_release);
+    this->wakeups.notify_one();
+}
+
+inline void z8086Context::halt() {
+    this->halted = true;
+    scheduler.raise_attention();
+}
+
+// An interrupt held back by IF has to be looked at again
+inline void z8086Context::set_interrupt(bool enabled) {
+    if (enabled && !this->interrupt && this->pending_einterrupt.load(std::memory_order_relaxed) > 0) {
+        scheduler.raise_attention();
+    }
+    this->interrupt = enabled;
+}
+
+// Like INT, but IF/TF are kept and the handler runs as 8080 code
+inline void z8086Context::BRKEM(uint8_t number) {
+    this->clock += cycles.interrupt;
+    this->PUSH(this->get_flags());
+    this->PUSH(this->cs);
+    this->PUSH(this->ip);
+    this->emulation_mode = true;
+    this->md_writable = true;
+
+    size_t interrupt_addr = (size_t)number << 2;
+    this->ip = mem.read<uint16_t>(interrupt_addr);
+    this->cs = mem.read<uint16_t>(interrupt_addr + 2);
+}
 
 #include "z86_core_internal_post.h"
+#include "z86_8080.h"
+
+#undef ctx
+#undef mem
+#undef io_dword_ports
+#undef io_word_ports
+#undef io_byte_ports
+#undef scheduler
+
+// Don't leave the thread pointing at freed memory
+z86MachineImpl::~z86MachineImpl() {
+    if (machine == this) {
+        machine = NULL;
+    }
+}
+
+void z86MachineImpl::select() {
+    machine = this;
+}
 
-dllexport size_t z86_mem_write(size_t dst, const void* src, size_t size) {
+size_t z86MachineImpl::mem_write(size_t dst, const void* src, size_t size) {
     return mem.write(dst, src, size);
 }
-dllexport size_t z86_mem_read(void* dst, size_t src, size_t size) {
+size_t z86MachineImpl::mem_read(void* dst, size_t src, size_t size) {
     return mem.read(dst, src, size);
 }
 
-dllexport void z86_add_dword_device(PortDwordDevice* device) {
-    //io_dword_devices.push_back(device);
+void z86MachineImpl::map_memory_device(MemoryDevice* device, size_t first, size_t length) {
+    mem.map_device(device, first, length);
+    ctx.flush_tlb();
 }
-dllexport void z86_add_word_device(PortWordDevice* device) {
-    io_word_devices.push_back(device);
+void z86MachineImpl::map_ram(size_t first, size_t length) {
+    mem.map_ram(first, length);
+    ctx.flush_tlb();
 }
-dllexport void z86_add_byte_device(PortByteDevice* device) {
-    io_byte_devices.push_back(device);
+bool z86MachineImpl::set_memory_size(size_t bytes) {
+    ctx.flush_tlb();
+    return mem.resize(bytes);
+}
+void z86MachineImpl::set_a20(bool enabled) {
+    mem.set_a20(enabled);
+    ctx.flush_tlb();
+}
+bool z86MachineImpl::a20() {
+    return mem.a20();
+}
+void z86MachineImpl::map_rom(size_t first, const void* data, size_t length) {
+    if (first < mem.max_size) {
+        mem.map_rom(first, (std::min)(mem.max_size - first, length), data);
+        ctx.flush_tlb();
+    }
+}
+void z86MachineImpl::load_rom(size_t first, const void* data, size_t length) {
+    if (first < mem.size) {
+        length = (std::min)(mem.size - first, length);
+        memcpy(mem.ptr(first), data, length);
+        mem.map_rom(first, length);
+        ctx.flush_tlb();
+    }
 }
 
-dllexport void z86_reset() {
+void z86MachineImpl::add_dword_device(PortDwordDevice* device) {
+    io_dword_ports.add(device);
+}
+void z86MachineImpl::add_word_device(PortWordDevice* device) {
+    io_word_ports.add(device);
+}
+void z86MachineImpl::add_byte_device(PortByteDevice* device) {
+    io_byte_ports.add(device);
+}
+
+bool z86MachineImpl::map_dword_ports(PortDwordDevice* device, uint16_t first, uint16_t last, uint16_t stride) {
+    return io_dword_ports.map(device, first, last, stride);
+}
+bool z86MachineImpl::map_word_ports(PortWordDevice* device, uint16_t first, uint16_t last, uint16_t stride) {
+    return io_word_ports.map(device, first, last, stride);
+}
+bool z86MachineImpl::map_byte_ports(PortByteDevice* device, uint16_t first, uint16_t last, uint16_t stride) {
+    return io_byte_ports.map(device, first, last, stride);
+}
+
+size_t z86MachineImpl::unhandled_port_accesses() {
+    return io_byte_ports.unhandled + io_word_ports.unhandled + io_dword_ports.unhandled;
+}
+
+void z86MachineImpl::reset() {
     ctx.reset();
 }
 
-dllexport void z86_nmi() {
+void z86MachineImpl::jump(uint16_t cs, uint16_t ip) {
+    ctx.write_seg(CS, cs);
+    ctx.rip = ip;
+}
+
+void z86MachineImpl::get_registers(z86Registers& registers) {
+    for (size_t i = 0; i < countof(registers.gpr); ++i) {
+        registers.gpr[i] = ctx.gpr[i].dword;
+    }
+    registers.ip = ctx.rip;
+    registers.flags = ctx.get_flags();
+    for (size_t i = 0; i < countof(registers.seg); ++i) {
+        registers.seg[i] = ctx.seg[i];
+    }
+}
+
+void z86MachineImpl::nmi() {
     ctx.nmi();
 }
 
-dllexport void z86_interrupt(uint8_t number) {
+void z86MachineImpl::interrupt(uint8_t number) {
     ctx.external_interrupt(number);
 }
 
-dllexport void z86_cancel_interrupt() {
+void z86MachineImpl::cancel_interrupt() {
     ctx.cancel_interrupt();
 }
 
-dllexport void z86_execute() {
+void z86MachineImpl::stop() {
+    ctx.run_events.fetch_or(EventStop, std::memory_order_relaxed);
+    ctx.wake();
+}
+
+uint32_t z86MachineImpl::run_events() {
+    return ctx.run_events.load(std::memory_order_relaxed);
+}
+
+size_t z86MachineImpl::clock() {
+    return ctx.clock;
+}
+
+uint32_t z86MachineImpl::schedule(size_t clock, SchedulerCallback callback, void* data) {
+    return scheduler.schedule(clock, callback, data);
+}
+
+bool z86MachineImpl::deschedule(uint32_t id) {
+    return scheduler.cancel(id);
+}
+
+void z86MachineImpl::init() {
     ctx.init();
+#if USE_JIT
+    jit.init();
+#endif
+}
+
+// Runs until at least the given number of cycles have elapsed or
+// one of the events is raised, overshooting by at most one instruction
+// (or one translated block with USE_JIT). Returns the cycles used,
+// z86_run_events says what happened during them. A halted CPU skips
+// ahead to the next scheduled event unless EventHalt is set, or sleeps
+// until z86_interrupt/z86_nmi/z86_stop if the slice is unbounded and
+// nothing is scheduled.
+size_t z86MachineImpl::run_until(uint32_t events, size_t cycles) {
+    // The core helpers reach the machine through the thread's selection
+    this->select();
+    size_t start = ctx.clock;
+    scheduler.begin_slice(cycles < SIZE_MAX - start ? start + cycles : SIZE_MAX);
+    // Still halted from an earlier slice
+    if (ctx.halted) {
+        scheduler.raise_attention();
+    }
+    // A stop requested between slices still ends the next one
+    ctx.run_events.fetch_and(EventStop, std::memory_order_relaxed);
 
 #define ALWAYS_UD() { ctx.set_fault(IntUD); goto fault; }
 #define ALWAYS_UD_GRP() { ctx.set_fault(IntUD); return OP_FAULT; }
-#define THROW_UD() if constexpr (!ctx.NO_UD) { ALWAYS_UD(); } else
-#define THROW_UD_GRP() if constexpr (!ctx.NO_UD) { ALWAYS_UD_GRP(); } else
+#define THROW_UD() if constexpr (!z8086Context::NO_UD) { ALWAYS_UD(); } else
+#define THROW_UD_GRP() if constexpr (!z8086Context::NO_UD) { ALWAYS_UD_GRP(); } else
 
 #define ALWAYS_UD_WITHOUT_FLAG(...) if constexpr (!(__VA_ARGS__)) { ALWAYS_UD(); } else
 #define ALWAYS_UD_WITHOUT_FLAG_GRP(...) if constexpr (!(__VA_ARGS__)) { ALWAYS_UD_GRP(); } else
 #define THROW_UD_WITHOUT_FLAG(...) if constexpr (!(__VA_ARGS__)) { THROW_UD(); } else
 #define THROW_UD_WITHOUT_FLAG_GRP(...) if constexpr (!(__VA_ARGS__)) { THROW_UD_GRP(); } else
 
-#define ALWAYS_UD_WITHOUT_X87_REGS() ALWAYS_UD_WITHOUT_FLAG(ctx.CPUID_X87 || ctx.CPUID_MMX || ctx.CPUID_3DNOW)
-#define ALWAYS_UD_WITHOUT_MMX_REGS() ALWAYS_UD_WITHOUT_FLAG(ctx.CPUID_X87 || ctx.CPUID_MMX || ctx.CPUID_3DNOW)
-#define ALWAYS_UD_WITHOUT_SSE_REGS() ALWAYS_UD_WITHOUT_FLAG(ctx.CPUID_SSE || ctx.CPUID_SSE2)
-#define ALWAYS_UD_WITHOUT_MMX_SSE_REGS() ALWAYS_UD_WITHOUT_FLAG((ctx.CPUID_X87 || ctx.CPUID_MMX || ctx.CPUID_3DNOW) && (ctx.CPUID_SSE || ctx.CPUID_SSE2))
+#define ALWAYS_UD_WITHOUT_X87_REGS() ALWAYS_UD_WITHOUT_FLAG(z8086Context::CPUID_X87 || z8086Context::CPUID_MMX || z8086Context::CPUID_3DNOW)
+#define ALWAYS_UD_WITHOUT_MMX_REGS() ALWAYS_UD_WITHOUT_FLAG(z8086Context::CPUID_X87 || z8086Context::CPUID_MMX || z8086Context::CPUID_3DNOW)
+#define ALWAYS_UD_WITHOUT_SSE_REGS() ALWAYS_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2)
+#define ALWAYS_UD_WITHOUT_MMX_SSE_REGS() ALWAYS_UD_WITHOUT_FLAG((z8086Context::CPUID_X87 || z8086Context::CPUID_MMX || z8086Context::CPUID_3DNOW) && (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2))
 
 #define ALWAYS_GP() { ctx.set_fault(IntGP); goto fault; }
 #define ALWAYS_GP_GRP() { ctx.set_fault(IntGP); return OP_FAULT; }
@@ -224,571 +613,812 @@ dllexport void z86_execute() {
 #define GP_WITHOUT_CPL0_GRP() if (ctx.current_privilege_level() != 0) { ALWAYS_GP_GRP(); } else
 
 #define FAULT_CHECK(...) if (expect((__VA_ARGS__), false)) { goto fault; }
+// A REP run that yields leaves IP on its prefixes so it resumes after any interrupt
+#define STRING_OP(...) { size_t rep_start = ctx.rep_count(); ctx.rep_begin(opcode_byte, scheduler.deadline.load(std::memory_order_relaxed)); FAULT_CHECK(__VA_ARGS__); ctx.rep_cycles(opcode_byte, rep_start); if (expect(ctx.rep_yield, false)) { goto next_instr; } }
 
 #define FAULT_CHECK_X87(...) ALWAYS_UD_WITHOUT_X87_REGS() { FAULT_CHECK(__VA_ARGS__); }
 #define FAULT_CHECK_MMX(...) ALWAYS_UD_WITHOUT_MMX_REGS() { FAULT_CHECK(__VA_ARGS__); }
 #define FAULT_CHECK_SSE(...) ALWAYS_UD_WITHOUT_SSE_REGS() { FAULT_CHECK(__VA_ARGS__); }
 #define FAULT_CHECK_MMX_SSE(...) ALWAYS_UD_WITHOUT_MMX_SSE_REGS() { FAULT_CHECK(__VA_ARGS__); }
 
+#if USE_THREADED_DISPATCH
+#define OPCODE(n) case n: op_##n
+    // Indexed by opcode_byte | map << 8
+    static const void* const dispatch_table[0x300] = {
+        &&op_0x00, &&op_0x01, &&op_0x02, &&op_0x03, &&op_0x04, &&op_0x05, &&op_0x06, &&op_0x07,
+        &&op_0x08, &&op_0x09, &&op_0x0A, &&op_0x0B, &&op_0x0C, &&op_0x0D, &&op_0x0E, &&op_0x0F,
+        &&op_0x10, &&op_0x11, &&op_0x12, &&op_0x13, &&op_0x14, &&op_0x15, &&op_0x16, &&op_0x17,
+        &&op_0x18, &&op_0x19, &&op_0x1A, &&op_0x1B, &&op_0x1C, &&op_0x1D, &&op_0x1E, &&op_0x1F,
+        &&op_0x20, &&op_0x21, &&op_0x22, &&op_0x23, &&op_0x24, &&op_0x25, &&op_0x26, &&op_0x27,
+        &&op_0x28, &&op_0x29, &&op_0x2A, &&op_0x2B, &&op_0x2C, &&op_0x2D, &&op_0x2E, &&op_0x2F,
+        &&op_0x30, &&op_0x31, &&op_0x32, &&op_0x33, &&op_0x34, &&op_0x35, &&op_0x36, &&op_0x37,
+        &&op_0x38, &&op_0x39, &&op_0x3A, &&op_0x3B, &&op_0x3C, &&op_0x3D, &&op_0x3E, &&op_0x3F,
+        &&op_0x40, &&op_0x41, &&op_0x42, &&op_0x43, &&op_0x44, &&op_0x45, &&op_0x46, &&op_0x47,
+        &&op_0x48, &&op_0x49, &&op_0x4A, &&op_0x4B, &&op_0x4C, &&op_0x4D, &&op_0x4E, &&op_0x4F,
+        &&op_0x50, &&op_0x51, &&op_0x52, &&op_0x53, &&op_0x54, &&op_0x55, &&op_0x56, &&op_0x57,
+        &&op_0x58, &&op_0x59, &&op_0x5A, &&op_0x5B, &&op_0x5C, &&op_0x5D, &&op_0x5E, &&op_0x5F,
+        &&op_0x60, &&op_0x61, &&op_0x62, &&op_0x63, &&op_0x64, &&op_0x65, &&op_0x66, &&op_0x67,
+        &&op_0x68, &&op_0x69, &&op_0x6A, &&op_0x6B, &&op_0x6C, &&op_0x6D, &&op_0x6E, &&op_0x6F,
+        &&op_0x70, &&op_0x71, &&op_0x72, &&op_0x73, &&op_0x74, &&op_0x75, &&op_0x76, &&op_0x77,
+        &&op_0x78, &&op_0x79, &&op_0x7A, &&op_0x7B, &&op_0x7C, &&op_0x7D, &&op_0x7E, &&op_0x7F,
+        &&op_0x80, &&op_0x81, &&op_0x82, &&op_0x83, &&op_0x84, &&op_0x85, &&op_0x86, &&op_0x87,
+        &&op_0x88, &&op_0x89, &&op_0x8A, &&op_0x8B, &&op_0x8C, &&op_0x8D, &&op_0x8E, &&op_0x8F,
+        &&op_0x90, &&op_0x91, &&op_0x92, &&op_0x93, &&op_0x94, &&op_0x95, &&op_0x96, &&op_0x97,
+        &&op_0x98, &&op_0x99, &&op_0x9A, &&op_0x9B, &&op_0x9C, &&op_0x9D, &&op_0x9E, &&op_0x9F,
+        &&op_0xA0, &&op_0xA1, &&op_0xA2, &&op_0xA3, &&op_0xA4, &&op_0xA5, &&op_0xA6, &&op_0xA7,
+        &&op_0xA8, &&op_0xA9, &&op_0xAA, &&op_0xAB, &&op_0xAC, &&op_0xAD, &&op_0xAE, &&op_0xAF,
+        &&op_0xB0, &&op_0xB1, &&op_0xB2, &&op_0xB3, &&op_0xB4, &&op_0xB5, &&op_0xB6, &&op_0xB7,
+        &&op_0xB8, &&op_0xB9, &&op_0xBA, &&op_0xBB, &&op_0xBC, &&op_0xBD, &&op_0xBE, &&op_0xBF,
+        &&op_0xC0, &&op_0xC1, &&op_0xC2, &&op_0xC3, &&op_0xC4, &&op_0xC5, &&op_0xC6, &&op_0xC7,
+        &&op_0xC8, &&op_0xC9, &&op_0xCA, &&op_0xCB, &&op_0xCC, &&op_0xCD, &&op_0xCE, &&op_0xCF,
+        &&op_0xD0, &&op_0xD1, &&op_0xD2, &&op_0xD3, &&op_0xD4, &&op_0xD5, &&op_0xD6, &&op_0xD7,
+        &&op_0xD8, &&op_0xD9, &&op_0xDA, &&op_0xDB, &&op_0xDC, &&op_0xDD, &&op_0xDE, &&op_0xDF,
+        &&op_0xE0, &&op_0xE1, &&op_0xE2, &&op_0xE3, &&op_0xE4, &&op_0xE5, &&op_0xE6, &&op_0xE7,
+        &&op_0xE8, &&op_0xE9, &&op_0xEA, &&op_0xEB, &&op_0xEC, &&op_0xED, &&op_0xEE, &&op_0xEF,
+        &&op_0xF0, &&op_0xF1, &&op_0xF2, &&op_0xF3, &&op_0xF4, &&op_0xF5, &&op_0xF6, &&op_0xF7,
+        &&op_0xF8, &&op_0xF9, &&op_0xFA, &&op_0xFB, &&op_0xFC, &&op_0xFD, &&op_0xFE, &&op_0xFF,
+        &&op_0x100, &&op_0x101, &&op_0x102, &&op_0x103, &&op_0x104, &&op_0x105, &&op_0x106, &&op_0x107,
+        &&op_0x108, &&op_0x109, &&op_0x10A, &&op_0x10B, &&op_0x10C, &&op_0x10D, &&op_0x10E, &&op_0x10F,
+        &&op_0x110, &&op_0x111, &&op_0x112, &&op_0x113, &&op_0x114, &&op_0x115, &&op_0x116, &&op_0x117,
+        &&op_0x118, &&op_0x119, &&op_0x11A, &&op_0x11B, &&op_0x11C, &&op_0x11D, &&op_0x11E, &&op_0x11F,
+        &&op_0x120, &&op_0x121, &&op_0x122, &&op_0x123, &&op_0x124, &&op_0x125, &&op_0x126, &&op_0x127,
+        &&op_0x128, &&op_0x129, &&op_0x12A, &&op_0x12B, &&op_0x12C, &&op_0x12D, &&op_0x12E, &&op_0x12F,
+        &&op_0x130, &&op_0x131, &&op_0x132, &&op_0x133, &&op_0x134, &&op_0x135, &&op_0x136, &&op_0x137,
+        &&op_default, &&op_0x139, &&op_default, &&op_0x13B, &&op_0x13C, &&op_default, &&op_0x13E, &&op_0x13F,
+        &&op_0x140, &&op_0x141, &&op_0x142, &&op_0x143, &&op_0x144, &&op_0x145, &&op_0x146, &&op_0x147,
+        &&op_0x148, &&op_0x149, &&op_0x14A, &&op_0x14B, &&op_0x14C, &&op_0x14D, &&op_0x14E, &&op_0x14F,
+        &&op_0x150, &&op_0x151, &&op_0x152, &&op_0x153, &&op_0x154, &&op_0x155, &&op_0x156, &&op_0x157,
+        &&op_0x158, &&op_0x159, &&op_0x15A, &&op_0x15B, &&op_0x15C, &&op_0x15D, &&op_0x15E, &&op_0x15F,
+        &&op_0x160, &&op_0x161, &&op_0x162, &&op_0x163, &&op_0x164, &&op_0x165, &&op_0x166, &&op_0x167,
+        &&op_0x168, &&op_0x169, &&op_0x16A, &&op_0x16B, &&op_0x16C, &&op_0x16D, &&op_0x16E, &&op_0x16F,
+        &&op_0x170, &&op_0x171, &&op_0x172, &&op_0x173, &&op_0x174, &&op_0x175, &&op_0x176, &&op_0x177,
+        &&op_0x178, &&op_0x179, &&op_0x17A, &&op_0x17B, &&op_0x17C, &&op_0x17D, &&op_0x17E, &&op_0x17F,
+        &&op_0x180, &&op_0x181, &&op_0x182, &&op_0x183, &&op_0x184, &&op_0x185, &&op_0x186, &&op_0x187,
+        &&op_0x188, &&op_0x189, &&op_0x18A, &&op_0x18B, &&op_0x18C, &&op_0x18D, &&op_0x18E, &&op_0x18F,
+        &&op_0x190, &&op_0x191, &&op_0x192, &&op_0x193, &&op_0x194, &&op_0x195, &&op_0x196, &&op_0x197,
+        &&op_0x198, &&op_0x199, &&op_0x19A, &&op_0x19B, &&op_0x19C, &&op_0x19D, &&op_0x19E, &&op_0x19F,
+        &&op_0x1A0, &&op_0x1A1, &&op_0x1A2, &&op_0x1A3, &&op_0x1A4, &&op_0x1A5, &&op_0x1A6, &&op_0x1A7,
+        &&op_0x1A8, &&op_0x1A9, &&op_0x1AA, &&op_0x1AB, &&op_0x1AC, &&op_0x1AD, &&op_0x1AE, &&op_0x1AF,
+        &&op_0x1B0, &&op_0x1B1, &&op_0x1B2, &&op_0x1B3, &&op_0x1B4, &&op_0x1B5, &&op_0x1B6, &&op_0x1B7,
+        &&op_0x1B8, &&op_0x1B9, &&op_0x1BA, &&op_0x1BB, &&op_0x1BC, &&op_0x1BD, &&op_0x1BE, &&op_0x1BF,
+        &&op_0x1C0, &&op_0x1C1, &&op_0x1C2, &&op_0x1C3, &&op_0x1C4, &&op_0x1C5, &&op_0x1C6, &&op_0x1C7,
+        &&op_0x1C8, &&op_0x1C9, &&op_0x1CA, &&op_0x1CB, &&op_0x1CC, &&op_0x1CD, &&op_0x1CE, &&op_0x1CF,
+        &&op_0x1D0, &&op_0x1D1, &&op_0x1D2, &&op_0x1D3, &&op_0x1D4, &&op_0x1D5, &&op_0x1D6, &&op_0x1D7,
+        &&op_0x1D8, &&op_0x1D9, &&op_0x1DA, &&op_0x1DB, &&op_0x1DC, &&op_0x1DD, &&op_0x1DE, &&op_0x1DF,
+        &&op_0x1E0, &&op_0x1E1, &&op_0x1E2, &&op_0x1E3, &&op_0x1E4, &&op_0x1E5, &&op_0x1E6, &&op_0x1E7,
+        &&op_0x1E8, &&op_0x1E9, &&op_0x1EA, &&op_0x1EB, &&op_0x1EC, &&op_0x1ED, &&op_0x1EE, &&op_0x1EF,
+        &&op_0x1F0, &&op_0x1F1, &&op_0x1F2, &&op_0x1F3, &&op_0x1F4, &&op_0x1F5, &&op_0x1F6, &&op_0x1F7,
+        &&op_0x1F8, &&op_0x1F9, &&op_0x1FA, &&op_0x1FB, &&op_0x1FC, &&op_0x1FD, &&op_0x1FE, &&op_0x1FF,
+        &&op_0x200, &&op_0x201, &&op_0x202, &&op_0x203, &&op_0x204, &&op_0x205, &&op_0x206, &&op_0x207,
+        &&op_0x208, &&op_0x209, &&op_0x20A, &&op_0x20B, &&op_0x20C, &&op_0x20D, &&op_0x20E, &&op_0x20F,
+        &&op_0x210, &&op_0x211, &&op_0x212, &&op_0x213, &&op_0x214, &&op_0x215, &&op_0x216, &&op_0x217,
+        &&op_0x218, &&op_0x219, &&op_0x21A, &&op_0x21B, &&op_0x21C, &&op_0x21D, &&op_0x21E, &&op_0x21F,
+        &&op_0x220, &&op_0x221, &&op_0x222, &&op_0x223, &&op_0x224, &&op_0x225, &&op_0x226, &&op_0x227,
+        &&op_0x228, &&op_0x229, &&op_0x22A, &&op_0x22B, &&op_0x22C, &&op_0x22D, &&op_0x22E, &&op_0x22F,
+        &&op_0x230, &&op_0x231, &&op_0x232, &&op_0x233, &&op_0x234, &&op_0x235, &&op_0x236, &&op_0x237,
+        &&op_0x238, &&op_0x239, &&op_0x23A, &&op_0x23B, &&op_0x23C, &&op_0x23D, &&op_0x23E, &&op_0x23F,
+        &&op_0x240, &&op_0x241, &&op_0x242, &&op_0x243, &&op_0x244, &&op_0x245, &&op_0x246, &&op_0x247,
+        &&op_0x248, &&op_0x249, &&op_0x24A, &&op_0x24B, &&op_0x24C, &&op_0x24D, &&op_0x24E, &&op_0x24F,
+        &&op_0x250, &&op_0x251, &&op_0x252, &&op_0x253, &&op_0x254, &&op_0x255, &&op_0x256, &&op_0x257,
+        &&op_0x258, &&op_0x259, &&op_0x25A, &&op_0x25B, &&op_0x25C, &&op_0x25D, &&op_0x25E, &&op_0x25F,
+        &&op_0x260, &&op_0x261, &&op_0x262, &&op_0x263, &&op_0x264, &&op_0x265, &&op_0x266, &&op_0x267,
+        &&op_0x268, &&op_0x269, &&op_0x26A, &&op_0x26B, &&op_0x26C, &&op_0x26D, &&op_0x26E, &&op_0x26F,
+        &&op_0x270, &&op_0x271, &&op_0x272, &&op_0x273, &&op_0x274, &&op_0x275, &&op_0x276, &&op_0x277,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+        &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default, &&op_default,
+    };
+#else
+#define OPCODE(n) case n
+#endif
+
+#define BEGIN_INSTRUCTION() \
+    ctx.seg_override = -1; \
+    ctx.rep_type = NO_REP; \
+    ctx.lock = false; \
+    ctx.reset_prefixes(); \
+    if constexpr (z8086Context::PROTECTED_MODE) { \
+        fault_ip = ctx.rip; \
+        fault_sp = ctx.rsp; \
+        fault_cs = ctx.cs; \
+    }
+
+#if USE_DECODE_CACHE
+// Runs the arguments on a hit with pc past the cached prefixes and opcode
+#define DECODE_CACHE_LOOKUP(...) \
+    decode_addr = pc.addr(); \
+    decode_offset = pc.offset; \
+    decode_entry = &decode_cache.lookup(decode_addr); \
+    if (expect(decode_cache.hit(*decode_entry, decode_addr, mem), true)) { \
+        ctx.seg_override = decode_entry->seg_override; \
+        ctx.rep_type = decode_entry->rep_type; \
+        ctx.lock = decode_entry->lock; \
+        map = decode_entry->map; \
+        opcode_byte = decode_entry->opcode; \
+        pc += decode_entry->length; \
+        ctx.decode_entry = decode_entry; \
+        ctx.clock += (size_t)(decode_entry->length - 1) * ctx.cycles.prefix; \
+        __VA_ARGS__; \
+    }
+#endif
+
+#if USE_JIT
+// Runs the translated block at pc if there is one, the block
+// leaves IP at whatever comes after it
+#define JIT_EXECUTE() if (jit.execute(pc.addr(), pc.offset, ctx, mem)) goto next_instr
+#else
+#define JIT_EXECUTE()
+#endif
+
+#if USE_THREADED_DISPATCH
+// Handlers that finish normally fetch and jump to the next handler
+// themselves, so every handler gets its own indirect branch to predict.
+// Anything next_instr has to see goes the long way.
+#define DISPATCH_OPCODE() { ctx.instruction_cycles(opcode_byte, map); goto *dispatch_table[opcode_byte | (uint32_t)map << 8]; }
+#if USE_DECODE_CACHE
+#define DISPATCH_CACHED() if constexpr (decode_cache_enabled) { DECODE_CACHE_LOOKUP(DISPATCH_OPCODE()); goto next_byte; }
+#else
+#define DISPATCH_CACHED()
+#endif
+// For handlers that already set IP
+#define DISPATCH_JUMP() { \
+    if (expect(ctx.clock < scheduler.deadline.load(std::memory_order_relaxed) && ctx.can_chain(), true)) { \
+        BEGIN_INSTRUCTION(); \
+        pc = ctx.pc(); \
+        map = 0; \
+        JIT_EXECUTE(); \
+        DISPATCH_CACHED(); \
+        opcode_byte = pc.read_advance(); \
+        DISPATCH_OPCODE(); \
+    } \
+    goto next_instr; \
+}
+#define DISPATCH_NEXT() { ctx.ip = pc.offset; DISPATCH_JUMP(); }
+#else
+#define DISPATCH_JUMP() goto next_instr
+#define DISPATCH_NEXT() break
+#endif
+
+    // Where an instruction abandoned by a segment check restarts
+    [[maybe_unused]] decltype(ctx.rip) fault_ip;
+    [[maybe_unused]] decltype(ctx.rsp) fault_sp;
+    [[maybe_unused]] uint16_t fault_cs;
+
     for (;;) {
+        if (expect(ctx.clock >= scheduler.deadline.load(std::memory_order_relaxed), false)) {
+            // Events, interrupts, stop requests and HLT all pull
+            // the deadline in, so only the clock is checked per instruction
+            bool in_slice = scheduler.poll(ctx.clock);
+            // Read first so that an interrupt raised after the
+            // check below still wakes the wait
+            uint32_t wakeups = ctx.wakeups.load(std::memory_order_acquire);
+            bool halted = ctx.check_for_wakeup();
+            if (halted) {
+                ctx.run_events.fetch_or(EventHalt, std::memory_order_relaxed);
+            }
+            if (!in_slice || (ctx.run_events.load(std::memory_order_relaxed) & events)) {
+                break;
+            }
+            if (halted) {
+                size_t deadline = scheduler.deadline.load(std::memory_order_relaxed);
+                if (deadline == SIZE_MAX) {
+                    ctx.wakeups.wait(wakeups, std::memory_order_acquire);
+                }
+                else if (deadline > ctx.clock) {
+                    // Nothing can happen until the next event fires
+                    ctx.clock = deadline;
+                }
+                continue;
+            }
+        }
+
+        if constexpr (z8086Context::OPCODES_V20) {
+            // 8080 code has its own interpreter
+            if (expect(ctx.emulation_mode, false)) {
+                z86_run_8080(this);
+                ctx.execute_pending_interrupts();
+                continue;
+            }
+        }
+
         // Reset per-instruction states
-        ctx.seg_override = -1;
-        ctx.rep_type = NO_REP;
-        ctx.lock = false;
-        ctx.reset_prefixes();
+        BEGIN_INSTRUCTION();
 
         z86AddrCS pc = ctx.pc();
         uint8_t map = 0;
+        uint8_t opcode_byte;
+#if USE_JIT
+        if (expect(!ctx.trap, true)) {
+            JIT_EXECUTE();
+        }
+#endif
+#if USE_DECODE_CACHE
+        size_t decode_addr;
+        uint16_t decode_offset;
+        z86DecodeEntry* decode_entry;
+        if constexpr (decode_cache_enabled) {
+            DECODE_CACHE_LOOKUP(goto dispatch);
+        }
+#endif
         // TODO: The 6 byte prefetch cache
-        // TODO: Clock cycles
     prefix_byte:
         assume(map == 0);
     next_byte:
-        uint8_t opcode_byte = pc.read_advance();
+        opcode_byte = pc.read_advance();
+#if USE_DECODE_CACHE
+        if constexpr (decode_cache_enabled) {
+            // Refilled after every prefix, so the entry always matches
+            // what the switch is about to see. Wrapped fetches aren't cached.
+            ctx.decode_entry = NULL;
+            if (expect(pc.offset > decode_offset, true)) {
+                ctx.decode_entry = decode_cache.fill(*decode_entry, decode_addr, pc.offset - decode_offset, opcode_byte, map, ctx, mem);
+            }
+        }
+    dispatch:
+#endif
+        ctx.instruction_cycles(opcode_byte, map);
         //assume(!(map & 0xFF));
         //uint32_t opcode = opcode_byte | (uint32_t)map << 8;
         //assume(opcode <= UINT16_MAX);
         //switch (opcode) {
+#if USE_THREADED_DISPATCH
+        // The switch below only provides the handler bodies
+        goto *dispatch_table[opcode_byte | (uint32_t)map << 8];
+#endif
         switch (opcode_byte | (uint32_t)map << 8) {
-            case 0x00: // ADD Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto src) regcall {
+            OPCODE(0x00): // ADD Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADD(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x01: // ADD Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x01): // ADD Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADD(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x02: // ADD Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x02): // ADD Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADD(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x03: // ADD Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x03): // ADD Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADD(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x04: // ADD AL, Ib
-                ctx.binopAI<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x04): // ADD AL, Ib
+                ctx.binopAI<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADD(dst, src);
                 });
-                break;
-            case 0x05: // ADD AX, Is
-                ctx.binopAI(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x05): // ADD AX, Is
+                ctx.binopAI(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADD(dst, src);
                 });
-                break;
-            case 0x06: case 0x0E: case 0x16: case 0x1E: // PUSH seg
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0x06): OPCODE(0x0E): OPCODE(0x16): OPCODE(0x1E): // PUSH seg
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.PUSH(ctx.get_seg(opcode_byte >> 3));
-                break;
-            case 0x0F:
-                if constexpr (ctx.OPCODES_80286) {
+                DISPATCH_NEXT();
+            OPCODE(0x0F):
+                if constexpr (z8086Context::OPCODES_80286) {
                     map = 1;
                     goto next_byte;
                 }
                 THROW_UD();
-            case 0x07: case 0x17: case 0x1F: // POP seg
-                if constexpr (ctx.LONG_MODE) {
+            OPCODE(0x07): OPCODE(0x17): OPCODE(0x1F): // POP seg
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.write_seg(opcode_byte >> 3, ctx.POP());
-                break;
-            case 0x08: // OR Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x08): // OR Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.OR(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x09: // OR Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x09): // OR Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) regcall {
                     ctx.OR(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x0A: // OR Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x0A): // OR Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.OR(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x0B: // OR Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x0B): // OR Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                     ctx.OR(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x0C: // OR AL, Ib
-                ctx.binopAI<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x0C): // OR AL, Ib
+                ctx.binopAI<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.OR(dst, src);
                 });
-                break;
-            case 0x0D: // OR AX, Is
-                ctx.binopAI(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x0D): // OR AX, Is
+                ctx.binopAI(pc, [&](auto& dst, auto src) regcall {
                     ctx.OR(dst, src);
                 });
-                break;
-            case 0x10: // ADC Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x10): // ADC Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADC(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x11: // ADC Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x11): // ADC Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADC(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x12: // ADC Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x12): // ADC Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADC(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x13: // ADC Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x13): // ADC Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADC(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x14: // ADC AL, Ib
-                ctx.binopAI<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x14): // ADC AL, Ib
+                ctx.binopAI<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADC(dst, src);
                 });
-                break;
-            case 0x15: // ADC AX, Is
-                ctx.binopAI(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x15): // ADC AX, Is
+                ctx.binopAI(pc, [&](auto& dst, auto src) regcall {
                     ctx.ADC(dst, src);
                 });
-                break;
-            case 0x18: // SBB Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x18): // SBB Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.SBB(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x19: // SBB Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x19): // SBB Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) regcall {
                     ctx.SBB(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x1A: // SBB Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x1A): // SBB Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.SBB(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x1B: // SBB Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x1B): // SBB Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                     ctx.SBB(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x1C: // SBB AL, Ib
-                ctx.binopAI<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x1C): // SBB AL, Ib
+                ctx.binopAI<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.SBB(dst, src);
                 });
-                break;
-            case 0x1D: // SBB AX, Is
-                ctx.binopAI(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x1D): // SBB AX, Is
+                ctx.binopAI(pc, [&](auto& dst, auto src) regcall {
                     ctx.SBB(dst, src);
                 });
-                break;
-            case 0x20: // AND Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x20): // AND Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.AND(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x21: // AND Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x21): // AND Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) regcall {
                     ctx.AND(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x22: // AND Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x22): // AND Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.AND(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x23: // AND Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x23): // AND Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                     ctx.AND(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x24: // AND AL, Ib
-                ctx.binopAI<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x24): // AND AL, Ib
+                ctx.binopAI<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.AND(dst, src);
                 });
-                break;
-            case 0x25: // AND AX, Is
-                ctx.binopAI(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x25): // AND AX, Is
+                ctx.binopAI(pc, [&](auto& dst, auto src) regcall {
                     ctx.AND(dst, src);
                 });
-                break;
-            case 0x26: case 0x2E: case 0x36: case 0x3E: // SEG:
+                DISPATCH_NEXT();
+            OPCODE(0x26): OPCODE(0x2E): OPCODE(0x36): OPCODE(0x3E): // SEG:
                 ctx.set_seg_override((opcode_byte >> 3) & 3);
                 goto prefix_byte;
-            case 0x27: // DAA
-                if constexpr (ctx.LONG_MODE) {
+            OPCODE(0x27): // DAA
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.DAA();
-                break;
-            case 0x28: // SUB Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x28): // SUB Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.SUB(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x29: // SUB Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x29): // SUB Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) regcall {
                     ctx.SUB(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x2A: // SUB Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x2A): // SUB Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.SUB(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x2B: // SUB Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x2B): // SUB Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                     ctx.SUB(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x2C: // SUB AL, Ib
-                ctx.binopAI<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x2C): // SUB AL, Ib
+                ctx.binopAI<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.SUB(dst, src);
                 });
-                break;
-            case 0x2D: // SUB AX, Is
-                ctx.binopAI(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x2D): // SUB AX, Is
+                ctx.binopAI(pc, [&](auto& dst, auto src) regcall {
                     ctx.SUB(dst, src);
                 });
-                break;
-            case 0x2F: // DAS
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0x2F): // DAS
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.DAS();
-                break;
-            case 0x30: // XOR Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x30): // XOR Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.XOR(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x31: // XOR Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x31): // XOR Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) regcall {
                     ctx.XOR(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x32: // XOR Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x32): // XOR Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.XOR(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x33: // XOR Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x33): // XOR Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                     ctx.XOR(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x34: // XOR AL, Ib
-                ctx.binopAI<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x34): // XOR AL, Ib
+                ctx.binopAI<true>(pc, [&](auto& dst, auto src) regcall {
                     ctx.XOR(dst, src);
                 });
-                break;
-            case 0x35: // XOR AX, Is
-                ctx.binopAI(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x35): // XOR AX, Is
+                ctx.binopAI(pc, [&](auto& dst, auto src) regcall {
                     ctx.XOR(dst, src);
                 });
-                break;
-            case 0x37: // AAA
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0x37): // AAA
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.AAA();
-                break;
-            case 0x38: // CMP Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x38): // CMP Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto dst, auto src) regcall {
                     ctx.CMP(dst, src);
                     return OP_NO_WRITE;
                 }));
-                break;
-            case 0x39: // CMP Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x39): // CMP Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto dst, auto src) regcall {
                     ctx.CMP(dst, src);
                     return OP_NO_WRITE;
                 }));
-                break;
-            case 0x3A: // CMP Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x3A): // CMP Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto dst, auto src) regcall {
                     ctx.CMP(dst, src);
                     return OP_NO_WRITE;
                 }));
-                break;
-            case 0x3B: // CMP Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x3B): // CMP Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto dst, auto src) regcall {
                     ctx.CMP(dst, src);
                     return OP_NO_WRITE;
                 }));
-                break;
-            case 0x3C: // CMP AL, Ib
-                ctx.binopAI<true>(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x3C): // CMP AL, Ib
+                ctx.binopAI<true>(pc, [&](auto dst, auto src) regcall {
                     ctx.CMP(dst, src);
                 });
-                break;
-            case 0x3D: // CMP AX, Is
-                ctx.binopAI(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x3D): // CMP AX, Is
+                ctx.binopAI(pc, [&](auto& dst, auto src) regcall {
                     ctx.CMP(dst, src);
                 });
-                break;
-            case 0x3F: // AAS
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0x3F): // AAS
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.AAS();
-                break;
-            case 0x40: case 0x41: case 0x42: case 0x43: case 0x44: case 0x45: case 0x46: case 0x47: // INC reg
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0x40): OPCODE(0x41): OPCODE(0x42): OPCODE(0x43): OPCODE(0x44): OPCODE(0x45): OPCODE(0x46): OPCODE(0x47): // INC reg
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         ctx.set_rex_bits(opcode_byte);
                         goto prefix_byte;
                     }
                 }
                 ctx.INC(ctx.index_regMB<uint16_t>(opcode_byte & 7));
-                break;
-            case 0x48: case 0x49: case 0x4A: case 0x4B: case 0x4C: case 0x4D: case 0x4E: case 0x4F: // DEC reg
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0x48): OPCODE(0x49): OPCODE(0x4A): OPCODE(0x4B): OPCODE(0x4C): OPCODE(0x4D): OPCODE(0x4E): OPCODE(0x4F): // DEC reg
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         ctx.set_rex_bits(opcode_byte);
                         goto prefix_byte;
                     }
                 }
                 ctx.DEC(ctx.index_regMB<uint16_t>(opcode_byte & 7));
-                break;
-            case 0x50: case 0x51: case 0x52: case 0x53: case 0x54: case 0x55: case 0x56: case 0x57: // PUSH reg
-                if constexpr (ctx.OLD_PUSH_SP) {
+                DISPATCH_NEXT();
+            OPCODE(0x50): OPCODE(0x51): OPCODE(0x52): OPCODE(0x53): OPCODE(0x54): OPCODE(0x55): OPCODE(0x56): OPCODE(0x57): // PUSH reg
+                if constexpr (z8086Context::OLD_PUSH_SP) {
                     ctx.PUSH(ctx.index_regMB<uint16_t>(opcode_byte & 7));
                 }
                 else {
                     auto temp = ctx.index_regMB<uint16_t>(opcode_byte & 7);
                     ctx.PUSH(temp);
                 }
-                break;
-            case 0x58: case 0x59: case 0x5A: case 0x5B: case 0x5C: case 0x5D: case 0x5E: case 0x5F: // POP reg
+                DISPATCH_NEXT();
+            OPCODE(0x58): OPCODE(0x59): OPCODE(0x5A): OPCODE(0x5B): OPCODE(0x5C): OPCODE(0x5D): OPCODE(0x5E): OPCODE(0x5F): // POP reg
                 ctx.index_regMB<uint16_t>(opcode_byte & 7) = ctx.POP();
-                break;
-            case 0x60: // PUSHA
-                if constexpr (ctx.OPCODES_80186) {
-                    if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0x60): // PUSHA
+                if constexpr (z8086Context::OPCODES_80186) {
+                    if constexpr (z8086Context::LONG_MODE) {
                         if (ctx.is_long_mode()) {
                             THROW_UD();
                         }
                     }
                     ctx.PUSHA();
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x61:
-                if constexpr (ctx.OPCODES_80186) {
-                    if constexpr (ctx.LONG_MODE) {
+            OPCODE(0x61):
+                if constexpr (z8086Context::OPCODES_80186) {
+                    if constexpr (z8086Context::LONG_MODE) {
                         if (ctx.is_long_mode()) {
                             THROW_UD();
                         }
                     }
                     ctx.POPA();
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x70: // JO Jb
-            case 0x71: // JNO Jb
-                ctx.JCC<CondNO, true>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x62: // BOUND Rv, Mv2
-                if constexpr (ctx.OPCODES_80186) {
-                    if constexpr (ctx.LONG_MODE) {
+            OPCODE(0x70): // JO Jb
+            OPCODE(0x71): // JNO Jb
+                ctx.branch_cycles(ctx.JCC<CondNO, true>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x62): // BOUND Rv, Mv2
+                if constexpr (z8086Context::OPCODES_80186) {
+                    if constexpr (z8086Context::LONG_MODE) {
                         if (ctx.is_long_mode()) {
                             // Parse EVEX
                             THROW_UD();
                         }
                     }
-                    FAULT_CHECK(ctx.binopRM2(pc, [](auto index, auto lower, auto upper) regcall {
+                    FAULT_CHECK(ctx.binopRM2(pc, [&](auto index, auto lower, auto upper) regcall {
                         return ctx.BOUND(index, lower, upper);
                     }));
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x63: // ARPL Mw, Rw
-                if constexpr (ctx.PROTECTED_MODE && ctx.OPCODES_80286) {
+            OPCODE(0x63): // ARPL Mw, Rw
+                if constexpr (z8086Context::PROTECTED_MODE && z8086Context::OPCODES_80286) {
                     // Not valid in real mode apparently
                     if (ctx.is_real_mode()) {
                         THROW_UD();
                     }
-                    if constexpr (ctx.LONG_MODE) {
+                    if constexpr (z8086Context::LONG_MODE) {
                         if (ctx.is_long_mode()) {
                             // MOVSXD Rv, Mv
-                            FAULT_CHECK(ctx.MOVX<int32_t>(pc, [](auto& dst, auto src) regcall{
+                            FAULT_CHECK(ctx.MOVX<int32_t>(pc, [&](auto& dst, auto src) regcall{
                                 using S = decltype(src);
                                 using D = std::remove_reference_t<decltype(dst)>;
                                 dst = (D)(S)src;
                                 return OP_NOT_MEM;
                             }));
-                            break;
+                            DISPATCH_NEXT();
                         }
                     }
                     // TODO
                 }
-                else if constexpr (ctx.OPCODES_V20) {
+                else if constexpr (z8086Context::OPCODES_V20) {
                     // ???
                 }
                 THROW_UD();
-            case 0x72: // JC Jb
-            case 0x73: // JNC Jb
-                ctx.JCC<CondNC, true>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x64: case 0x65: // FS/GS prefixes
-                if constexpr (ctx.OPCODES_80386) {
+            OPCODE(0x72): // JC Jb
+            OPCODE(0x73): // JNC Jb
+                ctx.branch_cycles(ctx.JCC<CondNC, true>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x64): OPCODE(0x65): // FS/GS prefixes
+                if constexpr (z8086Context::OPCODES_80386) {
                     ctx.set_seg_override(opcode_byte & 0xF);
                     goto prefix_byte;
                 }
-                else if constexpr (ctx.OPCODES_V20) {
+                else if constexpr (z8086Context::OPCODES_V20) {
                     ctx.set_repc_type(opcode_byte);
                     goto prefix_byte;
                 }
                 THROW_UD();
-            case 0x74: // JZ Jb
-            case 0x75: // JNZ Jb
-                ctx.JCC<CondNZ, true>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x66: // Data size prefix
-                if constexpr (ctx.max_bits > 16) {
+            OPCODE(0x74): // JZ Jb
+            OPCODE(0x75): // JNZ Jb
+                ctx.branch_cycles(ctx.JCC<CondNZ, true>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x66): // Data size prefix
+                if constexpr (z8086Context::max_bits > 16) {
                     ctx.data_size_prefix();
                     goto prefix_byte;
                 }
-                if constexpr (ctx.OPCODES_V20) {
+                if constexpr (z8086Context::OPCODES_V20) {
                     goto modrm_nop;
                 }
                 THROW_UD();
-            case 0x67: // Addr size prefix
-                if constexpr (ctx.max_bits > 16) {
+            OPCODE(0x67): // Addr size prefix
+                if constexpr (z8086Context::max_bits > 16) {
                     ctx.addr_size_prefix();
                     goto prefix_byte;
                 }
-                if constexpr (ctx.OPCODES_V20) {
+                if constexpr (z8086Context::OPCODES_V20) {
                     goto modrm_nop;
                 }
                 THROW_UD();
-            case 0x76: // JBE Jb
-            case 0x77: // JA Jb
-                ctx.JCC<CondA, true>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x68: // PUSH Is
-                if constexpr (ctx.OPCODES_80186) {
+            OPCODE(0x76): // JBE Jb
+            OPCODE(0x77): // JA Jb
+                ctx.branch_cycles(ctx.JCC<CondA, true>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x68): // PUSH Is
+                if constexpr (z8086Context::OPCODES_80186) {
                     ctx.PUSHI(pc.read_advance_Is());
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x69: // IMUL Rv, Mv, Is
-                if constexpr (ctx.OPCODES_80186) {
+            OPCODE(0x69): // IMUL Rv, Mv, Is
+                if constexpr (z8086Context::OPCODES_80186) {
                     FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                         ctx.IMUL(dst, src, pc.read_advance_Is());
                     }));
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x78: // JS Jb
-            case 0x79: // JNS Jb
-                ctx.JCC<CondNS, true>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x6A: // PUSH Ib
-                if constexpr (ctx.OPCODES_80186) {
+            OPCODE(0x78): // JS Jb
+            OPCODE(0x79): // JNS Jb
+                ctx.branch_cycles(ctx.JCC<CondNS, true>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x6A): // PUSH Ib
+                if constexpr (z8086Context::OPCODES_80186) {
                     ctx.PUSHI(pc.read_advance<int8_t>());
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x6B: // IMUL Rv, Mv, Ib
-                if constexpr (ctx.OPCODES_80186) {
+            OPCODE(0x6B): // IMUL Rv, Mv, Ib
+                if constexpr (z8086Context::OPCODES_80186) {
                     FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                         ctx.IMUL(dst, src, pc.read<int8_t>());
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x7A: // JP Jb
-            case 0x7B: // JNP Jb
-                ctx.JCC<CondNP, true>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x6C: // INSB
-                if constexpr (ctx.OPCODES_80186) {
-                    FAULT_CHECK(ctx.INS<true>());
-                    break;
+            OPCODE(0x7A): // JP Jb
+            OPCODE(0x7B): // JNP Jb
+                ctx.branch_cycles(ctx.JCC<CondNP, true>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x6C): // INSB
+                if constexpr (z8086Context::OPCODES_80186) {
+                    STRING_OP(ctx.INS<true>());
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x6D: // INS
-                if constexpr (ctx.OPCODES_80186) {
-                    FAULT_CHECK(ctx.INS());
-                    break;
+            OPCODE(0x6D): // INS
+                if constexpr (z8086Context::OPCODES_80186) {
+                    STRING_OP(ctx.INS());
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x7C: // JL Jb
-            case 0x7D: // JGE Jb
-                ctx.JCC<CondGE, true>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x6E: // OUTSB
-                if constexpr (ctx.OPCODES_80186) {
-                    FAULT_CHECK(ctx.OUTS<true>());
-                    break;
+            OPCODE(0x7C): // JL Jb
+            OPCODE(0x7D): // JGE Jb
+                ctx.branch_cycles(ctx.JCC<CondGE, true>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x6E): // OUTSB
+                if constexpr (z8086Context::OPCODES_80186) {
+                    STRING_OP(ctx.OUTS<true>());
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x6F: // OUTS
-                if constexpr (ctx.OPCODES_80186) {
-                    FAULT_CHECK(ctx.OUTS());
-                    break;
+            OPCODE(0x6F): // OUTS
+                if constexpr (z8086Context::OPCODES_80186) {
+                    STRING_OP(ctx.OUTS());
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0x7E: // JLE Jb
-            case 0x7F: // JG Jb
-                ctx.JCC<CondG, true>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x82:
-                if constexpr (ctx.LONG_MODE) {
+            OPCODE(0x7E): // JLE Jb
+            OPCODE(0x7F): // JG Jb
+                ctx.branch_cycles(ctx.JCC<CondG, true>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x82):
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
-            case 0x80: // GRP1 Mb, Ib
+            OPCODE(0x80): // GRP1 Mb, Ib
                 FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                     uint8_t val = pc.read<int8_t>();
                     switch (r) {
@@ -804,8 +1434,8 @@ dllexport void z86_execute() {
                     }
                 }));
                 ++pc;
-                break;
-            case 0x81: // GRP1 Ev, Is
+                DISPATCH_NEXT();
+            OPCODE(0x81): // GRP1 Ev, Is
                 FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                     int32_t val = pc.read_advance_Is();
                     switch (r) {
@@ -820,8 +1450,8 @@ dllexport void z86_execute() {
                         case 7: ctx.CMP(dst, val); return OP_NO_WRITE;
                     }
                 }));
-                break;
-            case 0x83: // GRP1 Ev, Ib
+                DISPATCH_NEXT();
+            OPCODE(0x83): // GRP1 Ev, Ib
                 FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                     int32_t val = pc.read<int8_t>();
                     switch (r) {
@@ -837,62 +1467,62 @@ dllexport void z86_execute() {
                     }
                 }));
                 ++pc;
-                break;
-            case 0x84: // TEST Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x84): // TEST Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto dst, auto src) regcall {
                     ctx.TEST(dst, src);
                     return OP_NO_WRITE;
                 }));
-                break;
-            case 0x85: // TEST Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x85): // TEST Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto dst, auto src) regcall {
                     ctx.TEST(dst, src);
                     return OP_NO_WRITE;
                 }));
-                break;
-            case 0x86: // XCHG Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto& src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x86): // XCHG Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto& src) regcall {
                     ctx.XCHG(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x87: // XCHG Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto& src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x87): // XCHG Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto& src) regcall {
                     ctx.XCHG(dst, src);
                     return OP_WRITE;
                 }));
-                break;
-            case 0x88: // MOV Mb, Rb
-                FAULT_CHECK(ctx.binopMR<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x88): // MOV Mb, Rb
+                FAULT_CHECK(ctx.binopMR<true>(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     return OP_WRITE;
                 }));
-                break;
-            case 0x89: // MOV Mv, Rv
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x89): // MOV Mv, Rv
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     return OP_WRITE;
                 }));
-                break;
-            case 0x8A: // MOV Rb, Mb
-                FAULT_CHECK(ctx.binopRM<true>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x8A): // MOV Rb, Mb
+                FAULT_CHECK(ctx.binopRM<true>(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     return OP_WRITE;
                 }));
-                break;
-            case 0x8B: // MOV Rv, Mv
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x8B): // MOV Rv, Mv
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     return OP_WRITE;
                 }));
-                break;
-            case 0x8C: // MOV M, seg
-                FAULT_CHECK(ctx.binopMS(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x8C): // MOV M, seg
+                FAULT_CHECK(ctx.binopMS(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     return OP_WRITE;
                 }));
-                break;
-            case 0x8D: { // LEA
+                DISPATCH_NEXT();
+            OPCODE(0x8D): { // LEA
                 ModRM modrm = pc.read_advance<ModRM>();
                 if (modrm.is_mem()) {
                     z86Addr addr = modrm.parse_memM(pc);
@@ -902,16 +1532,16 @@ dllexport void z86_execute() {
                     THROW_UD();
                     // TODO: jank
                 }
-                break;
+                DISPATCH_NEXT();
             }
-            case 0x8E: // MOV seg, M
-                FAULT_CHECK(ctx.binopSM(pc, [](auto& dst, auto src) regcall {
+            OPCODE(0x8E): // MOV seg, M
+                FAULT_CHECK(ctx.binopSM(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     return OP_WRITE;
                 }));
-                break;
-            case 0x8F: // GRP1A (Supposedly this does mystery jank if R != 0)
-                FAULT_CHECK(ctx.unopM(pc, [](auto src, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x8F): // GRP1A (Supposedly this does mystery jank if R != 0)
+                FAULT_CHECK(ctx.unopM(pc, [&](auto src, uint8_t r) regcall {
                     switch (r) {
                         default: unreachable;
                         case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -922,120 +1552,126 @@ dllexport void z86_execute() {
                             return OP_NO_WRITE; // Writes to stack, not src
                     }
                 }));
-                break;
-            case 0x90: // NOP, XCHG RAX, R8
+                DISPATCH_NEXT();
+            OPCODE(0x90): // NOP, XCHG RAX, R8
                 if (!ctx.rex_bits.B()) {
                     // NOP
-                    break;
+                    DISPATCH_NEXT();
                 }
-            case 0x91: case 0x92: case 0x93: case 0x94: case 0x95: case 0x96: case 0x97: // XCHG AX, reg
-                ctx.binopAR(opcode_byte & 7, [](auto& dst, auto& src) regcall {
+            OPCODE(0x91): OPCODE(0x92): OPCODE(0x93): OPCODE(0x94): OPCODE(0x95): OPCODE(0x96): OPCODE(0x97): // XCHG AX, reg
+                ctx.binopAR(opcode_byte & 7, [&](auto& dst, auto& src) regcall {
                     ctx.XCHG(dst, src);
                 });
-                break;
-            case 0x98: // CBW
+                DISPATCH_NEXT();
+            OPCODE(0x98): // CBW
                 ctx.CBW();
-                break;
-            case 0x99: // CWD
+                DISPATCH_NEXT();
+            OPCODE(0x99): // CWD
                 ctx.CWD();
-                break;
-            case 0x9A: // CALL far abs
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0x9A): // CALL far abs
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.CALLFABS(pc);
-                goto next_instr;
-            case 0x9B: // WAIT
+                DISPATCH_JUMP();
+            OPCODE(0x9B): // WAIT
                 // NOP :D
-                break;
-            case 0x9C: // PUSHF
+                DISPATCH_NEXT();
+            OPCODE(0x9C): // PUSHF
                 ctx.PUSH(ctx.get_flags<uint16_t>());
-                break;
-            case 0x9D: // POPF
-                ctx.set_flags<uint16_t>(ctx.POP());
-                break;
-            case 0x9E: // SAHF
+                DISPATCH_NEXT();
+            OPCODE(0x9D): { // POPF
+                uint16_t flags = ctx.POP();
+                if (ctx.access_faulted()) {
+                    goto next_instr;
+                }
+                ctx.set_flags<uint16_t>(flags);
+                DISPATCH_NEXT();
+            }
+            OPCODE(0x9E): // SAHF
                 ctx.set_flags<uint8_t>(ctx.ah);
-                break;
-            case 0x9F: // LAHF
+                DISPATCH_NEXT();
+            OPCODE(0x9F): // LAHF
                 ctx.ah = ctx.get_flags<uint8_t>();
-                break;
-            case 0xA0: // MOV AL, mem
-                ctx.binopAO<true>(pc, [](auto& dst, auto offset) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xA0): // MOV AL, mem
+                ctx.binopAO<true>(pc, [&](auto& dst, auto offset) regcall {
                     z86Addr addr = ctx.addr(DS, offset);
                     dst = addr.read<decltype(dst)>();
                 });
-                break;
-            case 0xA1: // MOV AX, mem
-                ctx.binopAO(pc, [](auto& dst, auto offset) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xA1): // MOV AX, mem
+                ctx.binopAO(pc, [&](auto& dst, auto offset) regcall {
                     z86Addr addr = ctx.addr(DS, offset);
                     dst = addr.read<decltype(dst)>();
                 });
-                break;
-            case 0xA2: // MOV mem, AL
-                ctx.binopAO<true>(pc, [](auto src, auto offset) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xA2): // MOV mem, AL
+                ctx.binopAO<true>(pc, [&](auto src, auto offset) regcall {
                     z86Addr addr = ctx.addr(DS, offset);
                     addr.write(src);
                 });
-                break;
-            case 0xA3: // MOV mem, AX
-                ctx.binopAO(pc, [](auto src, auto offset) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xA3): // MOV mem, AX
+                ctx.binopAO(pc, [&](auto src, auto offset) regcall {
                     z86Addr addr = ctx.addr(DS, offset);
                     addr.write(src);
                 });
-                break;
-            case 0xA4: // MOVSB
-                FAULT_CHECK(ctx.MOVS<true>());
-                break;
-            case 0xA5: // MOVSW
-                FAULT_CHECK(ctx.MOVS());
-                break;
-            case 0xA6: // CMPSB
-                FAULT_CHECK(ctx.CMPS<true>());
-                break;
-            case 0xA7: // CMPSW
-                FAULT_CHECK(ctx.CMPS());
-                break;
-            case 0xA8: // TEST AL, Ib
-                ctx.binopAI<true>(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xA4): // MOVSB
+                STRING_OP(ctx.MOVS<true>());
+                DISPATCH_NEXT();
+            OPCODE(0xA5): // MOVSW
+                STRING_OP(ctx.MOVS());
+                DISPATCH_NEXT();
+            OPCODE(0xA6): // CMPSB
+                STRING_OP(ctx.CMPS<true>());
+                DISPATCH_NEXT();
+            OPCODE(0xA7): // CMPSW
+                STRING_OP(ctx.CMPS());
+                DISPATCH_NEXT();
+            OPCODE(0xA8): // TEST AL, Ib
+                ctx.binopAI<true>(pc, [&](auto dst, auto src) regcall {
                     ctx.TEST(dst, src);
                 });
-                break;
-            case 0xA9: // TEST AX, Is
-                ctx.binopAI(pc, [](auto dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xA9): // TEST AX, Is
+                ctx.binopAI(pc, [&](auto dst, auto src) regcall {
                     ctx.TEST(dst, src);
                 });
-                break;
-            case 0xAA: // STOSB
-                FAULT_CHECK(ctx.STOS<true>());
-                break;
-            case 0xAB: // STOSW
-                FAULT_CHECK(ctx.STOS());
-                break;
-            case 0xAC: // LODSB
-                FAULT_CHECK(ctx.LODS<true>());
-                break;
-            case 0xAD: // LODSW
-                FAULT_CHECK(ctx.LODS());
-                break;
-            case 0xAE: // SCASB
-                FAULT_CHECK(ctx.SCAS<true>());
-                break;
-            case 0xAF: // SCASW
-                FAULT_CHECK(ctx.SCAS());
-                break;
-            case 0xB0: case 0xB1: case 0xB2: case 0xB3: case 0xB4: case 0xB5: case 0xB6: case 0xB7: // MOV reg8, Ib
+                DISPATCH_NEXT();
+            OPCODE(0xAA): // STOSB
+                STRING_OP(ctx.STOS<true>());
+                DISPATCH_NEXT();
+            OPCODE(0xAB): // STOSW
+                STRING_OP(ctx.STOS());
+                DISPATCH_NEXT();
+            OPCODE(0xAC): // LODSB
+                STRING_OP(ctx.LODS<true>());
+                DISPATCH_NEXT();
+            OPCODE(0xAD): // LODSW
+                STRING_OP(ctx.LODS());
+                DISPATCH_NEXT();
+            OPCODE(0xAE): // SCASB
+                STRING_OP(ctx.SCAS<true>());
+                DISPATCH_NEXT();
+            OPCODE(0xAF): // SCASW
+                STRING_OP(ctx.SCAS());
+                DISPATCH_NEXT();
+            OPCODE(0xB0): OPCODE(0xB1): OPCODE(0xB2): OPCODE(0xB3): OPCODE(0xB4): OPCODE(0xB5): OPCODE(0xB6): OPCODE(0xB7): // MOV reg8, Ib
                 ctx.MOV_RI<true>(pc, opcode_byte & 7);
-                break;
-            case 0xB8: case 0xB9: case 0xBA: case 0xBB: case 0xBC: case 0xBD: case 0xBE: case 0xBF: // MOV reg, Iv
+                DISPATCH_NEXT();
+            OPCODE(0xB8): OPCODE(0xB9): OPCODE(0xBA): OPCODE(0xBB): OPCODE(0xBC): OPCODE(0xBD): OPCODE(0xBE): OPCODE(0xBF): // MOV reg, Iv
                 ctx.MOV_RI(pc, opcode_byte & 7);
-                break;
-            case 0xC0: // GRP2 Mb, Ib
-                if constexpr (ctx.OPCODES_80186) {
+                DISPATCH_NEXT();
+            OPCODE(0xC0): // GRP2 Mb, Ib
+                if constexpr (z8086Context::OPCODES_80186) {
                     FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                         uint8_t count = pc.read<uint8_t>();
+                        ctx.shift_cycles(count);
                         switch (r) {
                             default: unreachable;
                             case 0: ctx.ROL(dst, count); return OP_WRITE;
@@ -1049,16 +1685,17 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0xC2: // RET imm
+            OPCODE(0xC2): // RET imm
                 ctx.RETI(pc);
-                goto next_instr;
-            case 0xC1: // GRP2 Mv, Ib
-                if constexpr (ctx.OPCODES_80186) {
+                DISPATCH_JUMP();
+            OPCODE(0xC1): // GRP2 Mv, Ib
+                if constexpr (z8086Context::OPCODES_80186) {
                     FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                         uint8_t count = pc.read<uint8_t>();
+                        ctx.shift_cycles(count);
                         switch (r) {
                             default: unreachable;
                             case 0: ctx.ROL(dst, count); return OP_WRITE;
@@ -1072,27 +1709,27 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0xC3: // RET
+            OPCODE(0xC3): // RET
                 ctx.RET();
-                goto next_instr;
-            case 0xC4: // LES Rv, Mf
-                FAULT_CHECK(ctx.binopRMF(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_JUMP();
+            OPCODE(0xC4): // LES Rv, Mf
+                FAULT_CHECK(ctx.binopRMF(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     ctx.es = src >> (bitsof(src) >> 1);
                     return true;
                 }));
-                break;
-            case 0xC5: // LDS Rv, Mf
-                FAULT_CHECK(ctx.binopRMF(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xC5): // LDS Rv, Mf
+                FAULT_CHECK(ctx.binopRMF(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     ctx.ds = src >> (bitsof(src) >> 1);
                     return true;
                 }));
-                break;
-            case 0xC6: // GRP11 Ib (Supposedly this just ignores R bits)
+                DISPATCH_NEXT();
+            OPCODE(0xC6): // GRP11 Ib (Supposedly this just ignores R bits)
                 FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                     switch (r) {
                         case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -1105,8 +1742,8 @@ dllexport void z86_execute() {
                     }
                 }));
                 ++pc;
-                break;
-            case 0xC7: // GRP11 Is (Supposedly this just ignores R bits)
+                DISPATCH_NEXT();
+            OPCODE(0xC7): // GRP11 Is (Supposedly this just ignores R bits)
                 FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                     switch (r) {
                         case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -1118,49 +1755,55 @@ dllexport void z86_execute() {
                             unreachable;
                     }
                 }));
-                break;
-            case 0xC8: // ENTER Iw, Ib
-                if constexpr (ctx.OPCODES_80186) {
+                DISPATCH_NEXT();
+            OPCODE(0xC8): // ENTER Iw, Ib
+                if constexpr (z8086Context::OPCODES_80186) {
                     ctx.ENTER(pc.read<uint16_t>(), pc.read<uint8_t>(2));
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0xCA: // RETF imm
+            OPCODE(0xCA): // RETF imm
                 ctx.RETFI(pc);
-                goto next_instr;
-            case 0xC9: // LEAVE
-                if constexpr (ctx.OPCODES_80186) {
+                DISPATCH_JUMP();
+            OPCODE(0xC9): // LEAVE
+                if constexpr (z8086Context::OPCODES_80186) {
                     ctx.LEAVE();
-                    break;
+                    DISPATCH_NEXT();
                 }
                 THROW_UD();
-            case 0xCB: // RETF
+            OPCODE(0xCB): // RETF
                 ctx.RETF();
-                goto next_instr;
-            case 0xCC: // INT3
+                DISPATCH_JUMP();
+            OPCODE(0xCC): // INT3
                 ctx.set_trap(IntBP);
                 goto trap;
-            case 0xCD: // INT Ib
+            OPCODE(0xCD): // INT Ib
                 ctx.set_trap(pc.read_advance<uint8_t>());
                 goto trap;
-            case 0xCE: // INTO
-                if constexpr (ctx.LONG_MODE) {
+            OPCODE(0xCE): // INTO
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
-                if (ctx.overflow) {
+                if (ctx.get_overflow()) {
                     ctx.set_trap(IntOF);
                     goto trap;
                 }
-                break;
-            case 0xCF: // IRET
+                DISPATCH_NEXT();
+            OPCODE(0xCF): { // IRET
                 ctx.ip = ctx.POP();
                 ctx.cs = ctx.POP();
-                ctx.set_flags(ctx.POP());
+                uint16_t flags = ctx.POP();
+                if (ctx.access_faulted()) {
+                    goto next_instr;
+                }
+                ctx.set_flags(flags);
+                ctx.restore_mode(flags);
                 continue; // Using continues delays execution deliberately
-            case 0xD0: // GRP2 Mb, 1
-                FAULT_CHECK(ctx.unopM<true>(pc, [](auto& dst, uint8_t r) regcall {
+            }
+            OPCODE(0xD0): // GRP2 Mb, 1
+                FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                     switch (r) {
                         default: unreachable;
                         case 0: ctx.ROL(dst, 1); return OP_WRITE;
@@ -1173,9 +1816,9 @@ dllexport void z86_execute() {
                         case 7: ctx.SAR(dst, 1); return OP_WRITE;
                     }
                 }));
-                break;
-            case 0xD1: // GRP2 Mv, 1
-                FAULT_CHECK(ctx.unopM(pc, [](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xD1): // GRP2 Mv, 1
+                FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                     switch (r) {
                         default: unreachable;
                         case 0: ctx.ROL(dst, 1); return OP_WRITE;
@@ -1188,9 +1831,10 @@ dllexport void z86_execute() {
                         case 7: ctx.SAR(dst, 1); return OP_WRITE;
                     }
                 }));
-                break;
-            case 0xD2: // GRP2 Mb, CL
-                FAULT_CHECK(ctx.unopM<true>(pc, [](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xD2): // GRP2 Mb, CL
+                FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
+                    ctx.shift_cycles(ctx.cl);
                     switch (r) {
                         default: unreachable;
                         case 0: ctx.ROL(dst, ctx.cl); return OP_WRITE;
@@ -1203,9 +1847,10 @@ dllexport void z86_execute() {
                         case 7: ctx.SAR(dst, ctx.cl); return OP_WRITE;
                     }
                 }));
-                break;
-            case 0xD3: // GRP2 Mv, CL
-                FAULT_CHECK(ctx.unopM(pc, [](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0xD3): // GRP2 Mv, CL
+                FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
+                    ctx.shift_cycles(ctx.cl);
                     switch (r) {
                         default: unreachable;
                         case 0: ctx.ROL(dst, ctx.cl); return OP_WRITE;
@@ -1218,42 +1863,42 @@ dllexport void z86_execute() {
                         case 7: ctx.SAR(dst, ctx.cl); return OP_WRITE;
                     }
                 }));
-                break;
-            case 0xD4: // AAM Ib
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0xD4): // AAM Ib
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 FAULT_CHECK(ctx.AAM(pc.read_advance<uint8_t>()));
-                break;
-            case 0xD5: // AAD Ib
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0xD5): // AAD Ib
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.AAD(pc.read_advance<uint8_t>());
-                break;
-            case 0xD6: // SALC
-                if constexpr (!ctx.OPCODES_V20) {
-                    if constexpr (ctx.LONG_MODE) {
+                DISPATCH_NEXT();
+            OPCODE(0xD6): // SALC
+                if constexpr (!z8086Context::OPCODES_V20) {
+                    if constexpr (z8086Context::LONG_MODE) {
                         if (ctx.is_long_mode()) {
                             // Screw larabee junk
                             THROW_UD();
                         }
                     }
-                    ctx.al = ctx.carry ? -1 : 0;
-                    break;
+                    ctx.al = ctx.get_carry() ? -1 : 0;
+                    DISPATCH_NEXT();
                 }
-            case 0xD7: { // XLAT
+            OPCODE(0xD7): { // XLAT
                 z86Addr addr = ctx.addr(DS, ctx.bx + ctx.al);
                 ctx.al = addr.read<uint8_t>();
-                break;
+                DISPATCH_NEXT();
             }
-            case 0xD8: case 0xDA: case 0xDC: case 0xDE:
-            case 0xD9: case 0xDB: case 0xDD: case 0xDF:
-                if constexpr (!ctx.CPUID_X87) {
+            OPCODE(0xD8): OPCODE(0xDA): OPCODE(0xDC): OPCODE(0xDE):
+            OPCODE(0xD9): OPCODE(0xDB): OPCODE(0xDD): OPCODE(0xDF):
+                if constexpr (!z8086Context::CPUID_X87) {
                     goto modrm_nop;
                 }
                 else {
@@ -1307,7 +1952,7 @@ dllexport void z86_execute() {
                                         data_addr.write<int32_t>(ctx.FTOP());
                                         break;
                                     case 1: // FISTTP i32
-                                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                                     case 3: // FISTP i32
                                         data_addr.write<int32_t>(ctx.FPOP());
                                         break;
@@ -1333,7 +1978,7 @@ dllexport void z86_execute() {
                                         rhs = data_addr.read<double>();
                                         goto fld;
                                     case 1: // FISTTP i64
-                                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                                         goto fistp64;
                                     case 2: // FST f64
                                         data_addr.write<double>(ctx.FTOP());
@@ -1362,7 +2007,7 @@ dllexport void z86_execute() {
                                         data_addr.write<int16_t>(ctx.FTOP());
                                         break;
                                     case 1: // FISTTP i16
-                                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                                     case 3: // FISTP i16
                                         data_addr.write<int16_t>(ctx.FPOP());
                                         break;
@@ -1487,7 +2132,7 @@ dllexport void z86_execute() {
                                             case 4: // FXTRACT
                                                 break;
                                             case 5: // FPREM1
-                                                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                                                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                                                 break;
                                             case 6: // FDECSTP
                                                 ctx.FDECSTP();
@@ -1505,16 +2150,16 @@ dllexport void z86_execute() {
                                             case 2: // FSQRT
                                                 break;
                                             case 3: // FSINCOS
-                                                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                                                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                                                 break;
                                             case 4: // FRNDINT
                                             case 5: // FSCALE
                                                 break;
                                             case 6: // FSIN
-                                                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                                                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                                                 break;
                                             case 7: // FCOS
-                                                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                                                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                                                 break;
                                         }
                                         break;
@@ -1524,26 +2169,26 @@ dllexport void z86_execute() {
                                 switch (r) {
                                     default: unreachable;
                                     case 0: fcmovb: // FCMOVB ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
                                         ctx.FCMOVCC<CondNB>(ctx.index_st_reg(m), opcode_byte & 1);
                                         break;
                                     case 1: fcmove: // FCMOVE ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
                                         ctx.FCMOVCC<CondNE>(ctx.index_st_reg(m), opcode_byte & 1);
                                         break;
                                     case 2: fcmovbe: // FCMOVBE ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
                                         ctx.FCMOVCC<CondNBE>(ctx.index_st_reg(m), opcode_byte & 1);
                                         break;
                                     case 3: fcmovu: // FCMOVU ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
                                         ctx.FCMOVCC<CondNP>(ctx.index_st_reg(m), opcode_byte & 1);
                                         break;
                                     case 4:
                                         ALWAYS_UD();
                                     case 5:
                                         if (r == 1) { // FUCOMPP
-                                            THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                                            THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                                             ctx.FUCOM(ctx.FTOP(), ctx.index_st_reg(1));
                                             ctx.FINCSTP();
                                             ctx.FINCSTP();
@@ -1569,12 +2214,12 @@ dllexport void z86_execute() {
                                         switch (m) {
                                             default: unreachable;
                                             case 0: // FENI
-                                                if constexpr (!ctx.OPCODES_80286) {
+                                                if constexpr (!z8086Context::OPCODES_80286) {
 
                                                 }
                                                 break;
                                             case 1: // FDISI
-                                                if constexpr (!ctx.OPCODES_80286) {
+                                                if constexpr (!z8086Context::OPCODES_80286) {
 
                                                 }
                                                 break;
@@ -1582,12 +2227,12 @@ dllexport void z86_execute() {
                                             case 3: // FINIT
                                                 break;
                                             case 4: // FSETPM
-                                                if constexpr (!ctx.OPCODES_80386) {
+                                                if constexpr (!z8086Context::OPCODES_80386) {
 
                                                 }
                                                 break;
                                             case 5: // FRSTPM
-                                                if constexpr (!ctx.OPCODES_80386) {
+                                                if constexpr (!z8086Context::OPCODES_80386) {
 
                                                 }
                                                 break;
@@ -1597,11 +2242,11 @@ dllexport void z86_execute() {
                                         }
                                         break;
                                     case 5: // FUCOMI ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.OPCODES_P6);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_P6);
                                         ctx.FUCOMI(ctx.index_st_reg(m));
                                         break;
                                     case 6: // FCMOI ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.OPCODES_P6);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_P6);
                                         ctx.FCOMI(ctx.index_st_reg(m));
                                         break;
                                     case 7:
@@ -1642,11 +2287,11 @@ dllexport void z86_execute() {
                                         ctx.FINCSTP();
                                         break;
                                     case 4: // FUCOM ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                                         ctx.FUCOM(ctx.index_st_reg(m));
                                         break;
                                     case 5: // FUCOMP ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                                         ctx.FUCOM(ctx.index_st_reg(m));
                                         ctx.FINCSTP();
                                         break;
@@ -1716,7 +2361,7 @@ dllexport void z86_execute() {
                                         switch (m) {
                                             default: unreachable;
                                             case 0: // FSTSW AX
-                                                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80286);
+                                                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80286);
                                                 break;
                                             case 1: // FSTDW AX
                                             case 2: // FSTSG AX
@@ -1729,12 +2374,12 @@ dllexport void z86_execute() {
                                         }
                                         break;
                                     case 5: // FUCOMIP ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.OPCODES_P6);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_P6);
                                         ctx.FUCOMI(ctx.index_st_reg(m));
                                         ctx.FINCSTP();
                                         break;
                                     case 6: // FCOMIP ST(0), ST(m)
-                                        THROW_UD_WITHOUT_FLAG(ctx.OPCODES_P6);
+                                        THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_P6);
                                         ctx.FCOMI(ctx.index_st_reg(m));
                                         ctx.FINCSTP();
                                         break;
@@ -1749,89 +2394,91 @@ dllexport void z86_execute() {
                         }
                     }
                 }
-                break;
+                DISPATCH_NEXT();
             x87: // ESC x87
                 // NOP :D
                 pc += pc.read<ModRM>().length(pc);
-                break;
-            case 0xE0: // LOOPNZ Jb
-            case 0xE1: // LOOPZ Jb
-                ctx.LOOPCC(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0xE2: // LOOP Jb
-                ctx.LOOP(pc);
-                goto next_instr;
-            case 0xE3: // JCXZ Jb
-                ctx.JCXZ(pc);
-                goto next_instr;
-            case 0xE4: // IN AL, Ib
+                DISPATCH_NEXT();
+            OPCODE(0xE0): // LOOPNZ Jb
+            OPCODE(0xE1): // LOOPZ Jb
+                ctx.branch_cycles(ctx.LOOPCC(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0xE2): // LOOP Jb
+                ctx.branch_cycles(ctx.LOOP(pc));
+                DISPATCH_JUMP();
+            OPCODE(0xE3): // JCXZ Jb
+                ctx.branch_cycles(ctx.JCXZ(pc));
+                DISPATCH_JUMP();
+            OPCODE(0xE4): // IN AL, Ib
                 ctx.port_in<true>(pc.read_advance<uint8_t>());
-                break;
-            case 0xE5: // IN AX, Ib
+                DISPATCH_NEXT();
+            OPCODE(0xE5): // IN AX, Ib
                 ctx.port_in(pc.read_advance<uint8_t>());
-                break;
-            case 0xE6: // OUT Ib, AL
+                DISPATCH_NEXT();
+            OPCODE(0xE6): // OUT Ib, AL
                 ctx.port_out<true>(pc.read_advance<uint8_t>());
-                break;
-            case 0xE7: // OUT Ib, AX
+                DISPATCH_NEXT();
+            OPCODE(0xE7): // OUT Ib, AX
                 ctx.port_out(pc.read_advance<uint8_t>());
-                break;
-            case 0xE8: // CALL Jz
+                DISPATCH_NEXT();
+            OPCODE(0xE8): // CALL Jz
                 ctx.CALL(pc);
-                goto next_instr;
-            case 0xE9: // JMP Jz
+                DISPATCH_JUMP();
+            OPCODE(0xE9): // JMP Jz
                 ctx.JMP(pc);
-                goto next_instr;
-            case 0xEA: // JMP far abs
-                if constexpr (ctx.LONG_MODE) {
+                DISPATCH_JUMP();
+            OPCODE(0xEA): // JMP far abs
+                if constexpr (z8086Context::LONG_MODE) {
                     if (ctx.is_long_mode()) {
                         THROW_UD();
                     }
                 }
                 ctx.JMPFABS(pc);
-                goto next_instr;
-            case 0xEB: // JMP Jb
+                DISPATCH_JUMP();
+            OPCODE(0xEB): // JMP Jb
                 ctx.JMP<true>(pc);
-                goto next_instr;
-            case 0xEC: // IN AL, DX
+                DISPATCH_JUMP();
+            OPCODE(0xEC): // IN AL, DX
                 ctx.port_in<true>(ctx.dx);
-                break;
-            case 0xED: // IN AX, DX
+                DISPATCH_NEXT();
+            OPCODE(0xED): // IN AX, DX
                 ctx.port_in(ctx.dx);
-                break;
-            case 0xEE: // OUT DX, AL
+                DISPATCH_NEXT();
+            OPCODE(0xEE): // OUT DX, AL
                 ctx.port_out<true>(ctx.dx);
-                break;
-            case 0xEF: // OUT DX, AX
+                DISPATCH_NEXT();
+            OPCODE(0xEF): // OUT DX, AX
                 ctx.port_out(ctx.dx);
-                break;
-            case 0xF1:
-                if constexpr (ctx.OPCODES_80386) { // INT1
+                DISPATCH_NEXT();
+            OPCODE(0xF1):
+                if constexpr (z8086Context::OPCODES_80386) { // INT1
                     ctx.set_trap(IntDB);
                     goto trap;
                 }
-                if constexpr (ctx.OPCODES_80286) {
+                if constexpr (z8086Context::OPCODES_80286) {
                     // Stupid STOREALL prefix, just going to ignore this and pretend it's still lock
                     goto lock;
                 }
-                if constexpr (!ctx.OPCODES_V20) {
+                if constexpr (!z8086Context::OPCODES_V20) {
                     THROW_UD();
                 }
-            case 0xF0: lock: // LOCK
+            OPCODE(0xF0): lock: // LOCK
                 ctx.set_lock();
                 goto prefix_byte;
-            case 0xF2: case 0xF3: // REPNE, REP
+            OPCODE(0xF2): OPCODE(0xF3): // REPNE, REP
                 ctx.set_rep_type(opcode_byte);
                 goto prefix_byte;
-            case 0xF4: // HLT
+            OPCODE(0xF4): // HLT
                 GP_WITHOUT_CPL0();
-                ctx.halted = true;
-                break;
-            case 0xF5: // CMC
+                ctx.halt();
+                DISPATCH_NEXT();
+            OPCODE(0xF5): // CMC
+                ctx.resolve_flags();
                 ctx.carry ^= 1;
-                break;
-            case 0xF6: // GRP3 Mb
+                DISPATCH_NEXT();
+            OPCODE(0xF6): // GRP3 Mb
                 FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& val, uint8_t r) regcall {
+                    ctx.clock += ctx.cycles.grp3[0][r];
                     switch (r) {
                         default: unreachable;
                         case 0: case 1: // TEST Mb, Ib
@@ -1856,9 +2503,10 @@ dllexport void z86_execute() {
                     }
                 }));
                 ++pc;
-                break;
-            case 0xF7: // GRP3 Mv
+                DISPATCH_NEXT();
+            OPCODE(0xF7): // GRP3 Mv
                 FAULT_CHECK(ctx.unopM(pc, [&](auto& val, uint8_t r) regcall {
+                    ctx.clock += ctx.cycles.grp3[1][r];
                     switch (r) {
                         default: unreachable;
                         case 0: case 1: // TEST Mv, Is
@@ -1882,30 +2530,31 @@ dllexport void z86_execute() {
                             return ctx.IDIV(val) ? OP_FAULT : OP_NOT_MEM;
                     }
                 }));
-                break;
-            case 0xF8: case 0xF9: // CLC, STC
+                DISPATCH_NEXT();
+            OPCODE(0xF8): OPCODE(0xF9): // CLC, STC
+                ctx.resolve_flags();
                 ctx.carry = opcode_byte & 1;
-                break;
-            case 0xFA: case 0xFB: // CLI, STI
-                ctx.interrupt = opcode_byte & 1;
-                break;
-            case 0xFC: case 0xFD: // CLD, STD
+                DISPATCH_NEXT();
+            OPCODE(0xFA): OPCODE(0xFB): // CLI, STI
+                ctx.set_interrupt(opcode_byte & 1);
+                DISPATCH_NEXT();
+            OPCODE(0xFC): OPCODE(0xFD): // CLD, STD
                 ctx.direction = opcode_byte & 1;
-                break;
+                DISPATCH_NEXT();
 
                 // TODO: Fault support
-            case 0xFE: // GRP4 Mb
+            OPCODE(0xFE): // GRP4 Mb
                 if (ctx.unopMS<true>(pc)) {
                     goto next_instr;
                 }
-                break;
-            case 0xFF: // GRP5 Mv
+                DISPATCH_NEXT();
+            OPCODE(0xFF): // GRP5 Mv
                 if (ctx.unopMS(pc)) {
                     goto next_instr;
                 }
-                break;
-            case 0x100: // GRP6
-                FAULT_CHECK(ctx.unopMW(pc, [](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x100): // GRP6
+                FAULT_CHECK(ctx.unopMW(pc, [&](auto& dst, uint8_t r) regcall {
                     switch (r) {
                         default: unreachable;
                         case 0: // SLDT Mw
@@ -1915,7 +2564,9 @@ dllexport void z86_execute() {
                         case 2: // LLDT Mw
                         case 3: // LTR Mw
                             GP_WITHOUT_CPL0_GRP();
-                            ctx.write_control_seg(r & 1, dst);
+                            if (!ctx.write_control_seg(r & 1, dst)) {
+                                ctx.set_selector_fault();
+                            }
                             return OP_NO_WRITE;
                         case 4: // VERR Mw
                         case 5: // VERW Mw
@@ -1925,10 +2576,10 @@ dllexport void z86_execute() {
                             ALWAYS_UD_GRP();
                     }
                 }));
-                break;
-            case 0x101: // GRP7
+                DISPATCH_NEXT();
+            OPCODE(0x101): // GRP7
                 FAULT_CHECK(ctx.unopMM(pc,
-                    [](auto data_addr_raw, uint8_t r) regcall {
+                    [&](auto data_addr_raw, uint8_t r) regcall {
                         z86Addr data_addr = data_addr_raw;
                         switch (r) {
                             default: unreachable;
@@ -1937,7 +2588,7 @@ dllexport void z86_execute() {
                             {
                                 data_addr.write<uint16_t>(ctx.get_descriptor_table_limit(r & 1));
                                 auto base = ctx.get_descriptor_table_base(r & 1);
-                                if constexpr (ctx.LONG_MODE) {
+                                if constexpr (z8086Context::LONG_MODE) {
                                     if (ctx.is_long_mode()) {
                                         data_addr.write<uint64_t>(base, 2);
                                         return OP_NO_FAULT;
@@ -1952,7 +2603,7 @@ dllexport void z86_execute() {
                                 GP_WITHOUT_CPL0_GRP();
                                 uint16_t limit = data_addr.read<uint16_t>();
                                 decltype(ctx.get_descriptor_table_base(0)) base;
-                                if constexpr (ctx.LONG_MODE) {
+                                if constexpr (z8086Context::LONG_MODE) {
                                     if (ctx.is_long_mode()) {
                                         base = data_addr.read<uint64_t>(2);
                                         goto load_table;
@@ -1973,11 +2624,13 @@ dllexport void z86_execute() {
                                 ctx.set_machine_status_word(data_addr.read<uint16_t>());
                                 return OP_NO_FAULT;
                             case 7: // INVLPG M
-                                THROW_UD_WITHOUT_FLAG_GRP(ctx.OPCODES_80486);
+                                THROW_UD_WITHOUT_FLAG_GRP(z8086Context::OPCODES_80486);
+                                GP_WITHOUT_CPL0_GRP();
+                                ctx.invalidate_page((uint32_t)data_addr.addr());
                                 return OP_NO_FAULT;
                         }
                     },
-                    [](auto& src, uint8_t r) regcall{
+                    [&](auto& src, uint8_t r) regcall{
                         switch (r) {
                             default: unreachable;
                             case 0:
@@ -1998,74 +2651,94 @@ dllexport void z86_execute() {
                         }
                     }
                 ));
-                break;
-            case 0x102: // LAR Rv, Mv
-            case 0x103: // LSL Rv, Mv
-            case 0x104: // STOREALL
-            case 0x105: // SYSCALL, LOADALL2
-                break;
-            case 0x106: // CLTS
+                DISPATCH_NEXT();
+            OPCODE(0x102): // LAR Rv, Mv
+            OPCODE(0x103): // LSL Rv, Mv
+            OPCODE(0x104): // STOREALL
+            OPCODE(0x105): // SYSCALL, LOADALL2
+                DISPATCH_NEXT();
+            OPCODE(0x106): // CLTS
                 GP_WITHOUT_CPL0();
 
-                break;
-            case 0x107: // SYSRET, LOADALL3
-            case 0x108: // INVD (486)
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80486);
+                DISPATCH_NEXT();
+            OPCODE(0x107): // SYSRET, LOADALL3
+            OPCODE(0x108): // INVD (486)
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80486);
                 GP_WITHOUT_CPL0();
-                break;
-            case 0x109: // WBINVD (486)
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80486);
+                DISPATCH_NEXT();
+            OPCODE(0x109): // WBINVD (486)
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80486);
                 GP_WITHOUT_CPL0();
-                break;
-            case 0x10A: // CL1INVMB (wtf)
-                break;
-            case 0x10B: // UD2
-            case 0x1B9: // UD1
-            case 0x1FF: // UD0
+                DISPATCH_NEXT();
+            OPCODE(0x10A): // CL1INVMB (wtf)
+                DISPATCH_NEXT();
+            OPCODE(0x1FF): // UD0
+                if constexpr (z8086Context::OPCODES_V20) { // BRKEM Ib
+                    uint8_t number = pc.read_advance<uint8_t>();
+                    ctx.ip = pc.offset;
+                    ctx.BRKEM(number);
+                    goto next_instr;
+                }
+            OPCODE(0x10B): // UD2
+            OPCODE(0x1B9): // UD1
                 ALWAYS_UD();
-            case 0x1A6: // XBTS
-            case 0x1A7: // IBTS
-            case 0x10C:
-            case 0x125: case 0x127:
-            case 0x136: case 0x137:
-            case 0x139: case 0x13B: case 0x13C: case 0x13E: case 0x13F:
-            case 0x256: case 0x257:
-            case 0x25D:
-            case 0x260: case 0x261:
-            case 0x269: case 0x26A:
+            OPCODE(0x1A6): // XBTS
+            OPCODE(0x1A7): // IBTS
+            OPCODE(0x10C):
+            OPCODE(0x125): OPCODE(0x127):
+            OPCODE(0x136): OPCODE(0x137):
+            OPCODE(0x139): // INS Rb, Ib
+                if constexpr (z8086Context::OPCODES_V20) {
+                    ModRM modrm = pc.read_advance<ModRM>();
+                    FAULT_CHECK(ctx.INS_BITS(ctx.index_byte_regMB(modrm.M()), pc.read_advance<uint8_t>()));
+                    DISPATCH_NEXT();
+                }
                 THROW_UD();
-                break;
-            case 0x10D: // PREFETCHx
-            case 0x10E: // FEMMS
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_3DNOW);
+            OPCODE(0x13B): // EXT Rb, Ib
+                if constexpr (z8086Context::OPCODES_V20) {
+                    ModRM modrm = pc.read_advance<ModRM>();
+                    FAULT_CHECK(ctx.EXT_BITS(ctx.index_byte_regMB(modrm.M()), pc.read_advance<uint8_t>()));
+                    DISPATCH_NEXT();
+                }
+                THROW_UD();
+            OPCODE(0x13C): OPCODE(0x13E): OPCODE(0x13F):
+            OPCODE(0x256): OPCODE(0x257):
+            OPCODE(0x25D):
+            OPCODE(0x260): OPCODE(0x261):
+            OPCODE(0x269): OPCODE(0x26A):
+                THROW_UD();
+                DISPATCH_NEXT();
+            OPCODE(0x10D): // PREFETCHx
+            OPCODE(0x10E): // FEMMS
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_3DNOW);
             femms:
-                break;
-            case 0x10F: { // 3DNow!
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_3DNOW);
+                DISPATCH_NEXT();
+            OPCODE(0x10F): { // 3DNow!
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_3DNOW);
 
-                break;
+                DISPATCH_NEXT();
             }
-            case 0x110:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2) {
+            OPCODE(0x110):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // MOVUPS Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             goto movups_rm;
                         case Opcode66Prefix: // MOVUPD Rx, Mx (SSE2)
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             goto movups_rm;
                         case OpcodeF3Prefix: // MOVSS Rx, Mx (SSE)
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             break;
                         case OpcodeF2Prefix: // MOVSD Rx, Mx (SSE2)
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM<true>(pc, [](auto dst, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM<true>(pc, [&](auto dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2076,28 +2749,28 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x111:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2) {
+                DISPATCH_NEXT();
+            OPCODE(0x111):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // MOVUPS Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             goto movups_mr;
                         case Opcode66Prefix: // MOVUPD Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             goto movups_mr;
                         case OpcodeF3Prefix: // MOVSS Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             break;
                         case OpcodeF2Prefix: // MOVSD Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM(pc, [](auto dst, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM(pc, [&](auto dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2108,28 +2781,28 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x112:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2 || ctx.CPUID_SSE3) {
+                DISPATCH_NEXT();
+            OPCODE(0x112):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2 || z8086Context::CPUID_SSE3) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // MOVLPS Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             break;
                         case Opcode66Prefix: // MOVLPD Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                         case OpcodeF3Prefix: // MOVSLDUP Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                             break;
                         case OpcodeF2Prefix: // MOVDDUP Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                             break;
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM<true>(pc, [](auto& dst, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2140,16 +2813,16 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x113:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2) {
+                DISPATCH_NEXT();
+            OPCODE(0x113):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // MOVLPS Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             break;
                         case Opcode66Prefix: // MOVLPD Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                         case OpcodeF3Prefix:
                         case OpcodeF2Prefix:
@@ -2157,8 +2830,8 @@ dllexport void z86_execute() {
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM(pc, [](auto& dst, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2169,16 +2842,16 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x114:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2) {
+                DISPATCH_NEXT();
+            OPCODE(0x114):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // UNPCKLPS Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             goto punpckldq_sse;
                         case Opcode66Prefix: // UNPCKLPD Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                         case OpcodeF3Prefix:
                         case OpcodeF2Prefix:
@@ -2186,8 +2859,8 @@ dllexport void z86_execute() {
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM<true>(pc, [](auto& dst, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2198,16 +2871,16 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x115:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2) {
+                DISPATCH_NEXT();
+            OPCODE(0x115):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // UNPCKHPS Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             goto punpckhdq_sse;
                         case Opcode66Prefix: // UNPCKHPD Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                         case OpcodeF3Prefix:
                         case OpcodeF2Prefix:
@@ -2215,8 +2888,8 @@ dllexport void z86_execute() {
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM(pc, [](auto& dst, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2227,27 +2900,27 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x116:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2 || ctx.CPUID_SSE3) {
+                DISPATCH_NEXT();
+            OPCODE(0x116):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2 || z8086Context::CPUID_SSE3) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // MOVHPS Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             break;
                         case Opcode66Prefix: // MOVHPD Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                         case OpcodeF3Prefix: // MOVSHDUP Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                             break;
                         case OpcodeF2Prefix:
                             ALWAYS_UD();
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM<true>(pc, [](auto& dst, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2258,16 +2931,16 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x117:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2) {
+                DISPATCH_NEXT();
+            OPCODE(0x117):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // MOVHPS Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             break;
                         case Opcode66Prefix: // MOVHPD Mx, Rx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                         case OpcodeF3Prefix:
                         case OpcodeF2Prefix:
@@ -2275,8 +2948,8 @@ dllexport void z86_execute() {
                     }
                 }
                 else { // NOT1 Mv, CL
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM(pc, [](auto& dst, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2287,9 +2960,9 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x118:
-                if constexpr (ctx.OPCODES_V20) {
+                DISPATCH_NEXT();
+            OPCODE(0x118):
+                if constexpr (z8086Context::OPCODES_V20) {
                     FAULT_CHECK(ctx.unopM<true>(pc, [&](auto dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
@@ -2301,11 +2974,11 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 goto hint_nop;
-            case 0x119:
-                if constexpr (ctx.OPCODES_V20) {
+            OPCODE(0x119):
+                if constexpr (z8086Context::OPCODES_V20) {
                     FAULT_CHECK(ctx.unopM(pc, [&](auto dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
@@ -2317,11 +2990,11 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 goto hint_nop;
-            case 0x11A:
-                if constexpr (ctx.OPCODES_V20) { 
+            OPCODE(0x11A):
+                if constexpr (z8086Context::OPCODES_V20) { 
                     FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
@@ -2333,11 +3006,11 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 goto hint_nop;
-            case 0x11B:
-                if constexpr (ctx.OPCODES_V20) { 
+            OPCODE(0x11B):
+                if constexpr (z8086Context::OPCODES_V20) { 
                     FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
@@ -2349,11 +3022,11 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 goto hint_nop;
-            case 0x11C:
-                if constexpr (ctx.OPCODES_V20) { 
+            OPCODE(0x11C):
+                if constexpr (z8086Context::OPCODES_V20) { 
                     FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
@@ -2365,11 +3038,11 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 goto hint_nop;
-            case 0x11D:
-                if constexpr (ctx.OPCODES_V20) { 
+            OPCODE(0x11D):
+                if constexpr (z8086Context::OPCODES_V20) { 
                     FAULT_CHECK(ctx.unopM(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
@@ -2381,11 +3054,11 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 goto hint_nop;
-            case 0x11E:
-                if constexpr (ctx.OPCODES_V20) { 
+            OPCODE(0x11E):
+                if constexpr (z8086Context::OPCODES_V20) { 
                     FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
@@ -2397,11 +3070,11 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
                 goto hint_nop;
-            case 0x11F:
-                if constexpr (ctx.OPCODES_V20) { 
+            OPCODE(0x11F):
+                if constexpr (z8086Context::OPCODES_V20) { 
                     FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& dst, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
@@ -2413,69 +3086,79 @@ dllexport void z86_execute() {
                         }
                     }));
                     ++pc;
-                    break;
+                    DISPATCH_NEXT();
                 }
             hint_nop: // HINT_NOP
-                THROW_UD_WITHOUT_FLAG(ctx.HAS_LONG_NOP);
+                THROW_UD_WITHOUT_FLAG(z8086Context::HAS_LONG_NOP);
             modrm_nop:
                 pc += pc.read<ModRM>().length(pc);
-                break;
-            case 0x120:
-                if constexpr (ctx.OPCODES_80386) { // MOV M, CR
-                    GP_WITHOUT_CPL0();
-
+                DISPATCH_NEXT();
+            OPCODE(0x120):
+                if constexpr (z8086Context::OPCODES_80386) { // MOV M, CR
+                    GP_WITHOUT_CPL0() {
+                        // Always a register operand, whatever mod says
+                        ModRM modrm = pc.read_advance<ModRM>();
+                        ctx.index_dword_regMB(modrm.M()) = ctx.get_control_reg(modrm.R());
+                    }
                 }
                 else { // ADD4S
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    ctx.bcd_string_cycles();
+                    FAULT_CHECK(ctx.ADD4S());
                 }
-                break;
-            case 0x121:
-                if constexpr (ctx.OPCODES_80386) { // MOV M, DR
+                DISPATCH_NEXT();
+            OPCODE(0x121):
+                if constexpr (z8086Context::OPCODES_80386) { // MOV M, DR
                     GP_WITHOUT_CPL0();
 
                 }
                 THROW_UD();
-                break;
-            case 0x122:
-                if constexpr (ctx.OPCODES_80386) { // MOV CR, M
-                    GP_WITHOUT_CPL0();
-
+                DISPATCH_NEXT();
+            OPCODE(0x122):
+                if constexpr (z8086Context::OPCODES_80386) { // MOV CR, M
+                    GP_WITHOUT_CPL0() {
+                        ModRM modrm = pc.read_advance<ModRM>();
+                        if (!ctx.set_control_reg(modrm.R(), ctx.index_dword_regMB(modrm.M()))) {
+                            ALWAYS_UD();
+                        }
+                    }
                 }
                 else { // SUB4S
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    ctx.bcd_string_cycles();
+                    FAULT_CHECK(ctx.SUB4S());
                 }
-                break;
-            case 0x123:
-                if constexpr (ctx.OPCODES_80386) { // MOV DR, M
+                DISPATCH_NEXT();
+            OPCODE(0x123):
+                if constexpr (z8086Context::OPCODES_80386) { // MOV DR, M
                     GP_WITHOUT_CPL0();
 
                 }
                 THROW_UD();
-                break;
-            case 0x124: // MOV M, TR
-                THROW_UD_WITHOUT_FLAG(ctx.HAS_TEST_REGS);
+                DISPATCH_NEXT();
+            OPCODE(0x124): // MOV M, TR
+                THROW_UD_WITHOUT_FLAG(z8086Context::HAS_TEST_REGS);
                 
-                break;
-            case 0x126:
-                if constexpr (ctx.HAS_TEST_REGS) { // MOV TR, M
+                DISPATCH_NEXT();
+            OPCODE(0x126):
+                if constexpr (z8086Context::HAS_TEST_REGS) { // MOV TR, M
 
                 }
                 else { // CMP4S
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    ctx.bcd_string_cycles();
+                    FAULT_CHECK(ctx.CMP4S());
                 }
-                break;
-            case 0x128:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2) {
+                DISPATCH_NEXT();
+            OPCODE(0x128):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // MOVAPS Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             goto movups_rm;
                         case Opcode66Prefix: // MOVAPD Rx, Mx
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             goto movups_rm;
                         case OpcodeF3Prefix:
                         case OpcodeF2Prefix:
@@ -2483,8 +3166,8 @@ dllexport void z86_execute() {
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM<true>(pc, [](auto& src, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& src, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2495,42 +3178,42 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x129:
+                DISPATCH_NEXT();
+            OPCODE(0x129):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVAPS Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         goto movups_mr;
                     case Opcode66Prefix: // MOVAPD Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         goto movups_mr;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x12A:
-                if constexpr (ctx.CPUID_SSE || ctx.CPUID_SSE2) {
+                DISPATCH_NEXT();
+            OPCODE(0x12A):
+                if constexpr (z8086Context::CPUID_SSE || z8086Context::CPUID_SSE2) {
                     switch (ctx.opcode_select()) {
                         default: unreachable;
                         case OpcodeNoPrefix: // CVTPI2PS Rx, Mm
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                             break;
                         case Opcode66Prefix: // CVTPI2PD Rx, Mm
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE2);
                             break;
                         case OpcodeF3Prefix: // CVTSI2SS Rx, Mv
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                             break;
                         case OpcodeF2Prefix: // CVTSI2SD Rx, Mv
-                            THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                            THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                             break;
                     }
                 }
                 else {
-                    THROW_UD_WITHOUT_FLAG(ctx.OPCODES_V20);
-                    FAULT_CHECK(ctx.unopM<true>(pc, [](auto& src, uint8_t r) regcall {
+                    THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_V20);
+                    FAULT_CHECK(ctx.unopM<true>(pc, [&](auto& src, uint8_t r) regcall {
                         switch (r) {
                             default: unreachable;
                             case 1: case 2: case 3: case 4: case 5: case 6: case 7:
@@ -2541,331 +3224,340 @@ dllexport void z86_execute() {
                         }
                     }));
                 }
-                break;
-            case 0x12B:
+                DISPATCH_NEXT();
+            OPCODE(0x12B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVNTPS Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         goto movups_mr;
                     case Opcode66Prefix: // MOVNTPD Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         goto movups_mr;
                     case OpcodeF3Prefix: // MOVNTSS Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE4A);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE4A);
                         break;
                     case OpcodeF2Prefix: // MOVNTSD Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE4A);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE4A);
                         break;
                 }
-                break;
-            case 0x12C:
+                DISPATCH_NEXT();
+            OPCODE(0x12C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // CVTTPS2PI Rm, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // CVTTPD2PI Rm, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // CVTTSS2SI Rv, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // CVTTSD2SI Rv, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x12D:
+                DISPATCH_NEXT();
+            OPCODE(0x12D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // CVTPS2PI Rm, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // CVTPD2PI Rm, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // CVTSS2SI Rv, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // CVTSD2SI Rv, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x12E:
+                DISPATCH_NEXT();
+            OPCODE(0x12E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // UCOMISS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // UCOMISD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // VUCOMXSS Rx, Mx
                     case OpcodeF2Prefix: // VUCOMXSD Rx, Mx
                         ALWAYS_UD();
                 }
-                break;
-            case 0x12F:
+                DISPATCH_NEXT();
+            OPCODE(0x12F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // COMISS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // COMISD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // COMXSS Rx, Mx
                     case OpcodeF2Prefix: // COMXSD Rx, Mx
                         ALWAYS_UD();
                 }
-                break;
-            case 0x130: // WRMSR
+                DISPATCH_NEXT();
+            OPCODE(0x130): // WRMSR
                 GP_WITHOUT_CPL0();
-                break;
-            case 0x131: // RDTSC
-                break;
-            case 0x132: // RDMSR
+                DISPATCH_NEXT();
+            OPCODE(0x131): // RDTSC
+                if constexpr (z8086Context::OPCODES_V20) { // INS Rb, Rb
+                    // Always register operands, whatever mod says
+                    ModRM modrm = pc.read_advance<ModRM>();
+                    FAULT_CHECK(ctx.INS_BITS(ctx.index_byte_regMB(modrm.M()), ctx.index_byte_regR(modrm.R())));
+                }
+                DISPATCH_NEXT();
+            OPCODE(0x132): // RDMSR
                 GP_WITHOUT_CPL0();
-                break;
-            case 0x133: // RDPMC
-                break;
-            case 0x134: // SYSENTER
-            case 0x135: // SYSEXIT
+                DISPATCH_NEXT();
+            OPCODE(0x133): // RDPMC
+                if constexpr (z8086Context::OPCODES_V20) { // EXT Rb, Rb
+                    ModRM modrm = pc.read_advance<ModRM>();
+                    FAULT_CHECK(ctx.EXT_BITS(ctx.index_byte_regMB(modrm.M()), ctx.index_byte_regR(modrm.R())));
+                }
+                DISPATCH_NEXT();
+            OPCODE(0x134): // SYSENTER
+            OPCODE(0x135): // SYSEXIT
             [[unlikely]] case 0x138: // Three byte opcodes A
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
                 map = 2;
                 goto next_byte;
             [[unlikely]] case 0x13A: // Three byte opcodes B
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
                 map = 3;
                 goto next_byte;
-            case 0x141: // CMOVNO Rv, Mv
+            OPCODE(0x141): // CMOVNO Rv, Mv
                 // KAND Rk, Vk, Mk (VEX)
-            case 0x140: // CMOVO Rv, Mv
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
-                FAULT_CHECK(ctx.binopRM(pc, [=](auto& dst, auto src) {
+            OPCODE(0x140): // CMOVO Rv, Mv
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
+                FAULT_CHECK(ctx.binopRM(pc, [=, this](auto& dst, auto src) {
                     ctx.CMOVCC<CondNO>(dst, src, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x142: // CMOVC Rv, Mv
+                DISPATCH_NEXT();
+            OPCODE(0x142): // CMOVC Rv, Mv
                 // KANDN Rk, Vk, Mk (VEX)
-            case 0x143: // CMOVNC Rv, Mv
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
-                FAULT_CHECK(ctx.binopRM(pc, [=](auto& dst, auto src) {
+            OPCODE(0x143): // CMOVNC Rv, Mv
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
+                FAULT_CHECK(ctx.binopRM(pc, [=, this](auto& dst, auto src) {
                     ctx.CMOVCC<CondNC>(dst, src, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x144: // CMOVZ Rv, Mv
+                DISPATCH_NEXT();
+            OPCODE(0x144): // CMOVZ Rv, Mv
                 // KNOT Rk, Mk (VEX)
-            case 0x145: // CMOVNZ Rv, Mv
+            OPCODE(0x145): // CMOVNZ Rv, Mv
                 // KOR Rk, Vk, Mk (VEX)
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
-                FAULT_CHECK(ctx.binopRM(pc, [=](auto& dst, auto src) {
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
+                FAULT_CHECK(ctx.binopRM(pc, [=, this](auto& dst, auto src) {
                     ctx.CMOVCC<CondNZ>(dst, src, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x146: // CMOVBE Rv, Mv
+                DISPATCH_NEXT();
+            OPCODE(0x146): // CMOVBE Rv, Mv
                 // KXNOR Rk, Vk, Mk (VEX)
-            case 0x147: // CMOVA Rv, Mv
+            OPCODE(0x147): // CMOVA Rv, Mv
                 // KXOR Rk, Vk, Mk (VEX)
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
-                FAULT_CHECK(ctx.binopRM(pc, [=](auto& dst, auto src) {
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
+                FAULT_CHECK(ctx.binopRM(pc, [=, this](auto& dst, auto src) {
                     ctx.CMOVCC<CondA>(dst, src, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x148: // CMOVS Rv, Mv
-            case 0x149: // CMOVNS Rv, Mv
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
-                FAULT_CHECK(ctx.binopRM(pc, [=](auto& dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x148): // CMOVS Rv, Mv
+            OPCODE(0x149): // CMOVNS Rv, Mv
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
+                FAULT_CHECK(ctx.binopRM(pc, [=, this](auto& dst, auto src) {
                     ctx.CMOVCC<CondNS>(dst, src, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x14A: // CMOVP Rv, Mv
+                DISPATCH_NEXT();
+            OPCODE(0x14A): // CMOVP Rv, Mv
                 // KADD Rk, Vk, Mk (VEX)
-            case 0x14B: // CMOVNP Rv, Mv
+            OPCODE(0x14B): // CMOVNP Rv, Mv
                 // KUNPCK Rk, Vk, Mk (VEX)
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
-                FAULT_CHECK(ctx.binopRM(pc, [=](auto& dst, auto src) {
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
+                FAULT_CHECK(ctx.binopRM(pc, [=, this](auto& dst, auto src) {
                     ctx.CMOVCC<CondNP>(dst, src, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x14C: // CMOVL Rv, Mv
-            case 0x14D: // CMOVGE Rv, Mv
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
-                FAULT_CHECK(ctx.binopRM(pc, [=](auto& dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x14C): // CMOVL Rv, Mv
+            OPCODE(0x14D): // CMOVGE Rv, Mv
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
+                FAULT_CHECK(ctx.binopRM(pc, [=, this](auto& dst, auto src) {
                     ctx.CMOVCC<CondGE>(dst, src, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x14E: // CMOVLE Rv, Mv
-            case 0x14F: // CMOVG Rv, Mv
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_CMOV);
-                FAULT_CHECK(ctx.binopRM(pc, [=](auto& dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x14E): // CMOVLE Rv, Mv
+            OPCODE(0x14F): // CMOVG Rv, Mv
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_CMOV);
+                FAULT_CHECK(ctx.binopRM(pc, [=, this](auto& dst, auto src) {
                     ctx.CMOVCC<CondG>(dst, src, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x150:
+                DISPATCH_NEXT();
+            OPCODE(0x150):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVMSKPS Rv, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // MOVMSKPD Rv, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x151:
+                DISPATCH_NEXT();
+            OPCODE(0x151):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // SQRTPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // SQRTPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // SQRTSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // SQRTSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x152:
+                DISPATCH_NEXT();
+            OPCODE(0x152):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // RSQRTPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix:
                         ALWAYS_UD();
                     case OpcodeF3Prefix: // RSQRTSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x153: // RCPPS/RCPSS Rx, Mx
+                DISPATCH_NEXT();
+            OPCODE(0x153): // RCPPS/RCPSS Rx, Mx
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // RCPPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix:
                         ALWAYS_UD();
                     case OpcodeF3Prefix: // RCPSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x154: // ANDPS/ANDPD Rx, Mx
+                DISPATCH_NEXT();
+            OPCODE(0x154): // ANDPS/ANDPD Rx, Mx
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // ANDPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         goto pand;
                     case Opcode66Prefix: // ANDPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         goto pand;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x155:
+                DISPATCH_NEXT();
+            OPCODE(0x155):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // ANDNPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         goto pandn;
                     case Opcode66Prefix: // ANDNPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         goto pandn;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x156:
+                DISPATCH_NEXT();
+            OPCODE(0x156):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // ORPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         goto por;
                     case Opcode66Prefix: // ORPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         goto por;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x157:
+                DISPATCH_NEXT();
+            OPCODE(0x157):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // XORPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         goto pxor;
                     case Opcode66Prefix: // XORPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         goto pxor;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x158:
+                DISPATCH_NEXT();
+            OPCODE(0x158):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // ADDPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // ADDPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // ADDSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // ADDSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x159:
+                DISPATCH_NEXT();
+            OPCODE(0x159):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MULPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // MULPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // MULSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // MULSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x15A:
-                THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                DISPATCH_NEXT();
+            OPCODE(0x15A):
+                THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // CVTPS2PD Rx, Mx
@@ -2877,104 +3569,104 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // CVTSD2SS Rx, Mx
                         break;
                 }
-                break;
-            case 0x15B:
+                DISPATCH_NEXT();
+            OPCODE(0x15B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // CVTDQ2PS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case Opcode66Prefix: // CVTPS2DQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // CVTTPS2DQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x15C:
+                DISPATCH_NEXT();
+            OPCODE(0x15C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // SUBPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // SUBPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // SUBSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // SUBSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x15D:
+                DISPATCH_NEXT();
+            OPCODE(0x15D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MINPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // MINPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // MINSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // MINSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x15E:
+                DISPATCH_NEXT();
+            OPCODE(0x15E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // DIVPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // DIVPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // DIVSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // DIVSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x15F:
+                DISPATCH_NEXT();
+            OPCODE(0x15F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MAXPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // MAXPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // MAXSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // MAXSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x160:
+                DISPATCH_NEXT();
+            OPCODE(0x160):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PUNPCKLBW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKL(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PUNPCKLBW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKL(dst, src);
                             return OP_WRITE;
                         }));
@@ -2983,20 +3675,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x161:
+                DISPATCH_NEXT();
+            OPCODE(0x161):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PUNPCKLWD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKL(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PUNPCKLWD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKL(dst, src);
                             return OP_WRITE;
                         }));
@@ -3005,21 +3697,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x162:
+                DISPATCH_NEXT();
+            OPCODE(0x162):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PUNPCKLDQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKL(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PUNPCKLDQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                     punpckldq_sse:
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKL(dst, src);
                             return OP_WRITE;
                         }));
@@ -3028,19 +3720,19 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x163:
+                DISPATCH_NEXT();
+            OPCODE(0x163):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PACKSSWB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             return ctx.PACKSS(dst, src);
                         }));
                         break;
                     case Opcode66Prefix: // PACKSSWB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             return ctx.PACKSS(dst, src);
                         }));
                         break;
@@ -3048,20 +3740,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x164:
+                DISPATCH_NEXT();
+            OPCODE(0x164):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PCMPGTB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPGT(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PCMPGTB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPGT(dst, src);
                             return OP_WRITE;
                         }));
@@ -3070,20 +3762,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x165:
+                DISPATCH_NEXT();
+            OPCODE(0x165):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PCMPGTW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPGT(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PCMPGTW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPGT(dst, src);
                             return OP_WRITE;
                         }));
@@ -3092,20 +3784,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x166:
+                DISPATCH_NEXT();
+            OPCODE(0x166):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PCMPGTD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPGT(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PCMPGTD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPGT(dst, src);
                             return OP_WRITE;
                         }));
@@ -3114,19 +3806,19 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x167:
+                DISPATCH_NEXT();
+            OPCODE(0x167):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PACKUSWB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             return ctx.PACKUS(dst, src);
                         }));
                         break;
                     case Opcode66Prefix: // PACKUSWB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             return ctx.PACKUS(dst, src);
                         }));
                         break;
@@ -3134,20 +3826,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x168:
+                DISPATCH_NEXT();
+            OPCODE(0x168):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PUNPCKHBW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKH(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PUNPCKHBW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKH(dst, src);
                             return OP_WRITE;
                         }));
@@ -3156,20 +3848,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x169:
+                DISPATCH_NEXT();
+            OPCODE(0x169):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PUNPCKHWD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKH(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PUNPCKHWD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKH(dst, src);
                             return OP_WRITE;
                         }));
@@ -3178,21 +3870,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x16A:
+                DISPATCH_NEXT();
+            OPCODE(0x16A):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PUNPCKHDQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKH(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PUNPCKHDQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                     punpckhdq_sse:
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKH(dst, src);
                             return OP_WRITE;
                         }));
@@ -3201,19 +3893,19 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x16B:
+                DISPATCH_NEXT();
+            OPCODE(0x16B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PACKSSDW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             return ctx.PACKSS(dst, src);
                         }));
                         break;
                     case Opcode66Prefix: // PACKSSDW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             return ctx.PACKSS(dst, src);
                         }));
                         break;
@@ -3221,15 +3913,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x16C:
+                DISPATCH_NEXT();
+            OPCODE(0x16C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PUNPCKLQDQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKL(dst, src);
                             return OP_WRITE;
                         }));
@@ -3238,15 +3930,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x16D:
+                DISPATCH_NEXT();
+            OPCODE(0x16D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PUNPCKHQDQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PUNPCKH(dst, src);
                             return OP_WRITE;
                         }));
@@ -3255,36 +3947,36 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x16E:
+                DISPATCH_NEXT();
+            OPCODE(0x16E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVD Rm, Mv
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
                         break;
                     case Opcode66Prefix: // MOVD Rx, Mv
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x16F:
+                DISPATCH_NEXT();
+            OPCODE(0x16F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM(pc, [&](auto& dst, auto src) regcall {
                             dst = src;
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // MOVDQA Rx, Mx
                     case OpcodeF3Prefix: // MOVDQU Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                     movups_rm:
-                        FAULT_CHECK_SSE(ctx.binopRM_XX(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopRM_XX(pc, [&](auto& dst, auto src) regcall {
                             dst = src;
                             return OP_WRITE;
                         }));
@@ -3293,79 +3985,79 @@ dllexport void z86_execute() {
                         ALWAYS_UD();
                         goto movups_rm;
                 }
-                break;
-            case 0x170:
+                DISPATCH_NEXT();
+            OPCODE(0x170):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSHUFW Rm, Mm, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // PSHUFD Rx, Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // PSHUFHW Rx, Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF2Prefix: // PSHUFLW Rx, Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x171:
+                DISPATCH_NEXT();
+            OPCODE(0x171):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // GRP12 Mm, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
                         break;
                     case Opcode66Prefix: // GRP12 Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x172:
+                DISPATCH_NEXT();
+            OPCODE(0x172):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // GRP13 Mm, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
                         break;
                     case Opcode66Prefix: // GRP13 Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x173:
+                DISPATCH_NEXT();
+            OPCODE(0x173):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // GRP14 Mm, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
                         break;
                     case Opcode66Prefix: // GRP14 Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x174:
+                DISPATCH_NEXT();
+            OPCODE(0x174):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PCMPEQB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPEQ(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PCMPEQB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPEQ(dst, src);
                             return OP_WRITE;
                         }));
@@ -3374,20 +4066,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x175:
+                DISPATCH_NEXT();
+            OPCODE(0x175):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PCMPEQW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPEQ(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PCMPEQW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPEQ(dst, src);
                             return OP_WRITE;
                         }));
@@ -3396,20 +4088,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x176:
+                DISPATCH_NEXT();
+            OPCODE(0x176):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PCMPEQD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPEQ(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PCMPEQD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPEQ(dst, src);
                             return OP_WRITE;
                         }));
@@ -3418,21 +4110,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x177:
+                DISPATCH_NEXT();
+            OPCODE(0x177):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // EMMS
                         // VZEROUPPER, VZEROALL (VEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
                         goto femms;
                     case Opcode66Prefix:
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x178:
+                DISPATCH_NEXT();
+            OPCODE(0x178):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // VMREAD Mv, Rv
@@ -3440,18 +4132,18 @@ dllexport void z86_execute() {
                         ALWAYS_UD();
                     case Opcode66Prefix: // EXTRQ Mx, Ib, Ib
                         // VCVTTPS2UQQ (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE4A);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE4A);
                         break;
                     case OpcodeF3Prefix:
                         // VCVTTSS2USI Rv, Mx (EVEX)
                         ALWAYS_UD();
                     case OpcodeF2Prefix: // INSERTQ Rx, Mx, Ib, Ib
                         // VCVTTSD2USI Rv, Mx (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE4A);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE4A);
                         break;
                 }
-                break;
-            case 0x179:
+                DISPATCH_NEXT();
+            OPCODE(0x179):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // VMWRITE Rv, Mv
@@ -3459,18 +4151,18 @@ dllexport void z86_execute() {
                         ALWAYS_UD();
                     case Opcode66Prefix: // EXTRQ Rx, Mx
                         // VCVTPS2UQQ (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE4A);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE4A);
                         break;
                     case OpcodeF3Prefix:
                         // VCVTSS2USI Rv, Mx (EVEX)
                         ALWAYS_UD();
                     case OpcodeF2Prefix: // INSERTQ Rx, Mx
                         // VCVTSD2USI Rv, Mx (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE4A);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE4A);
                         break;
                 }
-                break;
-            case 0x17A:
+                DISPATCH_NEXT();
+            OPCODE(0x17A):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -3480,8 +4172,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VCVTUDQ2PS (EVEX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x17B:
+                DISPATCH_NEXT();
+            OPCODE(0x17B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -3491,71 +4183,71 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VCVTUSI2SD (EVEX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x17C:
+                DISPATCH_NEXT();
+            OPCODE(0x17C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // HADDPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                         break;
                     case OpcodeF3Prefix:
                         ALWAYS_UD();
                     case OpcodeF2Prefix: // HADDPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                         break;
                 }
-                break;
-            case 0x17D:
+                DISPATCH_NEXT();
+            OPCODE(0x17D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // HSUBPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                         break;
                     case OpcodeF3Prefix:
                         ALWAYS_UD();
                     case OpcodeF2Prefix: // HSUBPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                         break;
                 }
-                break;
-            case 0x17E:
+                DISPATCH_NEXT();
+            OPCODE(0x17E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVD Mv, Rm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
                         break;
                     case Opcode66Prefix: // MOVD Mm, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // MOVQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x17F:
+                DISPATCH_NEXT();
+            OPCODE(0x17F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVQ Mm, Rm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
                     movq_mmx:
-                        FAULT_CHECK_MMX(ctx.binopMR_MM(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_MMX(ctx.binopMR_MM(pc, [&](auto& dst, auto src) regcall {
                             dst = src;
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // MOVDQA Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         goto movups_mr;
                     case OpcodeF3Prefix: // MOVDQU Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                     movups_mr:
-                        FAULT_CHECK_SSE(ctx.binopMR_XX(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopMR_XX(pc, [&](auto& dst, auto src) regcall {
                             dst = src;
                             return OP_WRITE;
                         }));
@@ -3564,235 +4256,235 @@ dllexport void z86_execute() {
                         ALWAYS_UD();
                         goto movups_mr;
                 }
-                break;
-            case 0x180: // JO Jz
-            case 0x181: // JNO Jz
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                ctx.JCC<CondNO>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x182: // JC Jz
-            case 0x183: // JNC Jz
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                ctx.JCC<CondNC>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x184: // JZ Jz
-            case 0x185: // JNZ Jz
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                ctx.JCC<CondNZ>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x186: // JBE Jz
-            case 0x187: // JA Jz
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                ctx.JCC<CondA>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x188: // JS Jz
-            case 0x189: // JNS Jz
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                ctx.JCC<CondNS>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x18A: // JP Jz
-            case 0x18B: // JNP Jz
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                ctx.JCC<CondNP>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x18C: // JL Jz
-            case 0x18D: // JGE Jz
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                ctx.JCC<CondGE>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x18E: // JLE Jz
-            case 0x18F: // JG Jz
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                ctx.JCC<CondG>(pc, opcode_byte & 1);
-                goto next_instr;
-            case 0x190: // SETO Mb
+                DISPATCH_NEXT();
+            OPCODE(0x180): // JO Jz
+            OPCODE(0x181): // JNO Jz
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                ctx.branch_cycles(ctx.JCC<CondNO>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x182): // JC Jz
+            OPCODE(0x183): // JNC Jz
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                ctx.branch_cycles(ctx.JCC<CondNC>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x184): // JZ Jz
+            OPCODE(0x185): // JNZ Jz
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                ctx.branch_cycles(ctx.JCC<CondNZ>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x186): // JBE Jz
+            OPCODE(0x187): // JA Jz
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                ctx.branch_cycles(ctx.JCC<CondA>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x188): // JS Jz
+            OPCODE(0x189): // JNS Jz
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                ctx.branch_cycles(ctx.JCC<CondNS>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x18A): // JP Jz
+            OPCODE(0x18B): // JNP Jz
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                ctx.branch_cycles(ctx.JCC<CondNP>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x18C): // JL Jz
+            OPCODE(0x18D): // JGE Jz
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                ctx.branch_cycles(ctx.JCC<CondGE>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x18E): // JLE Jz
+            OPCODE(0x18F): // JG Jz
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                ctx.branch_cycles(ctx.JCC<CondG>(pc, opcode_byte & 1));
+                DISPATCH_JUMP();
+            OPCODE(0x190): // SETO Mb
                 // KMOV Rk, Mk (VEX)
-            case 0x191: // SETNO Mb
+            OPCODE(0x191): // SETNO Mb
                 // KMOV Mk, Rk (VEX)
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.unopM<true>(pc, [=](auto& dst, uint8_t r) regcall {
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.unopM<true>(pc, [=, this](auto& dst, uint8_t r) regcall {
                     ctx.SETCC<CondNO>(dst, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x192: // SETC Mb
+                DISPATCH_NEXT();
+            OPCODE(0x192): // SETC Mb
                 // KMOV Rk, Mv
-            case 0x193: // SETNC Mb
+            OPCODE(0x193): // SETNC Mb
                 // KMOV Rv, Mk
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.unopM<true>(pc, [=](auto& dst, uint8_t r) regcall {
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.unopM<true>(pc, [=, this](auto& dst, uint8_t r) regcall {
                     ctx.SETCC<CondNC>(dst, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x194: // SETZ Mb
-            case 0x195: // SETNZ Mb
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.unopM<true>(pc, [=](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x194): // SETZ Mb
+            OPCODE(0x195): // SETNZ Mb
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.unopM<true>(pc, [=, this](auto& dst, uint8_t r) regcall {
                     ctx.SETCC<CondNZ>(dst, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x196: // SETBE Mb
-            case 0x197: // SETA Mb
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.unopM<true>(pc, [=](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x196): // SETBE Mb
+            OPCODE(0x197): // SETA Mb
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.unopM<true>(pc, [=, this](auto& dst, uint8_t r) regcall {
                     ctx.SETCC<CondA>(dst, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x198: // SETS Mb
+                DISPATCH_NEXT();
+            OPCODE(0x198): // SETS Mb
                 // KORTEST Rk, Mk (VEX)
-            case 0x199: // SETNS Mb
+            OPCODE(0x199): // SETNS Mb
                 // KTEST Rk, Mk (VEX)
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.unopM<true>(pc, [=](auto& dst, uint8_t r) regcall {
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.unopM<true>(pc, [=, this](auto& dst, uint8_t r) regcall {
                     ctx.SETCC<CondNS>(dst, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x19A: // SETP Mb
-            case 0x19B: // SETNP Mb
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.unopM<true>(pc, [=](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x19A): // SETP Mb
+            OPCODE(0x19B): // SETNP Mb
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.unopM<true>(pc, [=, this](auto& dst, uint8_t r) regcall {
                     ctx.SETCC<CondNP>(dst, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x19C: // SETL Mb
-            case 0x19D: // SETGE Mb
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.unopM<true>(pc, [=](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x19C): // SETL Mb
+            OPCODE(0x19D): // SETGE Mb
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.unopM<true>(pc, [=, this](auto& dst, uint8_t r) regcall {
                     ctx.SETCC<CondGE>(dst, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x19E: // SETLE Mb
-            case 0x19F: // SETG Mb
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.unopM<true>(pc, [=](auto& dst, uint8_t r) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x19E): // SETLE Mb
+            OPCODE(0x19F): // SETG Mb
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.unopM<true>(pc, [=, this](auto& dst, uint8_t r) regcall {
                     ctx.SETCC<CondG>(dst, opcode_byte & 1);
                     return true;
                 }));
-                break;
-            case 0x1A0: // PUSH FS
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1A0): // PUSH FS
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 ctx.PUSH(ctx.fs);
-                break;
-            case 0x1A1: // POP FS
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1A1): // POP FS
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 ctx.fs = ctx.POP<uint16_t>();
-                break;
-            case 0x1A2: // CPUID
+                DISPATCH_NEXT();
+            OPCODE(0x1A2): // CPUID
                 // TODO
-                break;
-            case 0x1A3: // BT Mv, Gv
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopMRB(pc, [](auto dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x1A3): // BT Mv, Gv
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopMRB(pc, [&](auto dst, auto src) {
                     ctx.BT(dst, src);
                     return false;
                 }));
-                break;
-            case 0x1A4: // SHLD Mv, Gv, Ib
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1A4): // SHLD Mv, Gv, Ib
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) {
                     ctx.SHLD(dst, src, pc.read<uint8_t>());
                     return true;
                 }));
                 ++pc;
-                break;
-            case 0x1A5: // SHLD Mv, Gv, CL
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x1A5): // SHLD Mv, Gv, CL
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) {
                     ctx.SHLD(dst, src, ctx.cl);
                     return true;
                 }));
-                break;
-            case 0x1A8: // PUSH GS
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1A8): // PUSH GS
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 ctx.PUSH(ctx.gs);
-                break;
-            case 0x1A9: // POP GS
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1A9): // POP GS
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 ctx.gs = ctx.POP<uint16_t>();
-                break;
-            case 0x1AA: // RSM
+                DISPATCH_NEXT();
+            OPCODE(0x1AA): // RSM
                 // TODO
-                break;
-            case 0x1AB: // BTS Mv, Rv
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x1AB): // BTS Mv, Rv
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) {
                     ctx.BTS(dst, src);
                     return true;
                 }));
-                break;
-            case 0x1AC: // SHRD Mv, Rv, Ib
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1AC): // SHRD Mv, Rv, Ib
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 FAULT_CHECK(ctx.binopMR(pc, [&](auto dst, auto src) {
                     ctx.SHRD(dst, src, pc.read<uint8_t>());
                     return true;
                 }));
                 ++pc;
-                break;
-            case 0x1AD: // SHRD Mv, Rv, CL
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopMR(pc, [](auto dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x1AD): // SHRD Mv, Rv, CL
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto dst, auto src) {
                     ctx.SHRD(dst, src, ctx.cl);
                     return true;
                 }));
-                break;
-            case 0x1AE: // GRP15
+                DISPATCH_NEXT();
+            OPCODE(0x1AE): // GRP15
                 // TODO
-                break;
-            case 0x1AF: // IMUL Rv, Mv
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x1AF): // IMUL Rv, Mv
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) {
                     ctx.IMUL(dst, src);
                     return true;
                 }));
-                break;
-            case 0x1B0: // CMPXCHG Mb, Rb
-            case 0x1B1: // CMPXCHG Mv, Rb
+                DISPATCH_NEXT();
+            OPCODE(0x1B0): // CMPXCHG Mb, Rb
+            OPCODE(0x1B1): // CMPXCHG Mv, Rb
                 // TODO
-                break;
-            case 0x1B2: // LSS Rv, M
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopRMF(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x1B2): // LSS Rv, M
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopRMF(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     ctx.ss = src >> (bitsof(src) >> 1);
                     return true;
                 }));
-                break;
-            case 0x1B3: // BTR Mv, Rv
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x1B3): // BTR Mv, Rv
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) {
                     ctx.BTR(dst, src);
                     return true;
                 }));
-                break;
-            case 0x1B4: case 0x1B5: // LFS/LGS Rv, M
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopRMF(pc, [=](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x1B4): OPCODE(0x1B5): // LFS/LGS Rv, M
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopRMF(pc, [=, this](auto& dst, auto src) regcall {
                     dst = src;
                     ctx.write_seg(FS + (opcode_byte & 1), src >> (bitsof(src) >> 1));
                     return true;
                 }));
-                break;
-            case 0x1B6: // MOVZX Rv, Mb
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.MOVX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x1B6): // MOVZX Rv, Mb
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.MOVX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     return OP_NOT_MEM;
                 }));
-                break;
-            case 0x1B7: // MOVZX Rv, Mw
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.MOVX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                DISPATCH_NEXT();
+            OPCODE(0x1B7): // MOVZX Rv, Mw
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.MOVX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                     dst = src;
                     return OP_NOT_MEM;
                 }));
-                break;
-            case 0x1B8:
+                DISPATCH_NEXT();
+            OPCODE(0x1B8):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case Opcode66Prefix: // POPCNT Rv, Mv
@@ -3808,170 +4500,170 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1BA: // GRP8 Mv, Ib
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1BA): // GRP8 Mv, Ib
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 // TODO
-                break;
-            case 0x1BB: // BTC Mv, Gv
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.binopMR(pc, [](auto& dst, auto src) {
+                DISPATCH_NEXT();
+            OPCODE(0x1BB): // BTC Mv, Gv
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.binopMR(pc, [&](auto& dst, auto src) {
                     ctx.BTC(dst, src);
                     return true;
                 }));
-                break;
-            case 0x1BC: // BSF Rv, Mv
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1BC): // BSF Rv, Mv
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 if (ctx.rep_type > 0) { // TZCNT Rv, Mv
                     // TODO
                 }
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) {
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) {
                     ctx.BSF(dst, src);
                     return true;
                 }));
-                break;
-            case 0x1BD: // BSR Rv, Mv
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
+                DISPATCH_NEXT();
+            OPCODE(0x1BD): // BSR Rv, Mv
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
                 if (ctx.rep_type > 0) { // LZCNT Rv, Mv
                     // TODO
                 }
-                FAULT_CHECK(ctx.binopRM(pc, [](auto& dst, auto src) {
+                FAULT_CHECK(ctx.binopRM(pc, [&](auto& dst, auto src) {
                     ctx.BSR(dst, src);
                     return true;
                 }));
-                break;
-            case 0x1BE: // MOVSX Rv, Mb
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.MOVX<int8_t>(pc, [](auto& dst, auto src) regcall{
+                DISPATCH_NEXT();
+            OPCODE(0x1BE): // MOVSX Rv, Mb
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.MOVX<int8_t>(pc, [&](auto& dst, auto src) regcall{
                     using S = decltype(src);
                     using D = std::remove_reference_t<decltype(dst)>;
                     dst = (D)(S)src;
                     return OP_NOT_MEM;
                 }));
-                break;
-            case 0x1BF: // MOVSX Rv, Mw
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80386);
-                FAULT_CHECK(ctx.MOVX<int16_t>(pc, [](auto& dst, auto src) regcall{
+                DISPATCH_NEXT();
+            OPCODE(0x1BF): // MOVSX Rv, Mw
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80386);
+                FAULT_CHECK(ctx.MOVX<int16_t>(pc, [&](auto& dst, auto src) regcall{
                     using S = decltype(src);
                     using D = std::remove_reference_t<decltype(dst)>;
                     dst = (D)(S)src;
                     return OP_NOT_MEM;
                 }));
-                break;
-            case 0x1C0: // XADD Mb, Rb
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80486);
+                DISPATCH_NEXT();
+            OPCODE(0x1C0): // XADD Mb, Rb
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80486);
                 // TODO
-                break;
-            case 0x1C1: // XADD Mv, Rv
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80486);
+                DISPATCH_NEXT();
+            OPCODE(0x1C1): // XADD Mv, Rv
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80486);
                 // TODO
-                break;
-            case 0x1C2:
+                DISPATCH_NEXT();
+            OPCODE(0x1C2):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // CMPccPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // CMPccPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // CMPccSS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case OpcodeF2Prefix: // CMPccSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x1C3:
+                DISPATCH_NEXT();
+            OPCODE(0x1C3):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVNTI Mv, Rv
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case Opcode66Prefix:
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1C4:
+                DISPATCH_NEXT();
+            OPCODE(0x1C4):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PINSRW Rm, Mw, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // PINSRW Rx, Mw, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1C5:
+                DISPATCH_NEXT();
+            OPCODE(0x1C5):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PEXTRW Rv, Mm, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // PEXTRW Rv, Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1C6:
+                DISPATCH_NEXT();
+            OPCODE(0x1C6):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // SHUFPS Rx, Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // SHUFPD Rx, Mx, Ib
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1C7: // GRP9
+                DISPATCH_NEXT();
+            OPCODE(0x1C7): // GRP9
                 // TODO
-                break;
-            case 0x1C8: case 0x1C9: case 0x1CA: case 0x1CB: case 0x1CC: case 0x1CD: case 0x1CE: case 0x1CF: // BSWAP reg
-                THROW_UD_WITHOUT_FLAG(ctx.OPCODES_80486);
+                DISPATCH_NEXT();
+            OPCODE(0x1C8): OPCODE(0x1C9): OPCODE(0x1CA): OPCODE(0x1CB): OPCODE(0x1CC): OPCODE(0x1CD): OPCODE(0x1CE): OPCODE(0x1CF): // BSWAP reg
+                THROW_UD_WITHOUT_FLAG(z8086Context::OPCODES_80486);
                 ctx.BSWAP(ctx.index_regMB<uint16_t>(opcode_byte & 7));
-                break;
-            case 0x1D0:
+                DISPATCH_NEXT();
+            OPCODE(0x1D0):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // ADDSUBPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                         break;
                     case OpcodeF3Prefix:
                         ALWAYS_UD();
                     case OpcodeF2Prefix: // ADDSUBPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                         break;
                 }
-                break;
-            case 0x1D1:
+                DISPATCH_NEXT();
+            OPCODE(0x1D1):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSRLW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<uint64_t>(src));
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSRLW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<vec<uint64_t, sizeof(src) / sizeof(uint64_t)>>(src)[0]);
                             return OP_WRITE;
                         }));
@@ -3980,20 +4672,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1D2:
+                DISPATCH_NEXT();
+            OPCODE(0x1D2):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSRLD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<uint64_t>(src));
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSRLD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<vec<uint64_t, sizeof(src) / sizeof(uint64_t)>>(src)[0]);
                             return OP_WRITE;
                         }));
@@ -4002,20 +4694,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1D3:
+                DISPATCH_NEXT();
+            OPCODE(0x1D3):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSRLQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<uint64_t>(src));
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSRLQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<vec<uint64_t, sizeof(src) / sizeof(uint64_t)>>(src)[0]);
                             return OP_WRITE;
                         }));
@@ -4024,20 +4716,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1D4:
+                DISPATCH_NEXT();
+            OPCODE(0x1D4):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PADDQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE2);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PADDQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4046,20 +4738,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1D5:
+                DISPATCH_NEXT();
+            OPCODE(0x1D5):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMULLW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMULL(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMULLW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMULL(dst, src);
                             return OP_WRITE;
                         }));
@@ -4068,54 +4760,54 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1D6:
+                DISPATCH_NEXT();
+            OPCODE(0x1D6):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // MOVQ Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // MOVQ2DQ Rx, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF2Prefix: // MOVDQ2Q Rm, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE2);
-                        FAULT_CHECK_MMX_SSE(ctx.binopRM_MX<uint64_t>(pc, [](auto& dst, auto src) {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_MMX_SSE(ctx.binopRM_MX<uint64_t>(pc, [&](auto& dst, auto src) {
                             dst[0] = src[0];
                             return OP_WRITE;
                         }));
                         break;
                 }
-                break;
-            case 0x1D7:
+                DISPATCH_NEXT();
+            OPCODE(0x1D7):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMOVMSKB Rv, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                         break;
                     case Opcode66Prefix: // PMOVMSKB Rv, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1D8:
+                DISPATCH_NEXT();
+            OPCODE(0x1D8):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSUBUSB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSUBS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSUBUSB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -4124,20 +4816,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1D9:
+                DISPATCH_NEXT();
+            OPCODE(0x1D9):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSUBUSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSUBUSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -4146,20 +4838,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1DA:
+                DISPATCH_NEXT();
+            OPCODE(0x1DA):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMINUB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMIN(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMINUB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMIN(dst, src);
                             return OP_WRITE;
                         }));
@@ -4168,21 +4860,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1DB:
+                DISPATCH_NEXT();
+            OPCODE(0x1DB):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PAND Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PAND(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PAND Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                     pand:
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PAND(dst, src);
                             return OP_WRITE;
                         }));
@@ -4191,20 +4883,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1DC:
+                DISPATCH_NEXT();
+            OPCODE(0x1DC):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PADDUSB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PADDUSB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -4213,20 +4905,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1DD:
+                DISPATCH_NEXT();
+            OPCODE(0x1DD):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PADDUSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PADDUSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -4235,20 +4927,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1DE:
+                DISPATCH_NEXT();
+            OPCODE(0x1DE):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMAXUB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMAX(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMAXUB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMAX(dst, src);
                             return OP_WRITE;
                         }));
@@ -4257,21 +4949,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1DF:
+                DISPATCH_NEXT();
+            OPCODE(0x1DF):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PANDN Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PANDN(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PANDN Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                     pandn:
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PANDN(dst, src);
                             return OP_WRITE;
                         }));
@@ -4280,21 +4972,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E0:
+                DISPATCH_NEXT();
+            OPCODE(0x1E0):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PAVGB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                     pavgb_mmx:
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PAVG(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PAVGB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PAVG(dst, src);
                             return OP_WRITE;
                         }));
@@ -4303,20 +4995,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E1:
+                DISPATCH_NEXT();
+            OPCODE(0x1E1):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSRAW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<uint64_t>(src));
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSRAW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<vec<uint64_t, sizeof(src) / sizeof(uint64_t)>>(src)[0]);
                             return OP_WRITE;
                         }));
@@ -4325,20 +5017,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E2:
+                DISPATCH_NEXT();
+            OPCODE(0x1E2):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSRAD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<uint64_t>(src));
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSRAD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHR(dst, std::bit_cast<vec<uint64_t, sizeof(src) / sizeof(uint64_t)>>(src)[0]);
                             return OP_WRITE;
                         }));
@@ -4347,20 +5039,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E3:
+                DISPATCH_NEXT();
+            OPCODE(0x1E3):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PAVGW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PAVG(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PAVGW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PAVG(dst, src);
                             return OP_WRITE;
                         }));
@@ -4369,20 +5061,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E4:
+                DISPATCH_NEXT();
+            OPCODE(0x1E4):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMULHUW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMULH(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMULHUW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMULH(dst, src);
                             return OP_WRITE;
                         }));
@@ -4391,20 +5083,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E5:
+                DISPATCH_NEXT();
+            OPCODE(0x1E5):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMULHW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMULH(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMULHW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMULH(dst, src);
                             return OP_WRITE;
                         }));
@@ -4413,50 +5105,50 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E6:
+                DISPATCH_NEXT();
+            OPCODE(0x1E6):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // CVTTPD2DQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix: // CVTDQ2PD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF2Prefix: // CVTDQ2PD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                 }
-                break;
-            case 0x1E7:
+                DISPATCH_NEXT();
+            OPCODE(0x1E7):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MOVNTQ Mm, Rm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
                         goto movq_mmx;
                     case Opcode66Prefix: // MOVNTDQ Mx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E8:
+                DISPATCH_NEXT();
+            OPCODE(0x1E8):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSUBSB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSUBS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSUBSB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -4465,20 +5157,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1E9:
+                DISPATCH_NEXT();
+            OPCODE(0x1E9):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSUBSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSUBSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -4487,20 +5179,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1EA:
+                DISPATCH_NEXT();
+            OPCODE(0x1EA):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMINSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMIN(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMINSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMIN(dst, src);
                             return OP_WRITE;
                         }));
@@ -4509,21 +5201,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1EB:
+                DISPATCH_NEXT();
+            OPCODE(0x1EB):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // POR Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.POR(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // POR Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                     por:
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.POR(dst, src);
                             return OP_WRITE;
                         }));
@@ -4532,20 +5224,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1EC:
+                DISPATCH_NEXT();
+            OPCODE(0x1EC):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PADDSB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PADDSB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -4554,20 +5246,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1ED:
+                DISPATCH_NEXT();
+            OPCODE(0x1ED):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PADDSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PADDSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -4576,20 +5268,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1EE:
+                DISPATCH_NEXT();
+            OPCODE(0x1EE):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMAXSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMAX(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMAXSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMAX(dst, src);
                             return OP_WRITE;
                         }));
@@ -4598,21 +5290,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1EF:
+                DISPATCH_NEXT();
+            OPCODE(0x1EF):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PXOR Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PXOR(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PXOR Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
                     pxor:
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PXOR(dst, src);
                             return OP_WRITE;
                         }));
@@ -4621,33 +5313,33 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F0:
+                DISPATCH_NEXT();
+            OPCODE(0x1F0):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix:
                         ALWAYS_UD();
                     case OpcodeF3Prefix: // LDDQU Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE3);
                         goto movups_rm;
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F1:
+                DISPATCH_NEXT();
+            OPCODE(0x1F1):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSLLW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHL(dst, std::bit_cast<uint64_t>(src));
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSLLW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHL(dst, std::bit_cast<vec<uint64_t, sizeof(src) / sizeof(uint64_t)>>(src)[0]);
                             return OP_WRITE;
                         }));
@@ -4656,20 +5348,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F2:
+                DISPATCH_NEXT();
+            OPCODE(0x1F2):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSLLD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHL(dst, std::bit_cast<uint64_t>(src));
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSLLD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHL(dst, std::bit_cast<vec<uint64_t, sizeof(src) / sizeof(uint64_t)>>(src)[0]);
                             return OP_WRITE;
                         }));
@@ -4678,20 +5370,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F3:
+                DISPATCH_NEXT();
+            OPCODE(0x1F3):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSLLQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHL(dst, std::bit_cast<uint64_t>(src));
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSLLQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSHL(dst, std::bit_cast<vec<uint64_t, sizeof(src) / sizeof(uint64_t)>>(src)[0]);
                             return OP_WRITE;
                         }));
@@ -4700,20 +5392,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F4:
+                DISPATCH_NEXT();
+            OPCODE(0x1F4):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMULUDQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE2);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMUL(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMULUDQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMUL(dst, src);
                             return OP_WRITE;
                         }));
@@ -4722,20 +5414,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F5:
+                DISPATCH_NEXT();
+            OPCODE(0x1F5):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMADDWD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PMADDWD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4744,20 +5436,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F6:
+                DISPATCH_NEXT();
+            OPCODE(0x1F6):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSADBW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSAD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSADBW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSAD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4766,19 +5458,19 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F7:
+                DISPATCH_NEXT();
+            OPCODE(0x1F7):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // MASKMOVQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [](auto dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [&](auto dst, auto src) regcall {
                             return ctx.MASKMOV(dst, src);
                         }));
                         break;
                     case Opcode66Prefix: // MASKMOVDQU Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto dst, auto src) regcall {
                             return ctx.MASKMOV(dst, src);
                         }));
                         break;
@@ -4786,20 +5478,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F8:
+                DISPATCH_NEXT();
+            OPCODE(0x1F8):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSUBB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PSUB(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSUBB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4808,20 +5500,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1F9:
+                DISPATCH_NEXT();
+            OPCODE(0x1F9):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSUBW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSUBW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4830,20 +5522,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1FA:
+                DISPATCH_NEXT();
+            OPCODE(0x1FA):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSUBD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSUBD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4852,20 +5544,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1FB:
+                DISPATCH_NEXT();
+            OPCODE(0x1FB):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSUBQ Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSE2);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint64_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint64_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSUBQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4874,20 +5566,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1FC:
+                DISPATCH_NEXT();
+            OPCODE(0x1FC):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PADDB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint8_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PADDB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint8_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4896,20 +5588,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1FD:
+                DISPATCH_NEXT();
+            OPCODE(0x1FD):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PADDW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PADDW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4918,20 +5610,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x1FE:
+                DISPATCH_NEXT();
+            OPCODE(0x1FE):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PADDD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PADDD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE2);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall{
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE2);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall{
                             dst = ctx.PADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4940,34 +5632,34 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x200:
+                DISPATCH_NEXT();
+            OPCODE(0x200):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSHUFB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
                         break;
                     case Opcode66Prefix: // PSHUFB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x201:
+                DISPATCH_NEXT();
+            OPCODE(0x201):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PHADDW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PHADDW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4976,20 +5668,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x202:
+                DISPATCH_NEXT();
+            OPCODE(0x202):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PHADDD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHADD(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PHADDD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHADD(dst, src);
                             return OP_WRITE;
                         }));
@@ -4998,20 +5690,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x203:
+                DISPATCH_NEXT();
+            OPCODE(0x203):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PHADDSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHADDS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PHADDSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHADDS(dst, src);
                             return OP_WRITE;
                         }));
@@ -5020,34 +5712,34 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x204:
+                DISPATCH_NEXT();
+            OPCODE(0x204):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMADDUBSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
                         break;
                     case Opcode66Prefix: // PMADDUBSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x205:
+                DISPATCH_NEXT();
+            OPCODE(0x205):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PHSUBW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHSUB(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PHSUBW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHSUB(dst, src);
                             return OP_WRITE;
                         }));
@@ -5056,20 +5748,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x206:
+                DISPATCH_NEXT();
+            OPCODE(0x206):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PHSUBD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHSUB(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PHSUBD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHSUB(dst, src);
                             return OP_WRITE;
                         }));
@@ -5078,20 +5770,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x207:
+                DISPATCH_NEXT();
+            OPCODE(0x207):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PHSUBSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHSUBS(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PHSUBSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PHSUBS(dst, src);
                             return OP_WRITE;
                         }));
@@ -5100,20 +5792,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x208:
+                DISPATCH_NEXT();
+            OPCODE(0x208):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSIGNB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSIGN(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSIGNB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSIGN(dst, src);
                             return OP_WRITE;
                         }));
@@ -5122,20 +5814,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x209:
+                DISPATCH_NEXT();
+            OPCODE(0x209):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSIGNW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSIGN(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSIGNW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSIGN(dst, src);
                             return OP_WRITE;
                         }));
@@ -5144,20 +5836,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x20A:
+                DISPATCH_NEXT();
+            OPCODE(0x20A):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PSIGND Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSIGN(dst, src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PSIGND Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PSIGN(dst, src);
                             return OP_WRITE;
                         }));
@@ -5166,88 +5858,88 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x20B:
+                DISPATCH_NEXT();
+            OPCODE(0x20B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PMULHRSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
                         break;
                     case Opcode66Prefix: // PMULHRSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x20C:
+                DISPATCH_NEXT();
+            OPCODE(0x20C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VPERMILPS Rx, Vx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x20D:
+                DISPATCH_NEXT();
+            OPCODE(0x20D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VPERMILPD Rx, Vx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x20E:
+                DISPATCH_NEXT();
+            OPCODE(0x20E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VTESTPS Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x20F:
+                DISPATCH_NEXT();
+            OPCODE(0x20F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VTESTPD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x210:
+                DISPATCH_NEXT();
+            OPCODE(0x210):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PBLENDVB Rx, Mx, XMM0
                         // VPSRLVW Rx, Vx, Mx (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVUSWB Mx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x211:
+                DISPATCH_NEXT();
+            OPCODE(0x211):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -5256,8 +5948,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x212:
+                DISPATCH_NEXT();
+            OPCODE(0x212):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -5266,8 +5958,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x213:
+                DISPATCH_NEXT();
+            OPCODE(0x213):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -5276,101 +5968,101 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x214:
+                DISPATCH_NEXT();
+            OPCODE(0x214):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // BLENDVPS Rx, Mx, XMM0
                         // VPRORVD Rx, Vx, Mx (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVUSDW Mx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x215:
+                DISPATCH_NEXT();
+            OPCODE(0x215):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // BLENDVPD Rx, Mx, XMM0
                         // VPROLVD Rx, Vx, Mx (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVUSQD Mx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x216:
+                DISPATCH_NEXT();
+            OPCODE(0x216):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VPERMPS Rx, Vx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x217:
+                DISPATCH_NEXT();
+            OPCODE(0x217):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PTEST Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x218:
+                DISPATCH_NEXT();
+            OPCODE(0x218):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VBROADCASTSS Rx, M
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x219:
+                DISPATCH_NEXT();
+            OPCODE(0x219):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VBROADCASTSD Rx, M
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x21A:
+                DISPATCH_NEXT();
+            OPCODE(0x21A):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VBROADCASTF128 Rx, M
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x21B:
+                DISPATCH_NEXT();
+            OPCODE(0x21B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -5379,20 +6071,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x21C:
+                DISPATCH_NEXT();
+            OPCODE(0x21C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PABSB Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PABS(src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PABSB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PABS(src);
                             return OP_WRITE;
                         }));
@@ -5401,20 +6093,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x21D:
+                DISPATCH_NEXT();
+            OPCODE(0x21D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PABSW Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PABS(src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PABSW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PABS(src);
                             return OP_WRITE;
                         }));
@@ -5423,20 +6115,20 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x21E:
+                DISPATCH_NEXT();
+            OPCODE(0x21E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // PABSD Rm, Mm
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_MMX && ctx.CPUID_SSSE3);
-                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_MMX && z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_MMX(ctx.binopRM_MM<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PABS(src);
                             return OP_WRITE;
                         }));
                         break;
                     case Opcode66Prefix: // PABSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSSE3);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSSE3);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PABS(src);
                             return OP_WRITE;
                         }));
@@ -5445,15 +6137,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x21F:
+                DISPATCH_NEXT();
+            OPCODE(0x21F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VPABSQ Rx, Mx (EVEX)
                         ALWAYS_UD();
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int64_t>(pc, [](auto& dst, auto src) regcall {
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PABS(src);
                             return OP_WRITE;
                         }));
@@ -5462,80 +6154,80 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x220:
+                DISPATCH_NEXT();
+            OPCODE(0x220):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVSXBW Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVSWB Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x221:
+                DISPATCH_NEXT();
+            OPCODE(0x221):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVSXBD Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVSDB Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x222:
+                DISPATCH_NEXT();
+            OPCODE(0x222):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVSXBQ Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVSQB Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x223:
+                DISPATCH_NEXT();
+            OPCODE(0x223):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVSXWD Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVSDW Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x224:
+                DISPATCH_NEXT();
+            OPCODE(0x224):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVSXWQ Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVSQW Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x225:
+                DISPATCH_NEXT();
+            OPCODE(0x225):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVSXDQ Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVSQD Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x226:
+                DISPATCH_NEXT();
+            OPCODE(0x226):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -5544,8 +6236,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x227:
+                DISPATCH_NEXT();
+            OPCODE(0x227):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -5554,15 +6246,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x228:
+                DISPATCH_NEXT();
+            OPCODE(0x228):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMULDQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PABS(src);
                             return OP_WRITE;
                         }));
@@ -5571,15 +6263,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x229:
+                DISPATCH_NEXT();
+            OPCODE(0x229):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PCMPEQQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPEQ(dst, src);
                             return OP_WRITE;
                         }));
@@ -5588,28 +6280,28 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x22A:
+                DISPATCH_NEXT();
+            OPCODE(0x22A):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // MOVNTDQA Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         goto movups_rm;
                     case OpcodeF3Prefix: // VPBROADCASTMB2Q Rx, Mk (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x22B:
+                DISPATCH_NEXT();
+            OPCODE(0x22B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PACKUSDW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             return ctx.PACKUS(dst, src);
                         }));
                         break;
@@ -5617,153 +6309,153 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x22C:
+                DISPATCH_NEXT();
+            OPCODE(0x22C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VMASKMOVPS Rx, Vx, Mx
                         // VSCALEFPS Rx, Vx, Mx (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x22D:
+                DISPATCH_NEXT();
+            OPCODE(0x22D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VMASKMOVPD Rx, Vx, Mx
                         // VSCALEFSS Rx, Vx, Mx (EVEX)
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x22E:
+                DISPATCH_NEXT();
+            OPCODE(0x22E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VMASKMOVPS Mx, Vx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x22F:
+                DISPATCH_NEXT();
+            OPCODE(0x22F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VMASKMOVPD Mx, Vx, Rx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x230:
+                DISPATCH_NEXT();
+            OPCODE(0x230):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVZXBW Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVWB Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x231:
+                DISPATCH_NEXT();
+            OPCODE(0x231):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVZXBD Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVDB Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x232:
+                DISPATCH_NEXT();
+            OPCODE(0x232):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVZXBQ Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVQB Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x233:
+                DISPATCH_NEXT();
+            OPCODE(0x233):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVZXWD Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVDW Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x234:
+                DISPATCH_NEXT();
+            OPCODE(0x234):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVZXWQ Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVQW Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x235:
+                DISPATCH_NEXT();
+            OPCODE(0x235):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // PMOVZXDQ Rx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix: // VPMOVQD Wx, Rx (EVEX)
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x236:
+                DISPATCH_NEXT();
+            OPCODE(0x236):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // VPERMD Rx, Vx, Wx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x237:
+                DISPATCH_NEXT();
+            OPCODE(0x237):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PCMPGTQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int64_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int64_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PCMPGT(dst, src);
                             return OP_WRITE;
                         }));
@@ -5772,15 +6464,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x238:
+                DISPATCH_NEXT();
+            OPCODE(0x238):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMINSB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMIN(dst, src);
                             return OP_WRITE;
                         }));
@@ -5789,15 +6481,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x239:
+                DISPATCH_NEXT();
+            OPCODE(0x239):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMINSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMIN(dst, src);
                             return OP_WRITE;
                         }));
@@ -5806,15 +6498,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x23A:
+                DISPATCH_NEXT();
+            OPCODE(0x23A):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMINUW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMIN(dst, src);
                             return OP_WRITE;
                         }));
@@ -5823,15 +6515,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x23B:
+                DISPATCH_NEXT();
+            OPCODE(0x23B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMINUD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMIN(dst, src);
                             return OP_WRITE;
                         }));
@@ -5840,15 +6532,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x23C:
+                DISPATCH_NEXT();
+            OPCODE(0x23C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMAXSB Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int8_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMAX(dst, src);
                             return OP_WRITE;
                         }));
@@ -5857,15 +6549,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x23D:
+                DISPATCH_NEXT();
+            OPCODE(0x23D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMAXSD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<int32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMAX(dst, src);
                             return OP_WRITE;
                         }));
@@ -5874,15 +6566,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x23E:
+                DISPATCH_NEXT();
+            OPCODE(0x23E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMAXUW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint16_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMAX(dst, src);
                             return OP_WRITE;
                         }));
@@ -5891,15 +6583,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x23F:
+                DISPATCH_NEXT();
+            OPCODE(0x23F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMAXUD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMAX(dst, src);
                             return OP_WRITE;
                         }));
@@ -5908,15 +6600,15 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x240:
+                DISPATCH_NEXT();
+            OPCODE(0x240):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PMULLD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
-                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [](auto& dst, auto src) regcall {
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
+                        FAULT_CHECK_SSE(ctx.binopRM_XX<uint32_t>(pc, [&](auto& dst, auto src) regcall {
                             dst = ctx.PMULL(dst, src);
                             return OP_WRITE;
                         }));
@@ -5925,21 +6617,21 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x241:
+                DISPATCH_NEXT();
+            OPCODE(0x241):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // PHMINPOSUW Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_SSE41);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_SSE41);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x242:
+                DISPATCH_NEXT();
+            OPCODE(0x242):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -5948,8 +6640,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x243:
+                DISPATCH_NEXT();
+            OPCODE(0x243):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -5958,8 +6650,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x244:
+                DISPATCH_NEXT();
+            OPCODE(0x244):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // VPLZCNTB Rx, Mx (EVEX)
@@ -5968,47 +6660,47 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VPTZCNTD Rx, Mx (EVEX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x245:
+                DISPATCH_NEXT();
+            OPCODE(0x245):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VPSRLVD Rx, Vx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x246:
+                DISPATCH_NEXT();
+            OPCODE(0x246):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VPSRAVD Rx, Vx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x247:
+                DISPATCH_NEXT();
+            OPCODE(0x247):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                         ALWAYS_UD();
                     case Opcode66Prefix: // VPSLLVD Rx, Vx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x248:
+                DISPATCH_NEXT();
+            OPCODE(0x248):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // TTMMULTF32PS Rt, Mt, Vt (AMX)
@@ -6017,8 +6709,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x249:
+                DISPATCH_NEXT();
+            OPCODE(0x249):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // LDTILECFG M, TILERELEASE (AMX)
@@ -6027,8 +6719,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // TILEZERO Rt
                         ALWAYS_UD();
                 }
-                break;
-            case 0x24A:
+                DISPATCH_NEXT();
+            OPCODE(0x24A):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6038,8 +6730,8 @@ dllexport void z86_execute() {
                     case OpcodeF3Prefix: // TCVTROWD2PS Rx, Mt, Vv (AMX, EVEX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x24B:
+                DISPATCH_NEXT();
+            OPCODE(0x24B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6049,8 +6741,8 @@ dllexport void z86_execute() {
                     case OpcodeF3Prefix: // TILESTORED M, Rt
                         ALWAYS_UD();
                 }
-                break;
-            case 0x24C:
+                DISPATCH_NEXT();
+            OPCODE(0x24C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6059,8 +6751,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x24D:
+                DISPATCH_NEXT();
+            OPCODE(0x24D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6069,8 +6761,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x24E:
+                DISPATCH_NEXT();
+            OPCODE(0x24E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6079,8 +6771,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x24F:
+                DISPATCH_NEXT();
+            OPCODE(0x24F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6089,8 +6781,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x250:
+                DISPATCH_NEXT();
+            OPCODE(0x250):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // VPDPBUUD Rx, Vx, Mx (AVX VNNI)
@@ -6099,8 +6791,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VPDPBSSD Rx, Vx, Mx (AVX VNNI)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x251:
+                DISPATCH_NEXT();
+            OPCODE(0x251):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // VPDPBUUDS Rx, Vx, Mx (AVX VNNI)
@@ -6109,8 +6801,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VPDPBSSDS Rx, Vx, Mx (AVX VNNI)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x252:
+                DISPATCH_NEXT();
+            OPCODE(0x252):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // VDPPHPS Rx, Vx, Mx (AVX 10.2)
@@ -6119,8 +6811,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VP4DPWSSD Rx, Vx, Mx (EVEX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x253:
+                DISPATCH_NEXT();
+            OPCODE(0x253):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6129,8 +6821,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VP4DPWSSDS Rx, Vx, Mx (EVX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x254:
+                DISPATCH_NEXT();
+            OPCODE(0x254):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6139,8 +6831,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x255:
+                DISPATCH_NEXT();
+            OPCODE(0x255):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6149,44 +6841,44 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x258:
+                DISPATCH_NEXT();
+            OPCODE(0x258):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // VPBROADCASTD Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x259:
+                DISPATCH_NEXT();
+            OPCODE(0x259):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // VPBROADCASTQ Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x25A:
+                DISPATCH_NEXT();
+            OPCODE(0x25A):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
                     case Opcode66Prefix: // VBROADCASTI128 Rx, Mx
-                        THROW_UD_WITHOUT_FLAG(ctx.CPUID_AVX2);
+                        THROW_UD_WITHOUT_FLAG(z8086Context::CPUID_AVX2);
                         break;
                     case OpcodeF3Prefix:
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x25B:
+                DISPATCH_NEXT();
+            OPCODE(0x25B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6195,8 +6887,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x25C:
+                DISPATCH_NEXT();
+            OPCODE(0x25C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6205,8 +6897,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // TDPFP16PS Rt, Mt, Vt (AMX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x25E:
+                DISPATCH_NEXT();
+            OPCODE(0x25E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // TDPBUUD Rt, Mt, Vt (AMX)
@@ -6215,8 +6907,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // TDPBSSD Rt, Mt, Vt (AMX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x25F:
+                DISPATCH_NEXT();
+            OPCODE(0x25F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6225,8 +6917,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x262:
+                DISPATCH_NEXT();
+            OPCODE(0x262):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6235,8 +6927,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x263:
+                DISPATCH_NEXT();
+            OPCODE(0x263):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6245,8 +6937,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x264:
+                DISPATCH_NEXT();
+            OPCODE(0x264):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6255,8 +6947,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x265:
+                DISPATCH_NEXT();
+            OPCODE(0x265):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6265,8 +6957,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x266:
+                DISPATCH_NEXT();
+            OPCODE(0x266):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6275,8 +6967,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x267:
+                DISPATCH_NEXT();
+            OPCODE(0x267):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6285,8 +6977,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x268:
+                DISPATCH_NEXT();
+            OPCODE(0x268):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6295,8 +6987,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VP2INTERSECTD (EVEX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x26B:
+                DISPATCH_NEXT();
+            OPCODE(0x26B):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // TCONJTCMMIMFP16PS Rt, Mt, Vt (AMX)
@@ -6305,8 +6997,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // TTCMMIMFP16PS Rt, Mt, Vt (AMX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x26C:
+                DISPATCH_NEXT();
+            OPCODE(0x26C):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // TCMMRLFP16PS Rt, Mt, Vt (AMX)
@@ -6315,8 +7007,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // TTDPFP16PS Rt, Mt, Vt (AMX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x26D:
+                DISPATCH_NEXT();
+            OPCODE(0x26D):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // TCVTROWPS2PHH Rx, Mt, Vv (AMX, EVEX)
@@ -6325,8 +7017,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // TCVTROWPS2PBF16H Rt, Mt, Vt (AMX, EVEX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x26E:
+                DISPATCH_NEXT();
+            OPCODE(0x26E):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // T2RPNTLVWZ0 Rt, M (AMX)
@@ -6337,8 +7029,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x26F:
+                DISPATCH_NEXT();
+            OPCODE(0x26F):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // T2RPNTLVWZ0 Rt, M (AMX)
@@ -6349,8 +7041,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x270:
+                DISPATCH_NEXT();
+            OPCODE(0x270):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6359,8 +7051,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x271:
+                DISPATCH_NEXT();
+            OPCODE(0x271):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6369,8 +7061,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x272:
+                DISPATCH_NEXT();
+            OPCODE(0x272):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6379,8 +7071,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VCVTNE2PS2BF16 Rx, Vx, Mx (EVEX)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x273:
+                DISPATCH_NEXT();
+            OPCODE(0x273):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6389,8 +7081,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x274:
+                DISPATCH_NEXT();
+            OPCODE(0x274):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix: // VCVTBIASPH2BF8 Rx, Vx, Mx (EVEX, AVX 10.2)
@@ -6399,8 +7091,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix: // VCVTNE2PH2BF8 Rx, Vx, Mx (EVEX, AVX 10.2)
                         ALWAYS_UD();
                 }
-                break;
-            case 0x275:
+                DISPATCH_NEXT();
+            OPCODE(0x275):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6409,8 +7101,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x276:
+                DISPATCH_NEXT();
+            OPCODE(0x276):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6421,8 +7113,8 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            case 0x277:
+                DISPATCH_NEXT();
+            OPCODE(0x277):
                 switch (ctx.opcode_select()) {
                     default: unreachable;
                     case OpcodeNoPrefix:
@@ -6432,12 +7124,12 @@ dllexport void z86_execute() {
                     case OpcodeF2Prefix:
                         ALWAYS_UD();
                 }
-                break;
-            default:
+                DISPATCH_NEXT();
+            default: op_default:
                 //ALWAYS_UD();
                 unreachable;
             fault:
-                if constexpr (ctx.FAULTS_ARE_TRAPS) {
+                if constexpr (z8086Context::FAULTS_ARE_TRAPS) {
                     goto trap;
                 }
                 goto next_instr;
@@ -6445,6 +7137,24 @@ dllexport void z86_execute() {
     trap:
         ctx.ip = pc.offset;
     next_instr:
+        if constexpr (z8086Context::PROTECTED_MODE) {
+            // Segment limit or rights violation, every exit
+            // lands here so the fault sees the instruction start
+            if (expect(ctx.access_fault, false)) {
+                ctx.access_fault = false;
+                ctx.rip = fault_ip;
+                ctx.rsp = fault_sp;
+                ctx.cs = fault_cs;
+            }
+        }
         ctx.execute_pending_interrupts();
     }
-}
\ No newline at end of file
+    ctx.run_events.fetch_and(~(events & EventStop), std::memory_order_relaxed);
+    return ctx.clock - start;
+}
+
+}
+
+z86Machine* Z86_MODEL_FACTORY() {
+    return new (std::nothrow) z86MachineImpl();
+}
@@ -68,6 +68,24 @@ struct PortDwordDevice {
     }
 };
 
+struct MemoryDevice {
+    // Receive data from CPU
+    virtual void write_byte(uint32_t addr, uint8_t value) {
+    }
+    virtual void write_word(uint32_t addr, uint16_t value) {
+        this->write_byte(addr, value);
+        this->write_byte(addr + 1, value >> 8);
+    }
+
+    // Send data to CPU
+    virtual uint8_t read_byte(uint32_t addr) {
+        return 0xFF;
+    }
+    virtual uint16_t read_word(uint32_t addr) {
+        return this->read_byte(addr) | this->read_byte(addr + 1) << 8;
+    }
+};
+
 enum Interrupt : uint8_t {
     // 8086
     IntDE = 0,
@@ -96,16 +114,100 @@ enum Interrupt : uint8_t {
     IntCP = 21
 };
 
+// Conditions that can end a z86_run_until slice early
+enum RunEvent : uint32_t {
+    EventHalt = 1, // Halted with no interrupt pending
+    EventInterrupt = 2, // An NMI or external interrupt was taken
+    EventStop = 4 // z86_stop was called
+};
+
+// Runs on the CPU thread once the clock reaches the scheduled cycle,
+// clock is the actual cycle which may be a little later
+typedef void (*SchedulerCallback)(void* data, size_t clock);
+
+// Independent emulated PCs. Every other z86_* function acts on the
+// machine the calling thread last selected, or on a default 8086
+// machine when it hasn't selected one. Threads raising interrupts or
+// stopping a machine have to select it as well.
+struct z86Machine;
+
+enum CpuModel : uint8_t {
+    Model8086,
+    Model80186,
+    ModelV30,
+    Model80286,
+    Model80386
+};
+
+// Returns NULL when out of memory, z86_init it after selecting it
+z86Machine* z86_create_machine(CpuModel model = Model8086);
+// The default machine is never destroyed
+void z86_destroy_machine(z86Machine* machine);
+// NULL selects the default machine
+void z86_select_machine(z86Machine* machine);
+z86Machine* z86_current_machine();
+
+void z86_init();
 void z86_execute();
+size_t z86_run(size_t cycles);
+size_t z86_run_until(uint32_t events, size_t cycles = SIZE_MAX);
+uint32_t z86_run_events();
+void z86_stop();
+
+// Only safe on the CPU thread or between slices
+size_t z86_clock();
+uint32_t z86_schedule(size_t clock, SchedulerCallback callback, void* data);
+bool z86_deschedule(uint32_t id);
 void z86_interrupt(uint8_t number);
 void z86_cancel_interrupt();
 void z86_nmi();
 void z86_reset();
+// Real mode far jump, for starting code loaded without going through the BIOS
+void z86_jump(uint16_t cs, uint16_t ip);
+
+// Values narrower than a field are zero extended
+struct z86Registers {
+    uint32_t gpr[8]; // AX, CX, DX, BX, SP, BP, SI, DI
+    uint32_t ip;
+    uint32_t flags;
+    uint16_t seg[6]; // ES, CS, SS, DS, FS, GS
+};
+void z86_get_registers(z86Registers& registers);
 
+// Devices added this way are asked about every port nothing is mapped to
 void z86_add_dword_device(PortDwordDevice* device);
 void z86_add_word_device(PortWordDevice* device);
 void z86_add_byte_device(PortByteDevice* device);
 
+// Routes ports first, first + stride, ... up to last straight to device,
+// which doesn't need to check the port number itself. A stride of 2
+// covers the odd or even only port decoding most PC-98 devices use.
+bool z86_map_dword_ports(PortDwordDevice* device, uint16_t first, uint16_t last, uint16_t stride = 1);
+bool z86_map_word_ports(PortWordDevice* device, uint16_t first, uint16_t last, uint16_t stride = 1);
+bool z86_map_byte_ports(PortByteDevice* device, uint16_t first, uint16_t last, uint16_t stride = 1);
+size_t z86_unhandled_port_accesses();
+
+// Both are rounded out to whole 4 KB pages. Word accesses
+// that cross out of a device's pages are split into bytes.
+void z86_map_memory_device(MemoryDevice* device, size_t first, size_t length);
+void z86_map_ram(size_t first, size_t length);
+
+// Picks how much of the model's address space is RAM, the rest
+// reads as open bus. Drops anything mapped over RAM, so call it
+// before mapping devices or ROMs.
+bool z86_set_memory_size(size_t bytes);
+
+// Masks address bit 20 when disabled. Only 286 and later have the gate.
+void z86_set_a20(bool enabled);
+bool z86_a20();
+
+// Copies data into memory at first and makes the range read only
+void z86_load_rom(size_t first, const void* data, size_t length);
+// Maps data read only at first without copying it. first has to be
+// page aligned and data has to stay valid and cover whole pages,
+// which a file mapping does.
+void z86_map_rom(size_t first, const void* data, size_t length);
+
 size_t z86_mem_write(size_t dst, const void* src, size_t size);
 
 template <typename T>
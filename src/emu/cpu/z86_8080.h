@@ -0,0 +1,409 @@
+#pragma once
+
+#ifndef Z86_8080_H
+#define Z86_8080_H 1
+
+// 8080 emulation mode of the V20/V30, entered with BRKEM.
+// The 8080 registers are the native ones (A=AL, BC=CX, DE=DX,
+// HL=BX, SP=BP, PC=IP) and its flags are the low flag byte,
+// which has the same layout, so the native byte ALU ops are
+// used as is. Code is fetched from CS, all data including
+// the stack lives in DS. Clock counts are the Intel 8080 ones.
+//
+// Included by the core after z86_core_internal_post.h.
+
+static inline constexpr uint8_t z8080_cycles[256] = {
+     4, 10,  7,  5,  5,  5,  7,  4,  4, 10,  7,  5,  5,  5,  7,  4,
+     4, 10,  7,  5,  5,  5,  7,  4,  4, 10,  7,  5,  5,  5,  7,  4,
+     4, 10, 16,  5,  5,  5,  7,  4,  4, 10, 16,  5,  5,  5,  7,  4,
+     4, 10, 13,  5, 10, 10, 10,  4,  4, 10, 13,  5,  5,  5,  7,  4,
+     5,  5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,
+     5,  5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,
+     5,  5,  5,  5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  7,  5,
+     7,  7,  7,  7,  7,  7,  7,  7,  5,  5,  5,  5,  5,  5,  7,  5,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4,
+     5, 10, 10, 10, 11, 11,  7, 11,  5, 10, 10, 10, 11, 17,  7, 11,
+     5, 10, 10, 10, 11, 11,  7, 11,  5, 10, 10, 10, 11, 17,  7, 11,
+     5, 10, 10, 18, 11, 11,  7, 11,  5,  5, 10,  5, 11, 17,  7, 11,
+     5, 10, 10,  4, 11, 11,  7, 11,  5,  5, 10,  4, 11, 17,  7, 11,
+};
+
+// Extra clocks for a taken conditional CALL/RET
+static inline constexpr uint8_t z8080_branch_taken = 6;
+
+// Runs 8080 code until it leaves the mode or halts, or the
+// deadline passes, which also covers requests from outside
+static inline void z86_run_8080(z86MachineImpl* const machine) {
+#if USE_THREADED_DISPATCH
+#define OP8080(n) case n: op8080_##n
+    static const void* const dispatch_table[256] = {
+        &&op8080_0x00, &&op8080_0x01, &&op8080_0x02, &&op8080_0x03, &&op8080_0x04, &&op8080_0x05, &&op8080_0x06, &&op8080_0x07,
+        &&op8080_0x08, &&op8080_0x09, &&op8080_0x0A, &&op8080_0x0B, &&op8080_0x0C, &&op8080_0x0D, &&op8080_0x0E, &&op8080_0x0F,
+        &&op8080_0x10, &&op8080_0x11, &&op8080_0x12, &&op8080_0x13, &&op8080_0x14, &&op8080_0x15, &&op8080_0x16, &&op8080_0x17,
+        &&op8080_0x18, &&op8080_0x19, &&op8080_0x1A, &&op8080_0x1B, &&op8080_0x1C, &&op8080_0x1D, &&op8080_0x1E, &&op8080_0x1F,
+        &&op8080_0x20, &&op8080_0x21, &&op8080_0x22, &&op8080_0x23, &&op8080_0x24, &&op8080_0x25, &&op8080_0x26, &&op8080_0x27,
+        &&op8080_0x28, &&op8080_0x29, &&op8080_0x2A, &&op8080_0x2B, &&op8080_0x2C, &&op8080_0x2D, &&op8080_0x2E, &&op8080_0x2F,
+        &&op8080_0x30, &&op8080_0x31, &&op8080_0x32, &&op8080_0x33, &&op8080_0x34, &&op8080_0x35, &&op8080_0x36, &&op8080_0x37,
+        &&op8080_0x38, &&op8080_0x39, &&op8080_0x3A, &&op8080_0x3B, &&op8080_0x3C, &&op8080_0x3D, &&op8080_0x3E, &&op8080_0x3F,
+        &&op8080_0x40, &&op8080_0x41, &&op8080_0x42, &&op8080_0x43, &&op8080_0x44, &&op8080_0x45, &&op8080_0x46, &&op8080_0x47,
+        &&op8080_0x48, &&op8080_0x49, &&op8080_0x4A, &&op8080_0x4B, &&op8080_0x4C, &&op8080_0x4D, &&op8080_0x4E, &&op8080_0x4F,
+        &&op8080_0x50, &&op8080_0x51, &&op8080_0x52, &&op8080_0x53, &&op8080_0x54, &&op8080_0x55, &&op8080_0x56, &&op8080_0x57,
+        &&op8080_0x58, &&op8080_0x59, &&op8080_0x5A, &&op8080_0x5B, &&op8080_0x5C, &&op8080_0x5D, &&op8080_0x5E, &&op8080_0x5F,
+        &&op8080_0x60, &&op8080_0x61, &&op8080_0x62, &&op8080_0x63, &&op8080_0x64, &&op8080_0x65, &&op8080_0x66, &&op8080_0x67,
+        &&op8080_0x68, &&op8080_0x69, &&op8080_0x6A, &&op8080_0x6B, &&op8080_0x6C, &&op8080_0x6D, &&op8080_0x6E, &&op8080_0x6F,
+        &&op8080_0x70, &&op8080_0x71, &&op8080_0x72, &&op8080_0x73, &&op8080_0x74, &&op8080_0x75, &&op8080_0x76, &&op8080_0x77,
+        &&op8080_0x78, &&op8080_0x79, &&op8080_0x7A, &&op8080_0x7B, &&op8080_0x7C, &&op8080_0x7D, &&op8080_0x7E, &&op8080_0x7F,
+        &&op8080_0x80, &&op8080_0x81, &&op8080_0x82, &&op8080_0x83, &&op8080_0x84, &&op8080_0x85, &&op8080_0x86, &&op8080_0x87,
+        &&op8080_0x88, &&op8080_0x89, &&op8080_0x8A, &&op8080_0x8B, &&op8080_0x8C, &&op8080_0x8D, &&op8080_0x8E, &&op8080_0x8F,
+        &&op8080_0x90, &&op8080_0x91, &&op8080_0x92, &&op8080_0x93, &&op8080_0x94, &&op8080_0x95, &&op8080_0x96, &&op8080_0x97,
+        &&op8080_0x98, &&op8080_0x99, &&op8080_0x9A, &&op8080_0x9B, &&op8080_0x9C, &&op8080_0x9D, &&op8080_0x9E, &&op8080_0x9F,
+        &&op8080_0xA0, &&op8080_0xA1, &&op8080_0xA2, &&op8080_0xA3, &&op8080_0xA4, &&op8080_0xA5, &&op8080_0xA6, &&op8080_0xA7,
+        &&op8080_0xA8, &&op8080_0xA9, &&op8080_0xAA, &&op8080_0xAB, &&op8080_0xAC, &&op8080_0xAD, &&op8080_0xAE, &&op8080_0xAF,
+        &&op8080_0xB0, &&op8080_0xB1, &&op8080_0xB2, &&op8080_0xB3, &&op8080_0xB4, &&op8080_0xB5, &&op8080_0xB6, &&op8080_0xB7,
+        &&op8080_0xB8, &&op8080_0xB9, &&op8080_0xBA, &&op8080_0xBB, &&op8080_0xBC, &&op8080_0xBD, &&op8080_0xBE, &&op8080_0xBF,
+        &&op8080_0xC0, &&op8080_0xC1, &&op8080_0xC2, &&op8080_0xC3, &&op8080_0xC4, &&op8080_0xC5, &&op8080_0xC6, &&op8080_0xC7,
+        &&op8080_0xC8, &&op8080_0xC9, &&op8080_0xCA, &&op8080_0xCB, &&op8080_0xCC, &&op8080_0xCD, &&op8080_0xCE, &&op8080_0xCF,
+        &&op8080_0xD0, &&op8080_0xD1, &&op8080_0xD2, &&op8080_0xD3, &&op8080_0xD4, &&op8080_0xD5, &&op8080_0xD6, &&op8080_0xD7,
+        &&op8080_0xD8, &&op8080_0xD9, &&op8080_0xDA, &&op8080_0xDB, &&op8080_0xDC, &&op8080_0xDD, &&op8080_0xDE, &&op8080_0xDF,
+        &&op8080_0xE0, &&op8080_0xE1, &&op8080_0xE2, &&op8080_0xE3, &&op8080_0xE4, &&op8080_0xE5, &&op8080_0xE6, &&op8080_0xE7,
+        &&op8080_0xE8, &&op8080_0xE9, &&op8080_0xEA, &&op8080_0xEB, &&op8080_0xEC, &&op8080_0xED, &&op8080_0xEE, &&op8080_0xEF,
+        &&op8080_0xF0, &&op8080_0xF1, &&op8080_0xF2, &&op8080_0xF3, &&op8080_0xF4, &&op8080_0xF5, &&op8080_0xF6, &&op8080_0xF7,
+        &&op8080_0xF8, &&op8080_0xF9, &&op8080_0xFA, &&op8080_0xFB, &&op8080_0xFC, &&op8080_0xFD, &&op8080_0xFE, &&op8080_0xFF,
+    };
+#else
+#define OP8080(n) case n
+#endif
+
+    // Register fields in opcode order, 6 is M (memory at HL)
+    uint8_t* const regs[8] = { &ctx.ch, &ctx.cl, &ctx.dh, &ctx.dl, &ctx.bh, &ctx.bl, NULL, &ctx.al };
+    // Register pair fields, SP is BP
+    uint16_t* const pairs[4] = { &ctx.cx, &ctx.dx, &ctx.bx, &ctx.bp };
+
+    auto load = [=](uint16_t offset) regcall {
+        return z86Addr(ctx.ds, offset).read<uint8_t>();
+    };
+    auto store = [=](uint16_t offset, uint8_t value) regcall {
+        z86Addr(ctx.ds, offset).write<uint8_t>(value);
+    };
+    auto push = [=](uint16_t value) regcall {
+        ctx.bp -= 2;
+        z86Addr(ctx.ds, ctx.bp).write<uint16_t>(value);
+    };
+    auto pop = [=]() regcall {
+        uint16_t value = z86Addr(ctx.ds, ctx.bp).read<uint16_t>();
+        ctx.bp += 2;
+        return value;
+    };
+    auto src = [&](uint8_t field) regcall {
+        return field == 6 ? load(ctx.bx) : *regs[field];
+    };
+    // Even fields of NZ, NC, PO, P test for a clear flag
+    auto condition = [=](uint8_t opcode) regcall {
+        bool flag;
+        switch (opcode >> 4 & 3) {
+            default: unreachable;
+            case 0: flag = ctx.get_zero(); break;
+            case 1: flag = ctx.get_carry(); break;
+            case 2: flag = ctx.get_parity(); break;
+            case 3: flag = ctx.get_sign(); break;
+        }
+        return flag == (bool)(opcode & 8);
+    };
+    // Anything the native loop has to handle ends the run
+    auto keep_running = [=]() regcall {
+        return ctx.clock < scheduler.deadline.load(std::memory_order_relaxed) && !ctx.trap;
+    };
+
+    // Threaded handlers jump straight to the next one
+    // and only come back out when the run ends
+#if USE_THREADED_DISPATCH
+#define NEXT_8080() { \
+    if (expect(!keep_running(), false)) goto leave; \
+    opcode = pc.read_advance<uint8_t>(); \
+    ctx.clock += z8080_cycles[opcode]; \
+    goto *dispatch_table[opcode]; \
+}
+#else
+#define NEXT_8080() break
+#endif
+
+    z86AddrCS pc = ctx.pc();
+    do {
+        uint8_t opcode = pc.read_advance<uint8_t>();
+        ctx.clock += z8080_cycles[opcode];
+#if USE_THREADED_DISPATCH
+        goto *dispatch_table[opcode];
+#endif
+        switch (opcode) {
+            OP8080(0x00): OP8080(0x08): OP8080(0x10): OP8080(0x18): // NOP
+            OP8080(0x20): OP8080(0x28): OP8080(0x30): OP8080(0x38):
+                NEXT_8080();
+            OP8080(0x01): OP8080(0x11): OP8080(0x21): OP8080(0x31): // LXI rp, d16
+                *pairs[opcode >> 4] = pc.read_advance<uint16_t>();
+                NEXT_8080();
+            OP8080(0x02): OP8080(0x12): // STAX rp
+                store(*pairs[opcode >> 4], ctx.al);
+                NEXT_8080();
+            OP8080(0x0A): OP8080(0x1A): // LDAX rp
+                ctx.al = load(*pairs[opcode >> 4]);
+                NEXT_8080();
+            OP8080(0x22): { // SHLD a16
+                z86Addr(ctx.ds, pc.read_advance<uint16_t>()).write<uint16_t>(ctx.bx);
+                NEXT_8080();
+            }
+            OP8080(0x2A): // LHLD a16
+                ctx.bx = z86Addr(ctx.ds, pc.read_advance<uint16_t>()).read<uint16_t>();
+                NEXT_8080();
+            OP8080(0x32): // STA a16
+                store(pc.read_advance<uint16_t>(), ctx.al);
+                NEXT_8080();
+            OP8080(0x3A): // LDA a16
+                ctx.al = load(pc.read_advance<uint16_t>());
+                NEXT_8080();
+            OP8080(0x03): OP8080(0x13): OP8080(0x23): OP8080(0x33): // INX rp
+                ++*pairs[opcode >> 4];
+                NEXT_8080();
+            OP8080(0x0B): OP8080(0x1B): OP8080(0x2B): OP8080(0x3B): // DCX rp
+                --*pairs[opcode >> 4];
+                NEXT_8080();
+            OP8080(0x04): OP8080(0x0C): OP8080(0x14): OP8080(0x1C): // INR r
+            OP8080(0x24): OP8080(0x2C): OP8080(0x3C):
+                ctx.INC(*regs[opcode >> 3 & 7]);
+                NEXT_8080();
+            OP8080(0x34): { // INR M
+                uint8_t value = load(ctx.bx);
+                ctx.INC(value);
+                store(ctx.bx, value);
+                NEXT_8080();
+            }
+            OP8080(0x05): OP8080(0x0D): OP8080(0x15): OP8080(0x1D): // DCR r
+            OP8080(0x25): OP8080(0x2D): OP8080(0x3D):
+                ctx.DEC(*regs[opcode >> 3 & 7]);
+                NEXT_8080();
+            OP8080(0x35): { // DCR M
+                uint8_t value = load(ctx.bx);
+                ctx.DEC(value);
+                store(ctx.bx, value);
+                NEXT_8080();
+            }
+            OP8080(0x06): OP8080(0x0E): OP8080(0x16): OP8080(0x1E): // MVI r, d8
+            OP8080(0x26): OP8080(0x2E): OP8080(0x3E):
+                *regs[opcode >> 3 & 7] = pc.read_advance<uint8_t>();
+                NEXT_8080();
+            OP8080(0x36): // MVI M, d8
+                store(ctx.bx, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0x07): // RLC
+                ctx.ROL(ctx.al, 1);
+                NEXT_8080();
+            OP8080(0x0F): // RRC
+                ctx.ROR(ctx.al, 1);
+                NEXT_8080();
+            OP8080(0x17): // RAL
+                ctx.RCL(ctx.al, 1);
+                NEXT_8080();
+            OP8080(0x1F): // RAR
+                ctx.RCR(ctx.al, 1);
+                NEXT_8080();
+            OP8080(0x09): OP8080(0x19): OP8080(0x29): OP8080(0x39): { // DAD rp
+                uint32_t sum = (uint32_t)ctx.bx + *pairs[opcode >> 4];
+                ctx.resolve_flags();
+                ctx.carry = sum > UINT16_MAX;
+                ctx.bx = sum;
+                NEXT_8080();
+            }
+            OP8080(0x27): // DAA
+                ctx.DAA();
+                NEXT_8080();
+            OP8080(0x2F): // CMA
+                ctx.al = ~ctx.al;
+                NEXT_8080();
+            OP8080(0x37): // STC
+                ctx.resolve_flags();
+                ctx.carry = true;
+                NEXT_8080();
+            OP8080(0x3F): // CMC
+                ctx.resolve_flags();
+                ctx.carry ^= 1;
+                NEXT_8080();
+            OP8080(0x40): OP8080(0x41): OP8080(0x42): OP8080(0x43): OP8080(0x44): OP8080(0x45): OP8080(0x47): // MOV r, r
+            OP8080(0x48): OP8080(0x49): OP8080(0x4A): OP8080(0x4B): OP8080(0x4C): OP8080(0x4D): OP8080(0x4F):
+            OP8080(0x50): OP8080(0x51): OP8080(0x52): OP8080(0x53): OP8080(0x54): OP8080(0x55): OP8080(0x57):
+            OP8080(0x58): OP8080(0x59): OP8080(0x5A): OP8080(0x5B): OP8080(0x5C): OP8080(0x5D): OP8080(0x5F):
+            OP8080(0x60): OP8080(0x61): OP8080(0x62): OP8080(0x63): OP8080(0x64): OP8080(0x65): OP8080(0x67):
+            OP8080(0x68): OP8080(0x69): OP8080(0x6A): OP8080(0x6B): OP8080(0x6C): OP8080(0x6D): OP8080(0x6F):
+            OP8080(0x78): OP8080(0x79): OP8080(0x7A): OP8080(0x7B): OP8080(0x7C): OP8080(0x7D): OP8080(0x7F):
+                *regs[opcode >> 3 & 7] = *regs[opcode & 7];
+                NEXT_8080();
+            OP8080(0x46): OP8080(0x4E): OP8080(0x56): OP8080(0x5E): // MOV r, M
+            OP8080(0x66): OP8080(0x6E): OP8080(0x7E):
+                *regs[opcode >> 3 & 7] = load(ctx.bx);
+                NEXT_8080();
+            OP8080(0x70): OP8080(0x71): OP8080(0x72): OP8080(0x73): // MOV M, r
+            OP8080(0x74): OP8080(0x75): OP8080(0x77):
+                store(ctx.bx, *regs[opcode & 7]);
+                NEXT_8080();
+            OP8080(0x76): // HLT
+                ctx.halt();
+                goto leave;
+            OP8080(0x80): OP8080(0x81): OP8080(0x82): OP8080(0x83): // ADD r
+            OP8080(0x84): OP8080(0x85): OP8080(0x86): OP8080(0x87):
+                ctx.ADD(ctx.al, src(opcode & 7));
+                NEXT_8080();
+            OP8080(0x88): OP8080(0x89): OP8080(0x8A): OP8080(0x8B): // ADC r
+            OP8080(0x8C): OP8080(0x8D): OP8080(0x8E): OP8080(0x8F):
+                ctx.ADC(ctx.al, src(opcode & 7));
+                NEXT_8080();
+            OP8080(0x90): OP8080(0x91): OP8080(0x92): OP8080(0x93): // SUB r
+            OP8080(0x94): OP8080(0x95): OP8080(0x96): OP8080(0x97):
+                ctx.SUB(ctx.al, src(opcode & 7));
+                NEXT_8080();
+            OP8080(0x98): OP8080(0x99): OP8080(0x9A): OP8080(0x9B): // SBB r
+            OP8080(0x9C): OP8080(0x9D): OP8080(0x9E): OP8080(0x9F):
+                ctx.SBB(ctx.al, src(opcode & 7));
+                NEXT_8080();
+            OP8080(0xA0): OP8080(0xA1): OP8080(0xA2): OP8080(0xA3): // ANA r
+            OP8080(0xA4): OP8080(0xA5): OP8080(0xA6): OP8080(0xA7):
+                ctx.AND(ctx.al, src(opcode & 7));
+                NEXT_8080();
+            OP8080(0xA8): OP8080(0xA9): OP8080(0xAA): OP8080(0xAB): // XRA r
+            OP8080(0xAC): OP8080(0xAD): OP8080(0xAE): OP8080(0xAF):
+                ctx.XOR(ctx.al, src(opcode & 7));
+                NEXT_8080();
+            OP8080(0xB0): OP8080(0xB1): OP8080(0xB2): OP8080(0xB3): // ORA r
+            OP8080(0xB4): OP8080(0xB5): OP8080(0xB6): OP8080(0xB7):
+                ctx.OR(ctx.al, src(opcode & 7));
+                NEXT_8080();
+            OP8080(0xB8): OP8080(0xB9): OP8080(0xBA): OP8080(0xBB): // CMP r
+            OP8080(0xBC): OP8080(0xBD): OP8080(0xBE): OP8080(0xBF):
+                ctx.CMP(ctx.al, src(opcode & 7));
+                NEXT_8080();
+            OP8080(0xC6): // ADI d8
+                ctx.ADD(ctx.al, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xCE): // ACI d8
+                ctx.ADC(ctx.al, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xD6): // SUI d8
+                ctx.SUB(ctx.al, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xDE): // SBI d8
+                ctx.SBB(ctx.al, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xE6): // ANI d8
+                ctx.AND(ctx.al, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xEE): // XRI d8
+                ctx.XOR(ctx.al, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xF6): // ORI d8
+                ctx.OR(ctx.al, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xFE): // CPI d8
+                ctx.CMP(ctx.al, pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xC0): OP8080(0xC8): OP8080(0xD0): OP8080(0xD8): // Rcc
+            OP8080(0xE0): OP8080(0xE8): OP8080(0xF0): OP8080(0xF8):
+                if (condition(opcode)) {
+                    ctx.clock += z8080_branch_taken;
+                    pc.offset = pop();
+                }
+                NEXT_8080();
+            OP8080(0xC9): OP8080(0xD9): // RET
+                pc.offset = pop();
+                NEXT_8080();
+            OP8080(0xC2): OP8080(0xCA): OP8080(0xD2): OP8080(0xDA): // Jcc a16
+            OP8080(0xE2): OP8080(0xEA): OP8080(0xF2): OP8080(0xFA): {
+                uint16_t target = pc.read_advance<uint16_t>();
+                if (condition(opcode)) {
+                    pc.offset = target;
+                }
+                NEXT_8080();
+            }
+            OP8080(0xC3): OP8080(0xCB): // JMP a16
+                pc.offset = pc.read<uint16_t>();
+                NEXT_8080();
+            OP8080(0xC4): OP8080(0xCC): OP8080(0xD4): OP8080(0xDC): // Ccc a16
+            OP8080(0xE4): OP8080(0xEC): OP8080(0xF4): OP8080(0xFC): {
+                uint16_t target = pc.read_advance<uint16_t>();
+                if (condition(opcode)) {
+                    ctx.clock += z8080_branch_taken;
+                    push(pc.offset);
+                    pc.offset = target;
+                }
+                NEXT_8080();
+            }
+            OP8080(0xCD): OP8080(0xDD): OP8080(0xFD): { // CALL a16
+                uint16_t target = pc.read_advance<uint16_t>();
+                push(pc.offset);
+                pc.offset = target;
+                NEXT_8080();
+            }
+            OP8080(0xED): // V20 escape
+                switch (pc.read_advance<uint8_t>()) {
+                    case 0xED: // CALLN Ib
+                        ctx.set_trap(pc.read_advance<uint8_t>());
+                        goto leave;
+                    case 0xFD: // RETEM
+                        ctx.RETEM();
+                        return;
+                }
+                // Other ED forms are undefined
+                NEXT_8080();
+            OP8080(0xC7): OP8080(0xCF): OP8080(0xD7): OP8080(0xDF): // RST n
+            OP8080(0xE7): OP8080(0xEF): OP8080(0xF7): OP8080(0xFF):
+                push(pc.offset);
+                pc.offset = opcode & 0x38;
+                NEXT_8080();
+            OP8080(0xC1): OP8080(0xD1): OP8080(0xE1): // POP rp
+                *pairs[opcode >> 4 & 3] = pop();
+                NEXT_8080();
+            OP8080(0xF1): { // POP PSW
+                uint16_t value = pop();
+                ctx.set_flags<uint8_t>(value);
+                ctx.al = value >> 8;
+                NEXT_8080();
+            }
+            OP8080(0xC5): OP8080(0xD5): OP8080(0xE5): // PUSH rp
+                push(*pairs[opcode >> 4 & 3]);
+                NEXT_8080();
+            OP8080(0xF5): // PUSH PSW
+                push((uint16_t)ctx.al << 8 | ctx.get_flags<uint8_t>());
+                NEXT_8080();
+            OP8080(0xD3): // OUT d8
+                ctx.port_out<true>(pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xDB): // IN d8
+                ctx.port_in<true>(pc.read_advance<uint8_t>());
+                NEXT_8080();
+            OP8080(0xE3): { // XTHL
+                z86Addr top(ctx.ds, ctx.bp);
+                uint16_t value = top.read<uint16_t>();
+                top.write<uint16_t>(ctx.bx);
+                ctx.bx = value;
+                NEXT_8080();
+            }
+            OP8080(0xE9): // PCHL
+                pc.offset = ctx.bx;
+                NEXT_8080();
+            OP8080(0xEB): // XCHG
+                std::swap(ctx.dx, ctx.bx);
+                NEXT_8080();
+            OP8080(0xF9): // SPHL
+                ctx.bp = ctx.bx;
+                NEXT_8080();
+            OP8080(0xF3): OP8080(0xFB): // DI, EI
+                ctx.set_interrupt(opcode & 8);
+                NEXT_8080();
+        }
+    } while (expect(keep_running(), true));
+leave:
+    ctx.ip = pc.offset;
+#undef NEXT_8080
+#undef OP8080
+}
+
+#endif
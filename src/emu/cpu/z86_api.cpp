@@ -0,0 +1,184 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <type_traits>
+#include <utility>
+#include <limits>
+#include <bit>
+
+#include "8086_cpu.h"
+#include "z86_machine.h"
+
+#include "../zero/util.h"
+
+// Front end of the z86_* API. Calls go to the calling
+// thread's machine, whichever model it was built for.
+
+static z86Machine* default_machine() {
+    static z86Machine* const machine = z86_new_machine_8086();
+    return machine;
+}
+
+static thread_local z86Machine* current_machine = NULL;
+
+static inline z86Machine* current() {
+    if (expect(!current_machine, false)) {
+        current_machine = default_machine();
+        current_machine->select();
+    }
+    return current_machine;
+}
+
+dllexport z86Machine* z86_create_machine(CpuModel model) {
+    switch (model) {
+        case Model8086: return z86_new_machine_8086();
+        case Model80186: return z86_new_machine_80186();
+        case ModelV30: return z86_new_machine_v30();
+        case Model80286: return z86_new_machine_80286();
+        case Model80386: return z86_new_machine_80386();
+    }
+    return NULL;
+}
+
+dllexport void z86_destroy_machine(z86Machine* target) {
+    if (target && target != default_machine()) {
+        if (current_machine == target) {
+            current_machine = NULL;
+        }
+        delete target;
+    }
+}
+
+dllexport void z86_select_machine(z86Machine* target) {
+    current_machine = target ? target : default_machine();
+    current_machine->select();
+}
+
+dllexport z86Machine* z86_current_machine() {
+    return current();
+}
+
+dllexport size_t z86_mem_write(size_t dst, const void* src, size_t size) {
+    return current()->mem_write(dst, src, size);
+}
+
+dllexport size_t z86_mem_read(void* dst, size_t src, size_t size) {
+    return current()->mem_read(dst, src, size);
+}
+
+dllexport void z86_map_memory_device(MemoryDevice* device, size_t first, size_t length) {
+    current()->map_memory_device(device, first, length);
+}
+
+dllexport void z86_map_ram(size_t first, size_t length) {
+    current()->map_ram(first, length);
+}
+
+dllexport bool z86_set_memory_size(size_t bytes) {
+    return current()->set_memory_size(bytes);
+}
+
+dllexport void z86_set_a20(bool enabled) {
+    current()->set_a20(enabled);
+}
+
+dllexport bool z86_a20() {
+    return current()->a20();
+}
+
+dllexport void z86_map_rom(size_t first, const void* data, size_t length) {
+    current()->map_rom(first, data, length);
+}
+
+dllexport void z86_load_rom(size_t first, const void* data, size_t length) {
+    current()->load_rom(first, data, length);
+}
+
+dllexport void z86_add_dword_device(PortDwordDevice* device) {
+    current()->add_dword_device(device);
+}
+
+dllexport void z86_add_word_device(PortWordDevice* device) {
+    current()->add_word_device(device);
+}
+
+dllexport void z86_add_byte_device(PortByteDevice* device) {
+    current()->add_byte_device(device);
+}
+
+dllexport bool z86_map_dword_ports(PortDwordDevice* device, uint16_t first, uint16_t last, uint16_t stride) {
+    return current()->map_dword_ports(device, first, last, stride);
+}
+
+dllexport bool z86_map_word_ports(PortWordDevice* device, uint16_t first, uint16_t last, uint16_t stride) {
+    return current()->map_word_ports(device, first, last, stride);
+}
+
+dllexport bool z86_map_byte_ports(PortByteDevice* device, uint16_t first, uint16_t last, uint16_t stride) {
+    return current()->map_byte_ports(device, first, last, stride);
+}
+
+dllexport size_t z86_unhandled_port_accesses() {
+    return current()->unhandled_port_accesses();
+}
+
+dllexport void z86_reset() {
+    current()->reset();
+}
+
+dllexport void z86_jump(uint16_t cs, uint16_t ip) {
+    current()->jump(cs, ip);
+}
+
+dllexport void z86_get_registers(z86Registers& registers) {
+    current()->get_registers(registers);
+}
+
+dllexport void z86_nmi() {
+    current()->nmi();
+}
+
+dllexport void z86_interrupt(uint8_t number) {
+    current()->interrupt(number);
+}
+
+dllexport void z86_cancel_interrupt() {
+    current()->cancel_interrupt();
+}
+
+dllexport void z86_stop() {
+    current()->stop();
+}
+
+dllexport uint32_t z86_run_events() {
+    return current()->run_events();
+}
+
+dllexport size_t z86_clock() {
+    return current()->clock();
+}
+
+dllexport uint32_t z86_schedule(size_t clock, SchedulerCallback callback, void* data) {
+    return current()->schedule(clock, callback, data);
+}
+
+dllexport bool z86_deschedule(uint32_t id) {
+    return current()->deschedule(id);
+}
+
+dllexport void z86_init() {
+    current()->init();
+}
+
+dllexport size_t z86_run_until(uint32_t events, size_t cycles) {
+    return current()->run_until(events, cycles);
+}
+
+dllexport size_t z86_run(size_t cycles) {
+    return z86_run_until(EventStop, cycles);
+}
+
+dllexport void z86_execute() {
+    z86_init();
+    z86_run_until(EventStop);
+}
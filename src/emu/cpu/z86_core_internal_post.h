@@ -35,11 +35,11 @@ struct z86AddrSSImpl<max_bits, true> {
     using type = z86AddrFixedImpl<max_bits, SS>;
 };
 
-using z86Addr = z86AddrImpl<ctx.max_bits, ctx.PROTECTED_MODE>;
+using z86Addr = z86AddrImpl<z8086Context::max_bits, z8086Context::PROTECTED_MODE>;
 
-using z86AddrES = z86AddrESImpl<ctx.max_bits, ctx.PROTECTED_MODE>::type;
-using z86AddrCS = z86AddrCSImpl<ctx.max_bits, ctx.PROTECTED_MODE>::type;
-using z86AddrSS = z86AddrSSImpl<ctx.max_bits, ctx.PROTECTED_MODE>::type;
+using z86AddrES = z86AddrESImpl<z8086Context::max_bits, z8086Context::PROTECTED_MODE>::type;
+using z86AddrCS = z86AddrCSImpl<z8086Context::max_bits, z8086Context::PROTECTED_MODE>::type;
+using z86AddrSS = z86AddrSSImpl<z8086Context::max_bits, z8086Context::PROTECTED_MODE>::type;
 
 template <typename P>
 uint32_t ModRM::extra_length(const P& pc) const {
@@ -47,7 +47,7 @@ uint32_t ModRM::extra_length(const P& pc) const {
     if (mod == 3) {
         return 0;
     }
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.addr_size_16()) {
             uint32_t length = 0;
             switch (this->M()) {
@@ -93,9 +93,9 @@ auto ModRM::parse_memM(P& pc) const {
     uint8_t m = this->M();
     assume(m < 8);
     uint8_t mod = this->Mod();
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.addr_size_16()) {
-            if constexpr (ctx.max_bits == 64) {
+            if constexpr (z8086Context::max_bits == 64) {
                 if (ctx.addr_size_64()) {
                     switch (m) {
                         default: unreachable;
@@ -149,7 +149,7 @@ auto ModRM::parse_memM(P& pc) const {
                 }
                 case EBP:
                     if (mod == 0) {
-                        if constexpr (ctx.max_bits == 64) {
+                        if constexpr (z8086Context::max_bits == 64) {
                             if (expect(ctx.is_long_mode(), false)) {
                                 // TODO: Properly offset for
                                 // the end of the instruction
@@ -180,51 +180,89 @@ auto ModRM::parse_memM(P& pc) const {
                 case 0:;
             }
             // Set bits are for DS
-            if constexpr (ctx.max_bits == 64) {
+            if constexpr (z8086Context::max_bits == 64) {
                 segment_mask = 0b11111111111111111111111111001111;
             }
             else {
                 segment_mask = 0b11001111;
             }
+            ctx.memory_operand_cycles(0);
             goto ret;
         }
     }
     
+    ctx.memory_operand_cycles(ctx.cycles.ea[mod][m]);
     static constexpr uint32_t first_reg16[] = { BX, BX, BP, BP, SI, DI, BP, BX };
+#if USE_DECODE_CACHE
+    if constexpr (decode_cache_enabled) {
+        // Replay the form recorded the first time around
+        const z86DecodeEntry* decode = ctx.decode_entry;
+        if (decode && decode->has_ea) {
+            pc += decode->ea_length;
+            offset = decode->ea_disp;
+            offset += ctx.index_word_reg_raw(decode->ea_base) & decode->ea_base_mask;
+            offset += ctx.index_word_reg_raw(decode->ea_index) & decode->ea_index_mask;
+            return ctx.addr(decode->ea_segment, offset);
+        }
+    }
+#endif
     offset = ctx.index_word_regMB<true>(first_reg16[m]);
     if (m < 4) {
         offset += ctx.index_word_regI<true>(SI | m);
     }
+    uint16_t disp;
     switch (mod) {
         default: unreachable;
         case 1:
             // TODO:
             // Merge this with 32 bit byte offset somehow?
-            offset += pc.read_advance<int8_t>();
+            disp = pc.read_advance<int8_t>();
             break;
         case 0:
+            disp = 0;
             if (m != 6) {
                 break;
             }
             m = 0;
             offset = 0;
         case 2:
-            offset += pc.read_advance<int16_t>();
+            disp = pc.read_advance<int16_t>();
     }
+    offset += disp;
     // Set bits are for DS
     segment_mask = 0b10110011;
+#if USE_DECODE_CACHE
+    if constexpr (decode_cache_enabled) {
+        if (z86DecodeEntry* decode = ctx.decode_entry) {
+            uint8_t rm = this->M();
+            bool direct = mod == 0 && rm == 6;
+            decode->set_ea(pc.addr(), direct ? 2 : mod, SS + (bool)(segment_mask & 1 << m),
+                first_reg16[rm], direct ? 0 : UINT16_MAX, SI | (rm & 1), rm < 4 ? UINT16_MAX : 0, disp, mem);
+        }
+    }
+#endif
 ret:
     return ctx.addr(SS + (bool)(segment_mask & 1 << m), offset);
 }
 
 template <size_t max_bits>
-inline constexpr SEG_DESCRIPTOR<max_bits>* z86DescriptorCache<max_bits>::load_selector(uint16_t selector) const {
+inline bool z86DescriptorCache<max_bits>::load_selector(uint16_t selector, SEG_DESCRIPTOR<max_bits>& descriptor) const {
     //uint8_t rpl = selector & 3;
     BT offset = selector & 0xFFF8;
-    if (offset <= this->limit) {
-        return mem.ptr<SEG_DESCRIPTOR<max_bits>>(offset + this->base);
+    // The whole descriptor has to be inside the table
+    if (offset + (sizeof(SEG_DESCRIPTOR<max_bits>) - 1) > this->limit) {
+        return false;
+    }
+    size_t addr = offset + this->base;
+    if constexpr (z8086Context::PAGING) {
+        // Table bases are linear, a missing page raises #PF
+        if (ctx.paging_enabled()) {
+            descriptor = ctx.paged_read<SEG_DESCRIPTOR<max_bits>>(addr);
+            return !ctx.access_faulted();
+        }
     }
-    return NULL;
+    descriptor = mem.read<SEG_DESCRIPTOR<max_bits>>(addr);
+    return true;
 }
 
 template <size_t bits, bool protected_mode>
@@ -244,27 +282,164 @@ inline constexpr size_t z86AddrFixedImpl<max_bits, descriptor_index>::seg() cons
 
 template <typename T>
 inline constexpr bool z86AddrSharedFuncs::addr_fits_on_bus(size_t addr) {
-    return (addr & align_mask<ctx.bus_bytes>) <= ctx.bus_bytes - z86DataProperites<T>::size;
+    return (addr & align_mask<z8086Context::bus_bytes>) <= z8086Context::bus_bytes - z86DataProperites<T>::size;
 }
 
 template <typename T>
 inline constexpr bool z86AddrSharedFuncs::addr_crosses_page(size_t addr) {
-    if constexpr (ctx.PAGING) {
-        // No paging simulated yet
+    if constexpr (z8086Context::PAGING) {
+        return ((addr ^ (addr + z86DataProperites<T>::size - 1)) >> z86PageTlb::page_bits) != 0;
     }
     return false;
 }
 
-inline constexpr size_t regcall z86AddrSharedFuncs::virt_to_phys(size_t addr) {
-    // No paging yet
+// SIZE_MAX when the page isn't mapped
+template <bool is_write>
+inline size_t regcall z86AddrSharedFuncs::virt_to_phys(size_t addr) {
+    if constexpr (z8086Context::PAGING) {
+        if (ctx.paging_enabled()) {
+            if (auto* entry = ctx.page_entry<is_write>(addr)) {
+                return entry->phys | (addr & z86PageTlb::page_mask);
+            }
+            return SIZE_MAX;
+        }
+    }
     return addr;
 }
 
+// Two level 386 page tables, 4KB pages only
+template <z86BaseTemplate>
+template <bool is_write>
+inline bool regcall z86BaseDefault::page_walk(size_t addr, z86PageTlb::Entry& entry) {
+    constexpr size_t page_mask = z86PageTlb::page_mask;
+    bool user = this->current_privilege_level() == 3;
+
+    size_t dir_addr = (this->cr3 & ~page_mask) | (addr >> 20 & 0xFFC);
+    uint32_t pde = mem.read<uint32_t>(dir_addr);
+    if (!(pde & 1)) {
+        this->set_page_fault(addr);
+        return false;
+    }
+    size_t table_addr = (pde & ~page_mask) | (addr >> 10 & 0xFFC);
+    uint32_t pte = mem.read<uint32_t>(table_addr);
+    if (!(pte & 1)) {
+        this->set_page_fault(addr);
+        return false;
+    }
+
+    uint32_t rights = pde & pte;
+    bool user_ok = rights & 4;
+    if constexpr (is_write) {
+        bool write_ok = rights & 2;
+        user_ok &= write_ok;
+        if constexpr (OPCODES_80486) {
+            // Supervisor writes ignore R/W unless WP is set
+            if (!user && !write_ok && this->cr0 & 0x10000) {
+                this->set_page_fault(addr);
+                return false;
+            }
+        }
+    }
+    if (user && !user_ok) {
+        this->set_page_fault(addr);
+        return false;
+    }
+
+    // Accessed, and dirty for writes
+    if (!(pde & 0x20)) {
+        mem.write<uint32_t>(dir_addr, pde | 0x20);
+    }
+    constexpr uint32_t used = is_write ? 0x60 : 0x20;
+    if ((pte & used) != used) {
+        mem.write<uint32_t>(table_addr, pte | used);
+    }
+
+    size_t phys = mem.wrap(pte & ~page_mask);
+    entry.tag = z86PageTlb::tag(addr);
+    entry.phys = phys;
+    entry.host = is_write ? mem.write_page[phys >> mem.page_bits] : mem.read_page[phys >> mem.page_bits];
+    entry.user = user_ok;
+    return true;
+}
+
+template <z86BaseTemplate>
+template <bool is_write>
+inline z86PageTlb::Entry* regcall z86BaseDefault::page_entry(size_t addr) {
+    z86PageTlb::Entry& entry = is_write ? this->tlb.write_entry(addr) : this->tlb.read_entry(addr);
+    if (expect(!z86PageTlb::hit(entry, addr, this->current_privilege_level() == 3), false)) {
+        if (!this->template page_walk<is_write>(addr, entry)) {
+            return NULL;
+        }
+    }
+    return &entry;
+}
+
+template <z86BaseTemplate>
+template <typename T>
+inline T regcall z86BaseDefault::paged_read(size_t addr) {
+    addr = (uint32_t)addr;
+    if (expect(mem.fits_in_page<T>(addr), true)) {
+        z86PageTlb::Entry* entry = this->template page_entry<false>(addr);
+        if (expect(!entry, false)) {
+            return {};
+        }
+        if (expect(entry->host != NULL, true)) {
+            return *(const T*)&entry->host[addr & z86PageTlb::page_mask];
+        }
+        return mem.read_slow<T>(entry->phys | (addr & z86PageTlb::page_mask));
+    }
+    // Each page of a split access is translated on its own
+    unsigned char value[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value[i] = this->template paged_read<uint8_t>(addr + i);
+    }
+    return *(T*)value;
+}
+
+template <z86BaseTemplate>
+template <typename T>
+inline void regcall z86BaseDefault::paged_write(size_t addr, const T& value) {
+    addr = (uint32_t)addr;
+    if (expect(mem.fits_in_page<T>(addr), true)) {
+        z86PageTlb::Entry* entry = this->template page_entry<true>(addr);
+        if (expect(!entry, false)) {
+            return;
+        }
+        size_t phys = entry->phys | (addr & z86PageTlb::page_mask);
+        if (expect(entry->host != NULL, true)) {
+            mem.invalidate_code(phys, sizeof(T));
+            memcpy(&entry->host[addr & z86PageTlb::page_mask], &value, sizeof(T));
+            return;
+        }
+        return mem.write_slow<T>(phys, value);
+    }
+    // Both pages have to be writable before either is touched
+    if (!this->template page_entry<true>((uint32_t)(addr + sizeof(T) - 1))) {
+        return;
+    }
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        this->template paged_write<uint8_t>(addr + i, ((const uint8_t*)&value)[i]);
+    }
+}
+
 template <typename T, typename P>
 inline void regcall z86AddrSharedFuncs::write(P* self, const T& value, ssize_t offset) {
 
-    if constexpr (!ctx.SINGLE_MEM_WRAPS) {
-        // TODO: Check segment limits
+    if constexpr (!z8086Context::SINGLE_MEM_WRAPS) {
+        if constexpr (z8086Context::PROTECTED_MODE && P::has_descriptor) {
+            // Nothing more lands once the instruction has faulted
+            if (expect(ctx.access_fault, false)) {
+                return;
+            }
+            if (expect(!ctx.descriptors[self->seg_index()].template can_write<z86DataProperites<T>::size>(self->ptr(offset)), false)) {
+                return ctx.set_access_fault(self->seg_index());
+            }
+        }
+        if constexpr (z8086Context::PAGING) {
+            if (ctx.paging_enabled()) {
+                return ctx.paged_write<T>(self->addr(offset), value);
+            }
+        }
         return mem.write<T>(self->addr(offset), value);
     }
     else {
@@ -302,7 +477,7 @@ inline void regcall z86AddrSharedFuncs::write(P* self, const T& value, ssize_t o
         size_t virt_seg_base = this->seg();
         size_t virt_addr_base = virt_seg_base + self->ptr(offset);
         uint16_t raw = std::bit_cast<uint16_t>(value);
-        if constexpr (ctx.bus_width >= 16) {
+        if constexpr (z8086Context::bus_width >= 16) {
             if (is_aligned<uint16_t>(virt_addr_base)) {
                 return mem.write<uint16_t>(virt_addr_base, raw);
             }
@@ -315,8 +490,8 @@ inline void regcall z86AddrSharedFuncs::write(P* self, const T& value, ssize_t o
         size_t virt_seg_base = this->seg();
         size_t virt_addr_base = virt_seg_base + self->ptr(offset);
         uint32_t raw = std::bit_cast<uint32_t>(value);
-        if constexpr (ctx.bus_width >= 16) {
-            if constexpr (ctx.bus_width >= 32) {
+        if constexpr (z8086Context::bus_width >= 16) {
+            if constexpr (z8086Context::bus_width >= 32) {
                 if (is_aligned<uint32_t>(virt_addr_base)) {
                     return mem.write<uint32_t>(virt_addr_base, raw);
                 }
@@ -338,9 +513,9 @@ inline void regcall z86AddrSharedFuncs::write(P* self, const T& value, ssize_t o
         size_t virt_seg_base = this->seg();
         size_t virt_addr_base = virt_seg_base + self->ptr(offset);
         uint64_t raw = std::bit_cast<uint64_t>(value);
-        if constexpr (ctx.bus_width >= 16) {
-            if constexpr (ctx.bus_width >= 32) {
-                if constexpr (ctx.bus_width >= 64) {
+        if constexpr (z8086Context::bus_width >= 16) {
+            if constexpr (z8086Context::bus_width >= 32) {
+                if constexpr (z8086Context::bus_width >= 64) {
                     if (is_aligned<uint64_t>(self->offset + offset)) {
                         return mem.write<T>(self->addr(offset), value);
                     }
@@ -382,8 +557,18 @@ inline void regcall z86AddrSharedFuncs::write(P* self, const T& value, ssize_t o
 
 template <typename T, typename V, typename P>
 inline V z86AddrSharedFuncs::read(const P* self, ssize_t offset) {
-    if constexpr (!ctx.SINGLE_MEM_WRAPS) {
-        // TODO: Check segment limits
+    if constexpr (!z8086Context::SINGLE_MEM_WRAPS) {
+        if constexpr (z8086Context::PROTECTED_MODE && P::has_descriptor) {
+            if (expect(!ctx.descriptors[self->seg_index()].template can_read<z86DataProperites<V>::size>(self->ptr(offset)), false)) {
+                ctx.set_access_fault(self->seg_index());
+                return {};
+            }
+        }
+        if constexpr (z8086Context::PAGING) {
+            if (ctx.paging_enabled()) {
+                return ctx.paged_read<V>(self->addr(offset));
+            }
+        }
         return mem.read<V>(self->addr(offset));
     }
     else {
@@ -445,9 +630,29 @@ inline V z86AddrSharedFuncs::read(const P* self, ssize_t offset) {
     */
 }
 
+template <typename T, typename P>
+inline void regcall z86AddrSharedFuncs::write_nowrap(P* self, const T& value, ssize_t offset) {
+    if constexpr (z8086Context::SINGLE_MEM_WRAPS) {
+        return mem.write<T>(self->addr(offset), value);
+    }
+    else {
+        return write<T>(self, value, offset);
+    }
+}
+
+template <typename T, typename V, typename P>
+inline V z86AddrSharedFuncs::read_nowrap(const P* self, ssize_t offset) {
+    if constexpr (z8086Context::SINGLE_MEM_WRAPS) {
+        return mem.read<V>(self->addr(offset));
+    }
+    else {
+        return read<T>(self, offset);
+    }
+}
+
 template <typename P>
 inline uint32_t z86AddrSharedFuncs::read_Iz(const P* self, ssize_t index) {
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.data_size_16()) {
             return self->read<uint32_t>(index);
         }
@@ -457,7 +662,7 @@ inline uint32_t z86AddrSharedFuncs::read_Iz(const P* self, ssize_t index) {
 
 template <typename P>
 inline uint32_t z86AddrSharedFuncs::read_advance_Iz(P* self) {
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.data_size_16()) {
             return self->read_advance<uint32_t>();
         }
@@ -467,7 +672,7 @@ inline uint32_t z86AddrSharedFuncs::read_advance_Iz(P* self) {
 
 template <typename P>
 inline int32_t z86AddrSharedFuncs::read_Is(const P* self, ssize_t index) {
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.data_size_16()) {
             return self->read<int32_t>(index);
         }
@@ -477,7 +682,7 @@ inline int32_t z86AddrSharedFuncs::read_Is(const P* self, ssize_t index) {
 
 template <typename P>
 inline int32_t z86AddrSharedFuncs::read_advance_Is(P* self) {
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.data_size_16()) {
             return self->read_advance<int32_t>();
         }
@@ -487,9 +692,9 @@ inline int32_t z86AddrSharedFuncs::read_advance_Is(P* self) {
 
 template <typename P>
 inline uint64_t z86AddrSharedFuncs::read_Iv(const P* self, ssize_t index) {
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.data_size_16()) {
-            if constexpr (ctx.max_bits > 32) {
+            if constexpr (z8086Context::max_bits > 32) {
                 if (ctx.data_size_64()) {
                     return self->read<uint64_t>(index);
                 }
@@ -502,9 +707,9 @@ inline uint64_t z86AddrSharedFuncs::read_Iv(const P* self, ssize_t index) {
 
 template <typename P>
 inline uint64_t z86AddrSharedFuncs::read_advance_Iv(P* self) {
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.data_size_16()) {
-            if constexpr (ctx.max_bits > 32) {
+            if constexpr (z8086Context::max_bits > 32) {
                 if (ctx.data_size_64()) {
                     return self->read_advance<uint64_t>();
                 }
@@ -518,9 +723,9 @@ inline uint64_t z86AddrSharedFuncs::read_advance_Iv(P* self) {
 
 template <typename P>
 inline uint64_t z86AddrSharedFuncs::read_O(const P* self, ssize_t index) {
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.addr_size_16()) {
-            if constexpr (ctx.max_bits > 32) {
+            if constexpr (z8086Context::max_bits > 32) {
                 if (ctx.addr_size_64()) {
                     return self->read<uint64_t>(index);
                 }
@@ -533,9 +738,9 @@ inline uint64_t z86AddrSharedFuncs::read_O(const P* self, ssize_t index) {
 
 template <typename P>
 inline uint64_t z86AddrSharedFuncs::read_advance_O(P* self) {
-    if constexpr (ctx.max_bits > 16) {
+    if constexpr (z8086Context::max_bits > 16) {
         if (!ctx.addr_size_16()) {
-            if constexpr (ctx.max_bits > 32) {
+            if constexpr (z8086Context::max_bits > 32) {
                 if (ctx.addr_size_64()) {
                     return self->read_advance<uint64_t>();
                 }
@@ -798,6 +1003,9 @@ inline void regcall z86BaseDefault::PUSH_impl(const T& src) {
     this->SP<P>() -= (std::max)(sizeof(T), (size_t)2);
     z86AddrSS stack = this->stack<P>();
     stack.write(src);
+    if (this->access_faulted()) {
+        this->SP<P>() += (std::max)(sizeof(T), (size_t)2);
+    }
 }
 
 template <z86BaseTemplate>
@@ -805,7 +1013,9 @@ template <typename P, typename T>
 inline T z86BaseDefault::POP_impl() {
     z86AddrSS stack = this->stack<P>();
     T ret = stack.read<T>();
-    this->SP<P>() += (std::max)(sizeof(T), (size_t)2);
+    if (!this->access_faulted()) {
+        this->SP<P>() += (std::max)(sizeof(T), (size_t)2);
+    }
     return ret;
 }
 
@@ -928,24 +1138,68 @@ gnu_attr(minsize) inline void regcall z86BaseDefault::ENTER_impl(uint16_t alloc,
     }
 }
 
+template <z86BaseTemplate>
+template <typename T, bool is_write, typename P, typename AT>
+inline auto regcall z86BaseDefault::string_span(const AT& addr, P count, intptr_t step) {
+    using H = std::conditional_t<is_write, uint8_t*, const uint8_t*>;
+    // Protected mode would need the limit and paging checks per span
+    if constexpr (!PROTECTED_MODE) {
+        if (run_fits<T, P>(addr.offset, count, step)) {
+            size_t length = (size_t)count * sizeof(T);
+            size_t lowest = addr.addr(step > 0 ? 0 : -(ssize_t)(length - sizeof(T)));
+            if constexpr (is_write) {
+                return (H)mem.write_span(lowest, length);
+            }
+            else {
+                return (H)mem.read_span(lowest, length);
+            }
+        }
+    }
+    return (H)NULL;
+}
+
 // TODO: Check what happens if an interrupt toggles 
 // the direction flag during a repeating string instruction
+//
+// REP runs take at most rep_limit iterations at a time and set
+// rep_yield when iterations are left so the instruction restarts
 template <z86BaseTemplate>
 template <typename T, typename P>
 inline bool regcall z86BaseDefault::LODS_impl() {
-    intptr_t offset = this->direction ? sizeof(T) : -sizeof(T);
+    intptr_t offset = this->direction ? -(intptr_t)sizeof(T) : sizeof(T);
     z86Addr src_addr = this->str_src<P>();
     if (this->has_rep()) {
-        if (this->C<P>()) {
-            do {
-                // TODO: Interrupt check here
-                this->A<T>() = src_addr.read_advance<T>(offset);
-            } while (--this->C<P>());
+        if (P count = this->rep_chunk(this->C<P>())) {
+            P stop = this->C<P>() - count;
+            // Only the last element survives
+            if (const uint8_t* src = this->string_span<T, false>(src_addr, count, offset)) {
+                this->A<T>() = string_element<T>(src, count - 1, count, offset);
+                src_addr += (ssize_t)count * offset;
+                this->C<P>() = stop;
+            }
+            else if (this->run_no_wrap<T, P>(src_addr.offset, count, offset)) {
+                do {
+                    this->A<T>() = src_addr.read_advance_nowrap<T>(offset);
+                } while (--this->C<P>() != stop);
+            }
+            else {
+                do {
+                    this->A<T>() = src_addr.read_advance<T>(offset);
+                } while (--this->C<P>() != stop && !this->access_faulted());
+            }
+            this->rep_yield = stop;
         }
     }
     else {
         this->A<T>() = src_addr.read_advance<T>(offset);
     }
+    if (this->access_faulted()) {
+        // Registers stay on the faulting element
+        src_addr += -offset;
+        if (this->has_rep()) {
+            ++this->C<P>();
+        }
+    }
     this->SI<P>() = src_addr.offset;
     return false;
 }
@@ -953,20 +1207,52 @@ inline bool regcall z86BaseDefault::LODS_impl() {
 template <z86BaseTemplate>
 template <typename T, typename P>
 inline bool regcall z86BaseDefault::MOVS_impl() {
-    intptr_t offset = this->direction ? sizeof(T) : -sizeof(T);
+    intptr_t offset = this->direction ? -(intptr_t)sizeof(T) : sizeof(T);
     z86Addr src_addr = this->str_src<P>();
     z86AddrES dst_addr = this->str_dst<P>();
     if (this->has_rep()) {
-        if (this->C<P>()) {
-            do {
-                // TODO: Interrupt check here
-                dst_addr.write_advance<T>(src_addr.read_advance<T>(offset), offset);
-            } while (--this->C<P>());
+        if (P count = this->rep_chunk(this->C<P>())) {
+            P stop = this->C<P>() - count;
+            this->rep_yield = stop;
+            if (uint8_t* dst = this->string_span<T, true>(dst_addr, count, offset)) {
+                if (const uint8_t* src = this->string_span<T, false>(src_addr, count, offset)) {
+                    size_t length = (size_t)count * sizeof(T);
+                    // Copying toward data that hasn't been read yet
+                    // repeats a pattern, which memmove wouldn't do
+                    uintptr_t d = (uintptr_t)dst;
+                    uintptr_t s = (uintptr_t)src;
+                    if (offset > 0 ? d <= s || d >= s + length : d >= s || d + length <= s) {
+                        memmove(dst, src, length);
+                        src_addr += (ssize_t)count * offset;
+                        dst_addr += (ssize_t)count * offset;
+                        this->C<P>() = stop;
+                        goto finish;
+                    }
+                }
+            }
+            if (this->run_no_wrap<T, P>(src_addr.offset, count, offset) && this->run_no_wrap<T, P>(dst_addr.offset, count, offset)) {
+                do {
+                    dst_addr.write_advance_nowrap<T>(src_addr.read_advance_nowrap<T>(offset), offset);
+                } while (--this->C<P>() != stop);
+            }
+            else {
+                do {
+                    dst_addr.write_advance<T>(src_addr.read_advance<T>(offset), offset);
+                } while (--this->C<P>() != stop && !this->access_faulted());
+            }
         }
     }
     else {
         dst_addr.write_advance<T>(src_addr.read_advance<T>(offset), offset);
     }
+finish:
+    if (this->access_faulted()) {
+        src_addr += -offset;
+        dst_addr += -offset;
+        if (this->has_rep()) {
+            ++this->C<P>();
+        }
+    }
     this->SI<P>() = src_addr.offset;
     this->DI<P>() = dst_addr.offset;
     return false;
@@ -975,19 +1261,46 @@ inline bool regcall z86BaseDefault::MOVS_impl() {
 template <z86BaseTemplate>
 template <typename T, typename P>
 inline bool regcall z86BaseDefault::STOS_impl() {
-    intptr_t offset = this->direction ? sizeof(T) : -sizeof(T);
+    intptr_t offset = this->direction ? -(intptr_t)sizeof(T) : sizeof(T);
     z86AddrES dst_addr = this->str_dst<P>();
     if (this->has_rep()) {
-        if (this->C<P>()) {
-            do {
-                // TODO: Interrupt check here
-                dst_addr.write_advance<T>(this->A<T>(), offset);
-            } while (--this->C<P>());
+        if (P count = this->rep_chunk(this->C<P>())) {
+            P stop = this->C<P>() - count;
+            if (uint8_t* dst = this->string_span<T, true>(dst_addr, count, offset)) {
+                T value = this->A<T>();
+                if constexpr (sizeof(T) == sizeof(uint8_t)) {
+                    memset(dst, value, count);
+                }
+                else {
+                    for (size_t i = 0; i < count; ++i) {
+                        memcpy(&dst[i * sizeof(T)], &value, sizeof(T));
+                    }
+                }
+                dst_addr += (ssize_t)count * offset;
+                this->C<P>() = stop;
+            }
+            else if (this->run_no_wrap<T, P>(dst_addr.offset, count, offset)) {
+                do {
+                    dst_addr.write_advance_nowrap<T>(this->A<T>(), offset);
+                } while (--this->C<P>() != stop);
+            }
+            else {
+                do {
+                    dst_addr.write_advance<T>(this->A<T>(), offset);
+                } while (--this->C<P>() != stop && !this->access_faulted());
+            }
+            this->rep_yield = stop;
         }
     }
     else {
         dst_addr.write_advance<T>(this->A<T>(), offset);
     }
+    if (this->access_faulted()) {
+        dst_addr += -offset;
+        if (this->has_rep()) {
+            ++this->C<P>();
+        }
+    }
     this->DI<P>() = dst_addr.offset;
     return false;
 }
@@ -995,29 +1308,62 @@ inline bool regcall z86BaseDefault::STOS_impl() {
 template <z86BaseTemplate>
 template <typename T, typename P>
 inline bool regcall z86BaseDefault::SCAS_impl() {
-    intptr_t offset = this->direction ? sizeof(T) : -sizeof(T);
+    intptr_t offset = this->direction ? -(intptr_t)sizeof(T) : sizeof(T);
     z86AddrES dst_addr = this->str_dst<P>();
     if (this->has_rep()) {
-        if (this->C<P>()) {
+        if (P count = this->rep_chunk(this->C<P>())) {
+            P stop = this->C<P>() - count;
             if constexpr (OPCODES_V20 && !OPCODES_80386) {
                 if (this->is_repc()) {
                     do {
-                        // TODO: Interrupt check here
                         this->CMP<T>(this->A<T>(), dst_addr.read_advance<T>(offset));
-                    } while (--this->C<P>() && this->rep_type == this->carry + 2);
+                    } while (--this->C<P>() != stop && !this->access_faulted() && this->rep_condition());
                     goto finish;
                 }
             }
+            if (const uint8_t* dst = this->string_span<T, false>(dst_addr, count, offset)) {
+                T value = this->A<T>();
+                // REPNZ stops on the first match, REPZ on the first mismatch
+                bool stop_on_equal = this->rep_type == REP_NZ;
+                size_t i = 0;
+                if constexpr (sizeof(T) == sizeof(uint8_t)) {
+                    if (stop_on_equal && offset > 0) {
+                        const void* found = memchr(dst, value, count);
+                        i = found ? (const uint8_t*)found - dst : count - 1;
+                        goto scan_done;
+                    }
+                }
+                while (i < count - 1 && (string_element<T>(dst, i, count, offset) == value) != stop_on_equal) {
+                    ++i;
+                }
+            scan_done:
+                this->CMP<T>(value, string_element<T>(dst, i, count, offset));
+                dst_addr += (ssize_t)(i + 1) * offset;
+                this->C<P>() -= i + 1;
+                goto finish;
+            }
+            if (this->run_no_wrap<T, P>(dst_addr.offset, count, offset)) {
+                do {
+                    this->CMP<T>(this->A<T>(), dst_addr.read_advance_nowrap<T>(offset));
+                } while (--this->C<P>() != stop && this->rep_type == this->get_zero());
+                goto finish;
+            }
             do {
-                // TODO: Interrupt check here
                 this->CMP<T>(this->A<T>(), dst_addr.read_advance<T>(offset));
-            } while (--this->C<P>() && this->rep_type == this->zero);
+            } while (--this->C<P>() != stop && !this->access_faulted() && this->rep_type == this->get_zero());
+        finish:
+            this->rep_yield = this->C<P>() && this->rep_condition();
         }
     }
     else {
         this->CMP<T>(this->A<T>(), dst_addr.read_advance<T>(offset));
     }
-finish:
+    if (this->access_faulted()) {
+        dst_addr += -offset;
+        if (this->has_rep()) {
+            ++this->C<P>();
+        }
+    }
     this->DI<P>() = dst_addr.offset;
     return false;
 }
@@ -1025,65 +1371,183 @@ finish:
 template <z86BaseTemplate>
 template <typename T, typename P>
 inline bool regcall z86BaseDefault::CMPS_impl() {
-    intptr_t offset = this->direction ? sizeof(T) : -sizeof(T);
+    intptr_t offset = this->direction ? -(intptr_t)sizeof(T) : sizeof(T);
     z86Addr src_addr = this->str_src<P>();
     z86AddrES dst_addr = this->str_dst<P>();
     if (this->has_rep()) {
-        if (this->C<P>()) {
+        if (P count = this->rep_chunk(this->C<P>())) {
+            P stop = this->C<P>() - count;
             if constexpr (OPCODES_V20 && !OPCODES_80386) {
                 if (this->is_repc()) {
                     do {
-                        // TODO: Interrupt check here
                         this->CMP<T>(src_addr.read_advance<T>(offset), dst_addr.read_advance<T>(offset));
-                    } while (--this->C<P>() && this->rep_type == this->carry + 2);
+                    } while (--this->C<P>() != stop && !this->access_faulted() && this->rep_condition());
                     goto finish;
                 }
             }
+            if (const uint8_t* src = this->string_span<T, false>(src_addr, count, offset)) {
+                if (const uint8_t* dst = this->string_span<T, false>(dst_addr, count, offset)) {
+                    bool stop_on_equal = this->rep_type == REP_NZ;
+                    size_t i = 0;
+                    while (i < count - 1 && (string_element<T>(src, i, count, offset) == string_element<T>(dst, i, count, offset)) != stop_on_equal) {
+                        ++i;
+                    }
+                    this->CMP<T>(string_element<T>(src, i, count, offset), string_element<T>(dst, i, count, offset));
+                    src_addr += (ssize_t)(i + 1) * offset;
+                    dst_addr += (ssize_t)(i + 1) * offset;
+                    this->C<P>() -= i + 1;
+                    goto finish;
+                }
+            }
+            if (this->run_no_wrap<T, P>(src_addr.offset, count, offset) && this->run_no_wrap<T, P>(dst_addr.offset, count, offset)) {
+                do {
+                    this->CMP<T>(src_addr.read_advance_nowrap<T>(offset), dst_addr.read_advance_nowrap<T>(offset));
+                } while (--this->C<P>() != stop && this->rep_type == this->get_zero());
+                goto finish;
+            }
             do {
-                // TODO: Interrupt check here
                 this->CMP<T>(src_addr.read_advance<T>(offset), dst_addr.read_advance<T>(offset));
-            } while (--this->C<P>() && this->rep_type == this->zero);
+            } while (--this->C<P>() != stop && !this->access_faulted() && this->rep_type == this->get_zero());
+        finish:
+            this->rep_yield = this->C<P>() && this->rep_condition();
         }
     }
     else {
         this->CMP<T>(src_addr.read_advance<T>(offset), dst_addr.read_advance<T>(offset));
     }
-finish:
+    if (this->access_faulted()) {
+        src_addr += -offset;
+        dst_addr += -offset;
+        if (this->has_rep()) {
+            ++this->C<P>();
+        }
+    }
     this->SI<P>() = src_addr.offset;
-    this->DI<P>() = src_addr.offset;
+    this->DI<P>() = dst_addr.offset;
     return false;
 }
 
 template <z86BaseTemplate>
-template <typename P>
-inline bool regcall z86BaseDefault::ADD4S_impl() {
+template <bool is_sub, bool is_cmp, typename P>
+inline bool regcall z86BaseDefault::BCD4S_impl() {
     // How does this actually behave on real hardware?
     z86Addr src_addr = this->str_src<P>();
     z86AddrES dst_addr = this->str_dst<P>();
-    // Yes, this overflows ridiculously for 0 and 255
-    uint16_t count = (uint8_t)(this->cl + 1) >> 1;
-    while (--count) {
+    // CL counts digits, an odd last digit still takes a whole byte
+    size_t count = (this->cl + 1) >> 1;
+    bool carry = false;
+    bool nonzero = false;
+    size_t i = 0;
+    if (count) {
+        const uint8_t* src = this->string_span<uint8_t, false>(src_addr, (P)count, 1);
+        auto dst = this->string_span<uint8_t, !is_cmp>(dst_addr, (P)count, 1);
+        if (src && dst) {
+            // Bytes are done in order, so a destination just above
+            // the source has to see its own results
+            size_t gap = (uintptr_t)dst - (uintptr_t)src;
+            if (!gap || gap >= sizeof(uint64_t)) {
+                for (; i + sizeof(uint64_t) <= count; i += sizeof(uint64_t)) {
+                    uint64_t a, b;
+                    memcpy(&a, &dst[i], sizeof(uint64_t));
+                    memcpy(&b, &src[i], sizeof(uint64_t));
+                    if (bcd_invalid(a) | bcd_invalid(b)) {
+                        break;
+                    }
+                    uint64_t result = is_sub ? bcd_sub(a, b, carry) : bcd_add(a, b, carry);
+                    nonzero |= result != 0;
+                    if constexpr (!is_cmp) {
+                        memcpy(&dst[i], &result, sizeof(uint64_t));
+                    }
+                }
+            }
+            for (; i < count; ++i) {
+                uint8_t result = bcd_byte<is_sub>(dst[i], src[i], carry);
+                nonzero |= result != 0;
+                if constexpr (!is_cmp) {
+                    dst[i] = result;
+                }
+            }
+        }
+        else {
+            // SI/DI are left alone, only the offsets used wrap
+            for (; i < count; ++i) {
+                uint8_t result = bcd_byte<is_sub>(dst_addr.read<uint8_t>(i), src_addr.read<uint8_t>(i), carry);
+                nonzero |= result != 0;
+                if constexpr (!is_cmp) {
+                    dst_addr.write<uint8_t>(result, i);
+                }
+            }
+        }
+    }
+    this->resolve_flags();
+    this->carry = carry;
+    this->zero = !nonzero;
+    return false;
+}
 
+template <z86BaseTemplate>
+inline bool regcall z86BaseDefault::EXT_BITS(uint8_t& offset, uint8_t length) {
+    z86Addr src_addr = this->str_src();
+    uint32_t bit = offset & 0xF;
+    uint32_t end = bit + (length & 0xF) + 1;
+    uint32_t data = src_addr.read<uint16_t>();
+    if (end > 16) {
+        data |= (uint32_t)src_addr.read<uint16_t>(2) << 16;
+    }
+    this->ax = (data & (uint32_t)-1 >> (32 - end)) >> bit;
+    offset = end & 0xF;
+    if (end >= 16) {
+        this->si += 2;
     }
+    return false;
+}
+
+template <z86BaseTemplate>
+inline bool regcall z86BaseDefault::INS_BITS(uint8_t& offset, uint8_t length) {
+    z86AddrES dst_addr = this->str_dst();
+    uint32_t bit = offset & 0xF;
+    uint32_t end = bit + (length & 0xF) + 1;
+    uint32_t mask = (uint32_t)-1 >> (32 - end) & (uint32_t)-1 << bit;
+    uint32_t data = dst_addr.read<uint16_t>();
+    if (end > 16) {
+        data |= (uint32_t)dst_addr.read<uint16_t>(2) << 16;
+    }
+    data = (data & ~mask) | ((uint32_t)this->ax << bit & mask);
+    dst_addr.write<uint16_t>(data);
+    if (end > 16) {
+        dst_addr.write<uint16_t>(data >> 16, 2);
+    }
+    offset = end & 0xF;
+    if (end >= 16) {
+        this->di += 2;
+    }
+    return false;
 }
 
 template <z86BaseTemplate>
 template <typename T, typename P>
 inline bool regcall z86BaseDefault::OUTS_impl() {
-    intptr_t offset = this->direction ? sizeof(T) : -sizeof(T);
+    intptr_t offset = this->direction ? -(intptr_t)sizeof(T) : sizeof(T);
     z86Addr src_addr = this->str_src<P>();
     uint16_t port = this->dx;
     if (this->has_rep()) {
-        if (this->C<P>()) {
+        if (P count = this->rep_chunk(this->C<P>())) {
+            P stop = this->C<P>() - count;
             do {
-                // TODO: Interrupt check here
                 this->port_out_impl<T>(port, src_addr.read_advance<T>(offset));
-            } while (--this->C<P>());
+            } while (--this->C<P>() != stop && !this->access_faulted());
+            this->rep_yield = stop;
         }
     }
     else {
         this->port_out_impl<T>(port, src_addr.read_advance<T>(offset));
     }
+    if (this->access_faulted()) {
+        src_addr += -offset;
+        if (this->has_rep()) {
+            ++this->C<P>();
+        }
+    }
     this->SI<P>() = src_addr.offset;
     return false;
 }
@@ -1091,20 +1555,27 @@ inline bool regcall z86BaseDefault::OUTS_impl() {
 template <z86BaseTemplate>
 template <typename T, typename P>
 inline bool regcall z86BaseDefault::INS_impl() {
-    intptr_t offset = this->direction ? sizeof(T) : -sizeof(T);
+    intptr_t offset = this->direction ? -(intptr_t)sizeof(T) : sizeof(T);
     z86AddrES dst_addr = this->str_dst<P>();
     uint16_t port = this->dx;
     if (this->has_rep()) {
-        if (this->C<P>()) {
+        if (P count = this->rep_chunk(this->C<P>())) {
+            P stop = this->C<P>() - count;
             do {
-                // TODO: Interrupt check here
                 dst_addr.write_advance<T>(this->port_in_impl<T>(port), offset);
-            } while (--this->C<P>());
+            } while (--this->C<P>() != stop && !this->access_faulted());
+            this->rep_yield = stop;
         }
     }
     else {
         dst_addr.write_advance<T>(this->port_in_impl<T>(port), offset);
     }
+    if (this->access_faulted()) {
+        dst_addr += -offset;
+        if (this->has_rep()) {
+            ++this->C<P>();
+        }
+    }
     this->DI<P>() = dst_addr.offset;
     return false;
 }
@@ -1115,43 +1586,33 @@ inline void regcall z86BaseDefault::port_out_impl(uint16_t port, T value) const
     uint32_t full_port = port;
 
     if constexpr (sizeof(T) == sizeof(uint8_t)) {
-        const std::vector<PortByteDevice*>& devices = io_byte_devices;
-        for (auto device : devices) {
-            if (device->out_byte(full_port, value)) {
-                return;
-            }
-        }
-        printf("Unhandled: OUT %X, %02X\n", port, value);
+        io_byte_ports.out(port, [=](PortByteDevice* device) regcall {
+            return device->out_byte(full_port, value);
+        });
     }
     else if constexpr (sizeof(T) == sizeof(uint16_t)) {
-        const std::vector<PortWordDevice*>& devices = io_word_devices;
-        for (auto device : devices) {
+        io_word_ports.out(port, [=](PortWordDevice* device) regcall {
             if constexpr (bus >= 16) {
                 if (
                     is_aligned<uint16_t>(full_port) &&
                     device->out_word(full_port, value)
                 ) {
-                    return;
+                    return true;
                 }
             }
-            if (
+            return
                 device->out_byte(full_port, value) &&
-                device->out_byte(full_port + 1, value >> 8)
-            ) {
-                return;
-            }
-        }
-        printf("Unhandled: OUT %X, %04X\n", port, value);
+                device->out_byte(full_port + 1, value >> 8);
+        });
     }
     else if constexpr (sizeof(T) == sizeof(uint32_t)) {
-        const std::vector<PortDwordDevice*>& devices = io_dword_devices;
-        for (auto device : devices) {
+        io_dword_ports.out(port, [=](PortDwordDevice* device) regcall {
             if constexpr (bus >= 32) {
                 if (
                     is_aligned<uint32_t>(full_port) &&
                     device->out_dword(full_port, value)
                 ) {
-                    return;
+                    return true;
                 }
             }
             if constexpr (bus >= 16) {
@@ -1160,19 +1621,15 @@ inline void regcall z86BaseDefault::port_out_impl(uint16_t port, T value) const
                     device->out_word(full_port, value) &&
                     device->out_word(full_port + 2, value >> 16)
                 ) {
-                    return;
+                    return true;
                 }
             }
-            if (
+            return
                 device->out_byte(full_port, value) &&
                 device->out_byte(full_port + 1, value >> 8) &&
                 device->out_byte(full_port + 2, value >> 16) &&
-                device->out_byte(full_port + 3, value >> 24)
-            ) {
-                return;
-            }
-        }
-        printf("Unhandled: OUT %X, %08X\n", port, value);
+                device->out_byte(full_port + 3, value >> 24);
+        });
     }
 }
 
@@ -1184,43 +1641,37 @@ inline T regcall z86BaseDefault::port_in_impl(uint16_t port) {
     T value;
 
     if constexpr (sizeof(T) == sizeof(uint8_t)) {
-        const std::vector<PortByteDevice*>& devices = io_byte_devices;
-        for (auto device : devices) {
-            if (device->in_byte(value, full_port)) {
-                return value;
-            }
+        if (io_byte_ports.in(port, [&](PortByteDevice* device) regcall {
+            return device->in_byte(value, full_port);
+        })) {
+            return value;
         }
-        printf("Unhandled: IN AL, %X\n", full_port);
     }
     else if constexpr (sizeof(T) == sizeof(uint16_t)) {
-        const std::vector<PortWordDevice*>& devices = io_word_devices;
-        for (auto device : devices) {
+        if (io_word_ports.in(port, [&](PortWordDevice* device) regcall {
             if constexpr (bus >= 16) {
                 if (
                     is_aligned<uint16_t>(full_port) &&
                     device->in_word(value, full_port)
                 ) {
-                    return value;
+                    return true;
                 }
             }
-            if (
+            return
                 device->in_byte(((uint8_t*)&value)[0], full_port) &&
-                device->in_byte(((uint8_t*)&value)[1], full_port + 1)
-            ) {
-                return value;
-            }
+                device->in_byte(((uint8_t*)&value)[1], full_port + 1);
+        })) {
+            return value;
         }
-        printf("Unhandled: IN AX, %X\n", full_port);
     }
     else if constexpr (sizeof(T) == sizeof(uint32_t)) {
-        const std::vector<PortDwordDevice*>& devices = io_dword_devices;
-        for (auto device : devices) {
+        if (io_dword_ports.in(port, [&](PortDwordDevice* device) regcall {
             if constexpr (bus >= 32) {
                 if (
                     is_aligned<uint32_t>(full_port) &&
                     device->in_dword(value, full_port)
                 ) {
-                    return value;
+                    return true;
                 }
             }
             if constexpr (bus >= 16) {
@@ -1229,19 +1680,17 @@ inline T regcall z86BaseDefault::port_in_impl(uint16_t port) {
                     device->in_word(((uint16_t*)&value)[0], full_port) &&
                     device->in_word(((uint16_t*)&value)[1], full_port + 2)
                 ) {
-                    return value;
+                    return true;
                 }
             }
-            if (
+            return
                 device->in_byte(((uint8_t*)&value)[0], full_port) &&
                 device->in_byte(((uint8_t*)&value)[1], full_port + 1) &&
                 device->in_byte(((uint8_t*)&value)[2], full_port + 2) &&
-                device->in_byte(((uint8_t*)&value)[3], full_port + 3)
-            ) {
-                return value;
-            }
+                device->in_byte(((uint8_t*)&value)[3], full_port + 3);
+        })) {
+            return value;
         }
-        printf("Unhandled: IN EAX, %X\n", full_port);
     }
     return 0;
 }
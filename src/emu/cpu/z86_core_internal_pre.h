@@ -21,9 +21,27 @@
 // Random 80186 jank: https://news.ycombinator.com/item?id=34334799
 
 #include "../zero/util.h"
+#include "8086_cpu.h"
+#include "z86_tlb.h"
 
 #define USE_BITFIELDS 1
 #define USE_VECTORS 1
+#define USE_DECODE_CACHE 1
+#define USE_LAZY_FLAGS 1
+
+// Experimental x86-64 translation of hot register only blocks (z86_jit.h)
+#ifndef USE_JIT
+#define USE_JIT 0
+#endif
+
+// Computed goto dispatch of the opcode switch
+#ifndef USE_THREADED_DISPATCH
+#if __GNUC__ || __clang__
+#define USE_THREADED_DISPATCH 1
+#else
+#define USE_THREADED_DISPATCH 0
+#endif
+#endif
 
 #undef REX
 
@@ -138,10 +156,227 @@ enum z86FeatureFlagsA : uint64_t {
 
 // Code shared between x86 cores
 
-template <size_t bytes>
+// Physical memory, mapped in pages that are either backed by
+// host memory or forwarded to a MemoryDevice.
+//
+// address_space is fixed per CPU model while the amount of RAM
+// is picked at runtime, anything past it reads as open bus.
+// Addresses wrap at the end of the address space, and with
+// more than 1 MB the A20 gate can mask bit 20 as well.
+// Accesses that straddle a page boundary are split into bytes,
+// everything else on a host backed page is a single load or store.
+template <size_t address_space>
 struct z86Memory {
-    unsigned char raw[bytes];
+    static inline constexpr size_t max_size = address_space;
+    static inline constexpr size_t page_bits = 12;
+    static inline constexpr size_t page_size = (size_t)1 << page_bits;
+    static inline constexpr size_t page_mask = page_size - 1;
+    static inline constexpr size_t page_count = address_space >> page_bits;
+    static inline constexpr bool has_a20 = address_space > 1_MB;
+    static_assert(std::has_single_bit(address_space) && address_space >= page_size);
+
+    unsigned char* raw;
+    size_t size;
+
+    // Only read when there's an A20 gate, otherwise the
+    // wrap is the constant address_space - 1
+    size_t address_mask;
+
+    // Host memory for each page, NULL when a device handles it
+    uint8_t* read_page[page_count];
+    uint8_t* write_page[page_count];
+    MemoryDevice* device[page_count];
+
+    // Write target of every ROM page
+    uint8_t rom_sink[page_size];
+
+    // Handles pages past the end of RAM
+    MemoryDevice open_bus;
+
+    inline z86Memory() {
+        this->raw = NULL;
+        // The gate starts out masked like after a reset
+        this->address_mask = (address_space - 1) & ~(has_a20 ? (size_t)1_MB : 0);
+        this->resize(address_space);
+    }
+
+    inline ~z86Memory() {
+        free(this->raw);
+    }
+
+    // Anything mapped over RAM has to be mapped again afterwards
+    inline bool resize(size_t bytes) {
+        bytes = (std::min)((bytes + page_mask) & ~page_mask, address_space);
+        unsigned char* new_raw = (unsigned char*)calloc(bytes, 1);
+        if (!new_raw) {
+            return false;
+        }
+        free(this->raw);
+        this->raw = new_raw;
+        this->size = bytes;
+        this->map_ram(0, bytes);
+        this->map_device(&this->open_bus, bytes, address_space - bytes);
+        return true;
+    }
 
+    inline size_t regcall wrap(size_t offset) const {
+        if constexpr (has_a20) {
+            return offset & this->address_mask;
+        }
+        else {
+            return offset & (address_space - 1);
+        }
+    }
+
+    inline void set_a20(bool enabled) {
+        if constexpr (has_a20) {
+            size_t mask = enabled ? address_space - 1 : (address_space - 1) & ~(size_t)1_MB;
+            if (mask != this->address_mask) {
+                this->address_mask = mask;
+                // Decodes are tagged with unwrapped addresses
+                this->invalidate_all_code();
+            }
+        }
+    }
+
+    inline bool a20() const {
+        return this->wrap(1_MB) != 0;
+    }
+
+    inline void map_ram(size_t first, size_t length) {
+        for (size_t page = first >> page_bits; page < (first + length + page_mask) >> page_bits && page < page_count; ++page) {
+            if ((page << page_bits) >= this->size) {
+                break;
+            }
+            this->read_page[page] = &this->raw[page << page_bits];
+            this->write_page[page] = &this->raw[page << page_bits];
+            this->device[page] = NULL;
+            this->invalidate_code(page << page_bits, page_size);
+        }
+    }
+
+    // Pages read from data, or the backing RAM when NULL, and drop writes.
+    // data has to cover every page in the range.
+    inline void map_rom(size_t first, size_t length, const void* data = NULL) {
+        const uint8_t* src = data ? (const uint8_t*)data - (first & ~page_mask) : this->raw;
+        for (size_t page = first >> page_bits; page < (first + length + page_mask) >> page_bits && page < page_count; ++page) {
+            if (!data && (page << page_bits) >= this->size) {
+                break;
+            }
+            this->read_page[page] = (uint8_t*)&src[page << page_bits];
+            this->write_page[page] = this->rom_sink;
+            this->device[page] = NULL;
+            this->invalidate_code(page << page_bits, page_size);
+        }
+    }
+
+    inline void map_device(MemoryDevice* handler, size_t first, size_t length) {
+        for (size_t page = first >> page_bits; page < (first + length + page_mask) >> page_bits && page < page_count; ++page) {
+            this->read_page[page] = NULL;
+            this->write_page[page] = NULL;
+            this->device[page] = handler;
+            this->invalidate_code(page << page_bits, page_size);
+        }
+    }
+
+    template <typename T>
+    static inline constexpr bool regcall fits_in_page(size_t offset) {
+        return sizeof(T) == 1 || (offset & page_mask) <= page_size - sizeof(T);
+    }
+
+    // Host memory behind [offset, offset + length) when it's
+    // one contiguous run of RAM, NULL otherwise
+    inline uint8_t* regcall host_span(uint8_t* const* pages, size_t offset, size_t length) const {
+        size_t first = this->wrap(offset);
+        if (this->wrap(offset + length - 1) - first != length - 1) {
+            return NULL;
+        }
+        uint8_t* host = pages[first >> page_bits];
+        if (!host || host == this->rom_sink) {
+            return NULL;
+        }
+        for (size_t page = (first >> page_bits) + 1; page <= (first + length - 1) >> page_bits; ++page) {
+            if (pages[page] != host + ((page - (first >> page_bits)) << page_bits)) {
+                return NULL;
+            }
+        }
+        return host + (first & page_mask);
+    }
+
+    inline const uint8_t* regcall read_span(size_t offset, size_t length) const {
+        return this->host_span(this->read_page, offset, length);
+    }
+
+    // The caller is expected to overwrite the whole span
+    inline uint8_t* regcall write_span(size_t offset, size_t length) {
+        uint8_t* host = this->host_span(this->write_page, offset, length);
+        if (host) {
+            this->invalidate_code(this->wrap(offset), length);
+        }
+        return host;
+    }
+
+#if USE_DECODE_CACHE
+    // Pages are split into 64 byte lines so each page's lines fit
+    // in one word, with a bit set for every line holding cached
+    // instructions. A write costs a single test unless it lands
+    // on one of those lines, and data next to code doesn't throw
+    // the page's decodes away.
+    static inline constexpr size_t code_line_bits = 6;
+    static_assert(page_bits - code_line_bits == 6);
+
+    uint64_t code_lines[page_count];
+    // Bumped on writes to code lines so stale decodes miss
+    uint32_t page_generation[page_count];
+
+    // Lines covering the first through last byte of a page
+    static inline constexpr uint64_t regcall code_line_mask(size_t first, size_t last) {
+        return (UINT64_MAX >> (63 - (last >> code_line_bits))) & (UINT64_MAX << (first >> code_line_bits));
+    }
+
+    // The bytes have to be within a single page
+    inline uint32_t regcall mark_code(size_t offset, size_t length) {
+        offset = this->wrap(offset);
+        size_t page = offset >> page_bits;
+        this->code_lines[page] |= code_line_mask(offset & page_mask, (offset & page_mask) + length - 1);
+        return this->page_generation[page];
+    }
+
+    inline uint32_t regcall code_generation(size_t offset) const {
+        return this->page_generation[this->wrap(offset) >> page_bits];
+    }
+
+    inline void regcall invalidate_code(size_t offset, size_t length) {
+        size_t page = offset >> page_bits;
+        size_t last = offset + length - 1;
+        size_t last_page = (std::min)(last >> page_bits, page_count - 1);
+        for (; page <= last_page; ++page) {
+            if (uint64_t lines = this->code_lines[page]; expect(lines != 0, false)) {
+                size_t first_byte = page == offset >> page_bits ? offset & page_mask : 0;
+                size_t last_byte = page == last >> page_bits ? last & page_mask : page_mask;
+                if (lines & code_line_mask(first_byte, last_byte)) {
+                    this->code_lines[page] = 0;
+                    ++this->page_generation[page];
+                }
+            }
+        }
+    }
+
+    inline void invalidate_all_code() {
+        for (size_t page = 0; page < page_count; ++page) {
+            this->code_lines[page] = 0;
+            ++this->page_generation[page];
+        }
+    }
+#else
+    inline void regcall invalidate_code(size_t offset, size_t length) {
+    }
+
+    inline void invalidate_all_code() {
+    }
+#endif
+
+    // Direct access to the backing RAM, bypassing the page map
     template <typename T = uint8_t>
     inline T* ptr(size_t offset) {
         return (T*)&this->raw[offset];
@@ -164,52 +399,215 @@ struct z86Memory {
 
     template <typename T = uint8_t>
     inline T read(size_t offset) const {
-        return this->ref<T>(offset);
+        offset = this->wrap(offset);
+        const uint8_t* host = this->read_page[offset >> page_bits];
+        if (expect(host && fits_in_page<T>(offset), true)) {
+            return *(const T*)&host[offset & page_mask];
+        }
+        return this->read_slow<T>(offset);
+    }
+
+    template <typename T>
+    inline T regcall read_slow(size_t offset) const {
+        if (MemoryDevice* handler = this->device[offset >> page_bits]) {
+            if constexpr (sizeof(T) == sizeof(uint8_t)) {
+                return std::bit_cast<T>(handler->read_byte(offset));
+            }
+            else if constexpr (sizeof(T) == sizeof(uint16_t)) {
+                if (fits_in_page<T>(offset)) {
+                    return std::bit_cast<T>(handler->read_word(offset));
+                }
+            }
+        }
+        unsigned char value[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value[i] = this->read<uint8_t>(offset + i);
+        }
+        return *(T*)value;
     }
 
     template <typename T = uint8_t>
     inline void regcall write(size_t offset, const T& value) {
-        if constexpr (!std::is_array_v<std::remove_reference_t<T>>) {
-            this->ref<T>(offset) = value;
-        } else {
-            memcpy(this->ptr(offset), &value, sizeof(T));
+        offset = this->wrap(offset);
+        uint8_t* host = this->write_page[offset >> page_bits];
+        if (expect(host && fits_in_page<T>(offset), true)) {
+            this->invalidate_code(offset, sizeof(T));
+            if constexpr (!std::is_array_v<std::remove_reference_t<T>>) {
+                *(T*)&host[offset & page_mask] = value;
+            } else {
+                memcpy(&host[offset & page_mask], &value, sizeof(T));
+            }
+            return;
+        }
+        this->write_slow<T>(offset, value);
+    }
+
+    template <typename T>
+    inline void regcall write_slow(size_t offset, const T& value) {
+        if (MemoryDevice* handler = this->device[offset >> page_bits]) {
+            if constexpr (sizeof(T) == sizeof(uint8_t)) {
+                return handler->write_byte(offset, *(const uint8_t*)&value);
+            }
+            else if constexpr (sizeof(T) == sizeof(uint16_t)) {
+                if (fits_in_page<T>(offset)) {
+                    return handler->write_word(offset, *(const uint16_t*)&value);
+                }
+            }
+        }
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            this->write<uint8_t>(offset + i, ((const uint8_t*)&value)[i]);
         }
     }
 
     inline uint8_t& operator[](size_t offset) {
-        return this->read(offset);
+        return this->ref(offset);
     }
 
     inline const uint8_t& operator[](size_t offset) const {
-        return this->read(offset);
+        return this->ref(offset);
     }
 
     inline size_t read(void* dst, size_t src, size_t length) const {
-        if (src < bytes) {
-            length = (std::min)(bytes - src, length);
-            memcpy(dst, &this->raw[src], length);
+        if (src < address_space) {
+            length = (std::min)(address_space - src, length);
+            this->read_movsb(dst, src, length);
             return length;
         }
         return 0;
     }
 
     inline void* read_movsb(void* dst, size_t src, size_t length) const {
-        return rep_movsb(dst, &this->raw[src], length);
+        uint8_t* out = (uint8_t*)dst;
+        while (length) {
+            src = this->wrap(src);
+            size_t chunk = (std::min)(page_size - (src & page_mask), length);
+            if (const uint8_t* host = this->read_page[src >> page_bits]) {
+                out = (uint8_t*)rep_movsb(out, &host[src & page_mask], chunk);
+            }
+            else {
+                for (size_t i = 0; i < chunk; ++i) {
+                    *out++ = this->read_slow<uint8_t>(src + i);
+                }
+            }
+            src += chunk;
+            length -= chunk;
+        }
+        return out;
     }
 
     inline size_t write(size_t dst, const void* src, size_t length) {
-        if (dst < bytes) {
-            length = (std::min)(bytes - dst, length);
-            memcpy(&this->raw[dst], src, length);
+        if (dst < address_space) {
+            length = (std::min)(address_space - dst, length);
+            this->write_movsb(dst, src, length);
             return length;
         }
         return 0;
     }
 
     inline const void* write_movsb(size_t dst, const void* src, size_t length) {
-        return rep_movsbS(&this->raw[dst], src, length);
+        const uint8_t* in = (const uint8_t*)src;
+        while (length) {
+            dst = this->wrap(dst);
+            size_t chunk = (std::min)(page_size - (dst & page_mask), length);
+            if (uint8_t* host = this->write_page[dst >> page_bits]) {
+                this->invalidate_code(dst, chunk);
+                in = (const uint8_t*)rep_movsbS(&host[dst & page_mask], in, chunk);
+            }
+            else {
+                for (size_t i = 0; i < chunk; ++i) {
+                    this->write_slow<uint8_t>(dst + i, *in++);
+                }
+            }
+            dst += chunk;
+            length -= chunk;
+        }
+        return in;
+    }
+};
+
+#if USE_DECODE_CACHE
+// Prefix and opcode bytes of a previously executed instruction,
+// replayed into the opcode switch without refetching them, and
+// the form of its ModRM memory operand once that's been decoded
+struct z86DecodeEntry {
+    uint32_t tag; // Physical address + 1, 0 when empty
+    uint32_t generation;
+    uint8_t opcode;
+    uint8_t map;
+    uint8_t length;
+    bool lock;
+    int8_t seg_override;
+    int8_t rep_type;
+
+    // The operand's offset is disp plus both registers
+    // masked, so replaying it doesn't branch on the form
+    bool has_ea;
+    uint8_t ea_length; // Displacement bytes after the ModRM
+    uint8_t ea_segment;
+    uint8_t ea_base;
+    uint8_t ea_index;
+    uint16_t ea_base_mask;
+    uint16_t ea_index_mask;
+    uint16_t ea_disp;
+
+    // Only operands that directly follow the opcode
+    // on the same page are recorded, and their bytes
+    // are marked as code so rewriting them misses
+    template <typename M>
+    inline void regcall set_ea(size_t end, uint8_t length, uint8_t segment, uint8_t base, uint16_t base_mask, uint8_t index, uint16_t index_mask, uint16_t disp, M& memory) {
+        size_t addr = this->tag - 1;
+        if (
+            end == addr + this->length + 1 + length && ((addr ^ (end - 1)) >> M::page_bits) == 0 &&
+            memory.mark_code(addr, end - addr) == this->generation
+        ) {
+            this->has_ea = true;
+            this->ea_length = length;
+            this->ea_segment = segment;
+            this->ea_base = base;
+            this->ea_index = index;
+            this->ea_base_mask = base_mask;
+            this->ea_index_mask = index_mask;
+            this->ea_disp = disp;
+        }
+    }
+};
+
+template <size_t entries>
+struct z86DecodeCache {
+    static_assert((entries & entries - 1) == 0);
+
+    z86DecodeEntry entry[entries];
+
+    inline z86DecodeEntry& regcall lookup(size_t addr) {
+        return this->entry[addr & (entries - 1)];
+    }
+
+    template <typename M>
+    inline bool regcall hit(const z86DecodeEntry& decode, size_t addr, const M& memory) const {
+        return decode.tag == addr + 1 && decode.generation == memory.code_generation(addr);
+    }
+
+    // Only cache instructions whose bytes are contiguous in a single page.
+    // Returns the filled entry, NULL if the instruction wasn't cached.
+    template <typename C, typename M>
+    inline z86DecodeEntry* regcall fill(z86DecodeEntry& decode, size_t addr, size_t length, uint8_t opcode, uint8_t map, const C& cpu, M& memory) {
+        if (expect(((addr ^ (addr + length - 1)) >> M::page_bits) == 0, true)) {
+            decode.tag = addr + 1;
+            decode.generation = memory.mark_code(addr, length);
+            decode.opcode = opcode;
+            decode.map = map;
+            decode.length = length;
+            decode.lock = cpu.lock;
+            decode.seg_override = cpu.seg_override;
+            decode.rep_type = cpu.rep_type;
+            decode.has_ea = false;
+            return &decode;
+        }
+        decode.tag = 0;
+        return NULL;
     }
 };
+#endif
 
 template <size_t bits>
 struct GPR;
@@ -479,7 +877,7 @@ struct SEG_DESCRIPTOR<32> : SEG_DESCRIPTOR<0> {
     inline constexpr uint32_t limit() const {
         uint32_t limit = (uint32_t)this->limit_low | (uint32_t)this->limit_high << 16;
         if (this->granularity) {
-            limit <<= 12;
+            limit = limit << 12 | 0xFFF;
         }
         return limit;
     }
@@ -1523,6 +1921,46 @@ struct z86DescriptorCache80286 {
     uint16_t limit;
 };
 
+// Precomputed from the limit and access rights when a
+// descriptor is cached so that checking an access is a
+// single compare. Offsets in [base, base + length) pass.
+template <typename LT, typename WT>
+struct z86SegmentWindow {
+    LT base = 0;
+    WT read = 0;
+    WT write = 0;
+
+    inline constexpr z86SegmentWindow() = default;
+
+    // top is the highest offset of an expand down segment
+    inline constexpr z86SegmentWindow(LT limit, WT top, uint8_t access) {
+        // Not present or system
+        if ((access & 0x90) != 0x90) {
+            return;
+        }
+        WT length = (WT)limit + 1;
+        bool is_code = access & 0x08;
+        if (!is_code && access & 0x04) {
+            if (limit >= top) {
+                return;
+            }
+            this->base = limit + 1;
+            length = top - limit;
+        }
+        // Execute only code is rejected when the selector
+        // is loaded, so CS can be fetched from regardless
+        this->read = length;
+        if (!is_code && access & 0x02) {
+            this->write = length;
+        }
+    }
+
+    template <size_t size>
+    inline constexpr bool fits(LT offset, WT length) const {
+        return (WT)(LT)(offset - this->base) + size <= length;
+    }
+};
+
 template <size_t max_bits>
 struct z86DescriptorCacheBase;
 // Seg Defaults:
@@ -1540,18 +1978,21 @@ struct z86DescriptorCacheBase<16> {
     using BT = uint32_t; // Base Type
     using LT = uint16_t; // Limit type
 
+    using WT = uint32_t; // Window type
+
     const uint32_t base = 0; // 0x0
     const uint16_t limit = 0; // 0x4
     const uint8_t type = 0; // 0x6
     const uint8_t privilege = 0; // 0x7
-    // 0x8
+    const z86SegmentWindow<LT, WT> window = {}; // 0x8
+    // 0x14
 
     inline constexpr z86DescriptorCacheBase() = default;
     inline constexpr z86DescriptorCacheBase(uint16_t limit, uint32_t base) : base(base), limit(limit), type(0), privilege(0) {}
-    inline constexpr z86DescriptorCacheBase(uint16_t limit, uint32_t base, uint8_t type, uint8_t privilege) : base(base), limit(limit), type(type), privilege(privilege) {}
+    inline constexpr z86DescriptorCacheBase(uint16_t limit, uint32_t base, uint8_t type, uint8_t privilege) : base(base), limit(limit), type(type), privilege(privilege), window(limit, 0xFFFF, type) {}
 
     inline constexpr z86DescriptorCacheBase(SEG_DESCRIPTOR<16>* descriptor)
-        : base(descriptor->base()), limit(descriptor->limit()), type(0), privilege(0)
+        : base(descriptor->base()), limit(descriptor->limit()), type(descriptor->flags1), privilege(descriptor->dpl), window(descriptor->limit(), 0xFFFF, descriptor->flags1)
     {}
 };
 
@@ -1561,18 +2002,22 @@ struct z86DescriptorCacheBase<32> {
     using BT = uint32_t; // Base Type
     using LT = uint32_t; // Limit type
 
+    using WT = uint64_t; // Window type
+
     const uint32_t base = 0; // 0x0
     const uint32_t limit = 0; // 0x4
     const uint8_t type = 0; // 0x8
     const uint8_t privilege = 0; // 0x9
-    // 0xA
+    const z86SegmentWindow<LT, WT> window = {}; // 0x10
+    // 0x28
 
     inline constexpr z86DescriptorCacheBase() = default;
     inline constexpr z86DescriptorCacheBase(uint32_t limit, uint32_t base) : base(base), limit(limit), type(0), privilege(0) {}
-    inline constexpr z86DescriptorCacheBase(uint32_t limit, uint32_t base, uint8_t type, uint8_t privilege) : base(base), limit(limit), type(type), privilege(privilege) {}
+    inline constexpr z86DescriptorCacheBase(uint32_t limit, uint32_t base, uint8_t type, uint8_t privilege) : base(base), limit(limit), type(type), privilege(privilege), window(limit, 0xFFFF, type) {}
 
     inline constexpr z86DescriptorCacheBase(SEG_DESCRIPTOR<32>* descriptor)
-        : base(descriptor->base()), limit(descriptor->limit()), type(0), privilege(0)
+        : base(descriptor->base()), limit(descriptor->limit()), type(descriptor->flags1), privilege(descriptor->dpl),
+          window(descriptor->limit(), descriptor->big ? UINT32_MAX : 0xFFFF, descriptor->flags1)
     {}
 };
 
@@ -1582,18 +2027,22 @@ struct z86DescriptorCacheBase<64> {
     using BT = uint64_t; // Base Type
     using LT = uint32_t; // Limit type
 
+    using WT = uint64_t; // Window type
+
     const uint64_t base = 0; // 0x0
     const uint32_t limit = 0; // 0x8
     const uint8_t type = 0; // 0xC
     const uint8_t privilege = 0; // 0xD
-    // 0xE
+    const z86SegmentWindow<LT, WT> window = {}; // 0x10
+    // 0x28
 
     inline constexpr z86DescriptorCacheBase() = default;
     inline constexpr z86DescriptorCacheBase(uint32_t limit, uint64_t base) : base(base), limit(limit), type(0), privilege(0) {}
-    inline constexpr z86DescriptorCacheBase(uint32_t limit, uint64_t base, uint8_t type, uint8_t privilege) : base(base), limit(limit), type(type), privilege(privilege) {}
+    inline constexpr z86DescriptorCacheBase(uint32_t limit, uint64_t base, uint8_t type, uint8_t privilege) : base(base), limit(limit), type(type), privilege(privilege), window(limit, 0xFFFF, type) {}
     
     inline constexpr z86DescriptorCacheBase(SEG_DESCRIPTOR<64>* descriptor)
-        : base(descriptor->base()), limit(descriptor->limit()), type(0), privilege(0)
+        : base(descriptor->base()), limit(descriptor->limit()), type(descriptor->flags1), privilege(descriptor->dpl),
+          window(descriptor->limit(), descriptor->big ? UINT32_MAX : 0xFFFF, descriptor->flags1)
     {}
 };
 
@@ -1619,8 +2068,18 @@ struct z86DescriptorCache : z86DescriptorCacheBase<max_bits> {
     }
     */
 
-    // Invoked on GDT/LDT
-    inline constexpr SEG_DESCRIPTOR<max_bits>* load_selector(uint16_t selector) const;
+    template <size_t size>
+    inline constexpr bool can_read(LT offset) const {
+        return this->window.template fits<size>(offset, this->window.read);
+    }
+
+    template <size_t size>
+    inline constexpr bool can_write(LT offset) const {
+        return this->window.template fits<size>(offset, this->window.write);
+    }
+
+    // Invoked on GDT/LDT, false when the descriptor is past the limit
+    inline bool load_selector(uint16_t selector, SEG_DESCRIPTOR<max_bits>& descriptor) const;
 };
 
 struct z86Loadall2Frame {
@@ -1661,6 +2120,8 @@ struct z86Loadall2Frame {
     z86DescriptorCache80286 tss_descriptor;
 };
 
+using z86PageTlb = z86Tlb<256>;
+
 template <size_t max_bits, bool protected_mode>
 struct z86BaseControlBase;
 
@@ -1787,6 +2248,8 @@ struct z86BaseControlBase<32, true> {
         };
     };
     uint8_t cpl;
+
+    z86PageTlb tlb;
 };
 
 template <>
@@ -1844,6 +2307,8 @@ struct z86BaseControlBase<64, true> {
         };
     };
     uint8_t cpl;
+
+    z86PageTlb tlb;
 };
 
 template <size_t max_bits, bool use_old_reset, bool has_protected_mode>
@@ -1862,11 +2327,13 @@ struct z86BaseControl<max_bits, use_old_reset, false> : z86BaseControlBase<max_b
         return 0;
     }
 
-    inline constexpr void write_seg_impl(uint8_t index, uint16_t value) {
+    inline constexpr bool write_seg_impl(uint8_t index, uint16_t value) {
         this->seg[index] = value;
+        return true;
     }
 
-    inline constexpr void write_control_seg(uint8_t index, uint16_t value) {
+    inline constexpr bool write_control_seg(uint8_t index, uint16_t value) {
+        return true;
     }
 
     // Assuming a previous memset of full context
@@ -1897,6 +2364,21 @@ struct z86BaseControl<max_bits, use_old_reset, false> : z86BaseControlBase<max_b
     }
     inline constexpr void set_machine_status_word(uint16_t msw) {
     }
+
+    inline constexpr size_t get_control_reg(uint8_t index) const {
+        return 0;
+    }
+    inline constexpr bool set_control_reg(uint8_t index, size_t value) {
+        return false;
+    }
+
+    inline constexpr bool paging_enabled() const {
+        return false;
+    }
+    inline constexpr void invalidate_page(size_t addr) {
+    }
+    inline constexpr void flush_tlb() {
+    }
 };
 
 // Various notes about 80286 descriptor caches, LOADALL, etc.:
@@ -1919,10 +2401,14 @@ struct z86BaseControl<max_bits, use_old_reset, true> : z86BaseControlBase<max_bi
         return this->seg[LDT + index];
     }
 
-    inline constexpr void write_seg_impl(uint8_t index, uint16_t selector) {
+    inline constexpr bool write_seg_impl(uint8_t index, uint16_t selector) {
         if (this->protected_mode) {
             //this->descriptors[index].load_descriptor(this->descriptors[GDT + (selector >> 2 & 1)].load_selector(selector));
-            auto* new_descriptor = this->descriptors[GDT + (selector >> 2 & 1)].load_selector(selector);
+            SEG_DESCRIPTOR<max_bits> descriptor;
+            if (!this->descriptors[GDT + (selector >> 2 & 1)].load_selector(selector, descriptor)) {
+                return false;
+            }
+            auto* new_descriptor = &descriptor;
 
             // CHECK FOR DANG GATES
             
@@ -1934,10 +2420,11 @@ struct z86BaseControl<max_bits, use_old_reset, true> : z86BaseControlBase<max_bi
             reconstruct_at(&this->descriptors[index], this->descriptors[index].limit, (size_t)selector << 4, this->descriptors[index].type, this->descriptors[index].privilege);
         }
         this->seg[index] = selector;
+        return true;
     }
 
-    inline constexpr void write_control_seg(uint8_t index, uint16_t value) {
-        this->write_seg_impl(LDT + index, value);
+    inline constexpr bool write_control_seg(uint8_t index, uint16_t value) {
+        return this->write_seg_impl(LDT + index, value);
     }
 
     // Used for control flow specifically
@@ -1961,7 +2448,7 @@ struct z86BaseControl<max_bits, use_old_reset, true> : z86BaseControlBase<max_bi
             //this->descriptors[i].limit = 0xFFFF;
             //std::destroy_at(&this->descriptors[i]);
             //new (&this->descriptors[i]) z86DescriptorCache<max_bits>((LT)0xFFFF, (BT)0);
-            reconstruct_at(&this->descriptors[i], 0xFFFF, this->descriptors[i].base, this->descriptors[i].type, this->descriptors[i].privilege);
+            reconstruct_at(&this->descriptors[i], 0xFFFF, this->descriptors[i].base, 0x93, this->descriptors[i].privilege);
         }
         //std::destroy_at(&this->cs_descriptor);
         //new (&this->cs_descriptor) z86DescriptorCache<max_bits>((LT)0xFFFF, (BT)0);
@@ -1989,6 +2476,58 @@ struct z86BaseControl<max_bits, use_old_reset, true> : z86BaseControlBase<max_bi
         // TODO: filter bits
         this->msw = msw;
     }
+
+    inline constexpr size_t get_control_reg(uint8_t index) const {
+        if constexpr (max_bits > 16) {
+            return this->cr[index];
+        }
+        else {
+            return index ? 0 : this->msw;
+        }
+    }
+
+    // Returns false for registers that don't exist
+    inline bool set_control_reg(uint8_t index, size_t value) {
+        if constexpr (max_bits > 16) {
+            switch (index) {
+                case 0:
+                    // PG, WP, and PE all change what a translation means
+                    if ((this->cr0 ^ value) & 0x80010001) {
+                        this->flush_tlb();
+                    }
+                    [[fallthrough]];
+                case 2:
+                case 4:
+                    this->cr[index] = value;
+                    return true;
+                case 3:
+                    this->cr3 = value;
+                    this->flush_tlb();
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    inline constexpr bool paging_enabled() const {
+        if constexpr (max_bits > 16) {
+            return this->cr0 & 0x80000000;
+        }
+        return false;
+    }
+    inline void invalidate_page(size_t addr) {
+        if constexpr (max_bits > 16) {
+            this->tlb.flush_page(addr);
+        }
+    }
+    // Entries point at host memory, so the memory map can't change under them
+    inline void flush_tlb() {
+        if constexpr (max_bits > 16) {
+            this->tlb.flush();
+        }
+    }
 };
 
 template <size_t max_bits, bool use_old_reset, bool has_protected_mode, bool has_x87, size_t max_sse_bits, size_t sse_reg_count>
@@ -2345,7 +2884,8 @@ struct z86AddrSharedFuncs {
     template <typename T>
     static inline constexpr bool addr_crosses_page(size_t addr);
 
-    static inline constexpr size_t regcall virt_to_phys(size_t addr);
+    template <bool is_write = false>
+    static inline size_t regcall virt_to_phys(size_t addr);
 
     template <typename T, typename P>
     static inline void regcall write(P* self, const T& value, ssize_t offset);
@@ -2353,6 +2893,14 @@ struct z86AddrSharedFuncs {
     template <typename T = uint8_t, typename V = std::remove_reference_t<T>, typename P>
     static inline V read(const P* self, ssize_t offset = 0);
 
+    // Skip the segment wrap check for callers that
+    // have already proven the access can't wrap
+    template <typename T, typename P>
+    static inline void regcall write_nowrap(P* self, const T& value, ssize_t offset);
+
+    template <typename T = uint8_t, typename V = std::remove_reference_t<T>, typename P>
+    static inline V read_nowrap(const P* self, ssize_t offset = 0);
+
     template <typename P>
     static inline uint32_t read_Iz(const P* self, ssize_t index = 0);
 
@@ -2543,6 +3091,13 @@ struct z86AddrImpl : z86AddrBase<bits, protected_mode> {
 
     inline constexpr size_t seg() const;
 
+    // Whether segment indexes the descriptor caches
+    static inline constexpr bool has_descriptor = protected_mode;
+
+    inline constexpr uint8_t seg_index() const {
+        return this->segment;
+    }
+
     inline constexpr size_t addr(ssize_t offset = 0) const {
         return this->seg() + this->ptr(offset);
     }
@@ -2625,6 +3180,29 @@ struct z86AddrImpl : z86AddrBase<bits, protected_mode> {
         return ret;
     }
 
+    template <typename T = uint8_t>
+    inline void regcall write_nowrap(const T& value, ssize_t offset = 0) {
+        return z86AddrSharedFuncs::write_nowrap<T>(this, value, offset);
+    }
+
+    template <typename T = uint8_t, typename V = std::remove_reference_t<T>>
+    inline V read_nowrap(ssize_t offset = 0) const {
+        return z86AddrSharedFuncs::read_nowrap<T>(this, offset);
+    }
+
+    template <typename T = uint8_t>
+    inline void regcall write_advance_nowrap(const T& value, ssize_t index = sizeof(T)) {
+        this->write_nowrap(value);
+        this->offset += index;
+    }
+
+    template <typename T = uint8_t, typename V = std::remove_reference_t<T>>
+    inline V read_advance_nowrap(ssize_t index = sizeof(V)) {
+        V ret = this->read_nowrap<V>();
+        this->offset += index;
+        return ret;
+    }
+
     inline uint32_t read_Iz(ssize_t index = 0) const {
         return z86AddrSharedFuncs::read_Iz(this, index);
     }
@@ -2721,6 +3299,12 @@ struct z86AddrFixedImpl : z86AddrFixedBase<max_bits> {
 
     inline constexpr size_t seg() const;
 
+    static inline constexpr bool has_descriptor = true;
+
+    inline constexpr uint8_t seg_index() const {
+        return descriptor_index;
+    }
+
     inline constexpr size_t addr(ssize_t offset = 0) const {
         return this->seg() + this->ptr(offset);
     }
@@ -2799,6 +3383,29 @@ struct z86AddrFixedImpl : z86AddrFixedBase<max_bits> {
         return ret;
     }
 
+    template <typename T = uint8_t>
+    inline void regcall write_nowrap(const T& value, ssize_t offset = 0) {
+        return z86AddrSharedFuncs::write_nowrap<T>(this, value, offset);
+    }
+
+    template <typename T = uint8_t, typename V = std::remove_reference_t<T>>
+    inline V read_nowrap(ssize_t offset = 0) const {
+        return z86AddrSharedFuncs::read_nowrap<T>(this, offset);
+    }
+
+    template <typename T = uint8_t>
+    inline void regcall write_advance_nowrap(const T& value, ssize_t index = sizeof(T)) {
+        this->write_nowrap(value);
+        this->offset += index;
+    }
+
+    template <typename T = uint8_t, typename V = std::remove_reference_t<T>>
+    inline V read_advance_nowrap(ssize_t index = sizeof(V)) {
+        V ret = this->read_nowrap<V>();
+        this->offset += index;
+        return ret;
+    }
+
     inline uint32_t read_Iz(ssize_t index = 0) const {
         return z86AddrSharedFuncs::read_Iz(this, index);
     }
@@ -3041,7 +3648,9 @@ struct z86Base :
         if constexpr (WRAP_SEGMENT_MODRM) {
             index &= 3;
         }
-        return this->write_seg_impl(index, selector);
+        if (!this->write_seg_impl(index, selector)) {
+            this->set_selector_fault();
+        }
     }
 
     template <bool ignore_rex = false>
@@ -3631,35 +4240,158 @@ struct z86Base :
     bool direction;
     bool overflow;
 
-    inline constexpr bool cond_O(bool val = true) const { return this->overflow == val; }
-    inline constexpr bool cond_NO(bool val = true) const { return this->overflow != val; }
-    inline constexpr bool cond_C(bool val = true) const { return this->carry == val; }
+#if USE_LAZY_FLAGS
+    // Arithmetic flags of the last ALU op are only computed when read.
+    // While lazy_op != LazyNone the carry/parity/auxiliary/zero/sign/overflow
+    // members are stale and must be read via the get_* functions.
+    enum LazyFlagsOp : uint8_t {
+        LazyNone,
+        LazyAdd,
+        LazyAdc, // ADC with carry in
+        LazySub,
+        LazySbb, // SBB with carry in
+        LazyLogic, // CF/OF/AF stored
+        LazyInc, // CF stored
+        LazyDec // CF stored
+    };
+
+    uint8_t lazy_op;
+    RT lazy_dst;
+    RT lazy_src;
+    RT lazy_res;
+    RT lazy_msb;
+
+    template <typename T>
+    inline void regcall set_lazy_flags(uint8_t op, T dst, T src, T res) {
+        using U = std::make_unsigned_t<T>;
+        this->lazy_op = op;
+        this->lazy_dst = (U)dst;
+        this->lazy_src = (U)src;
+        this->lazy_res = (U)res;
+        this->lazy_msb = (RT)1 << (bitsof(T) - 1);
+    }
+
+    // AF is left untouched by logic ops
+    template <typename T>
+    inline void regcall set_lazy_logic(T res) {
+        this->auxiliary = this->get_auxiliary();
+        this->carry = false;
+        this->overflow = false;
+        this->set_lazy_flags<T>(LazyLogic, 0, 0, res);
+    }
+#endif
+
+    inline constexpr bool get_carry() const {
+#if USE_LAZY_FLAGS
+        switch (this->lazy_op) {
+            case LazyAdd: return this->lazy_res < this->lazy_dst;
+            case LazyAdc: return this->lazy_res <= this->lazy_dst;
+            case LazySub: return this->lazy_dst < this->lazy_src;
+            case LazySbb: return this->lazy_dst <= this->lazy_src;
+        }
+#endif
+        return this->carry;
+    }
+
+    inline constexpr bool get_parity() const {
+#if USE_LAZY_FLAGS
+        if (this->lazy_op != LazyNone) {
+            return !__builtin_parity((uint8_t)this->lazy_res);
+        }
+#endif
+        return this->parity;
+    }
+
+    inline constexpr bool get_auxiliary() const {
+#if USE_LAZY_FLAGS
+        switch (this->lazy_op) {
+            case LazyAdd: case LazyAdc: case LazySub: case LazySbb: case LazyInc: case LazyDec:
+                return (this->lazy_dst ^ this->lazy_src ^ this->lazy_res) & 0x10;
+        }
+#endif
+        return this->auxiliary;
+    }
+
+    inline constexpr bool get_zero() const {
+#if USE_LAZY_FLAGS
+        if (this->lazy_op != LazyNone) {
+            return !this->lazy_res;
+        }
+#endif
+        return this->zero;
+    }
+
+    inline constexpr bool get_sign() const {
+#if USE_LAZY_FLAGS
+        if (this->lazy_op != LazyNone) {
+            return this->lazy_res & this->lazy_msb;
+        }
+#endif
+        return this->sign;
+    }
+
+    inline constexpr bool get_overflow() const {
+#if USE_LAZY_FLAGS
+        switch (this->lazy_op) {
+            case LazyAdd: case LazyAdc: case LazyInc:
+                return (this->lazy_dst ^ this->lazy_res) & (this->lazy_src ^ this->lazy_res) & this->lazy_msb;
+            case LazySub: case LazySbb: case LazyDec:
+                return (this->lazy_dst ^ this->lazy_src) & (this->lazy_dst ^ this->lazy_res) & this->lazy_msb;
+        }
+#endif
+        return this->overflow;
+    }
+
+    // Must be called before anything writes only some of the arithmetic flags
+    inline constexpr void resolve_flags() {
+#if USE_LAZY_FLAGS
+        if (this->lazy_op != LazyNone) {
+            bool carry = this->get_carry();
+            bool parity = this->get_parity();
+            bool auxiliary = this->get_auxiliary();
+            bool zero = this->get_zero();
+            bool sign = this->get_sign();
+            bool overflow = this->get_overflow();
+            this->carry = carry;
+            this->parity = parity;
+            this->auxiliary = auxiliary;
+            this->zero = zero;
+            this->sign = sign;
+            this->overflow = overflow;
+            this->lazy_op = LazyNone;
+        }
+#endif
+    }
+
+    inline constexpr bool cond_O(bool val = true) const { return this->get_overflow() == val; }
+    inline constexpr bool cond_NO(bool val = true) const { return this->get_overflow() != val; }
+    inline constexpr bool cond_C(bool val = true) const { return this->get_carry() == val; }
     inline constexpr bool cond_B(bool val = true) const { return this->cond_C(val); }
     inline constexpr bool cond_NAE(bool val = true) const { return this->cond_C(val); }
-    inline constexpr bool cond_NC(bool val = true) const { return this->carry != val; }
+    inline constexpr bool cond_NC(bool val = true) const { return this->get_carry() != val; }
     inline constexpr bool cond_NB(bool val = true) const { return this->cond_NC(val); }
     inline constexpr bool cond_AE(bool val = true) const { return this->cond_NC(val); }
-    inline constexpr bool cond_Z(bool val = true) const { return this->zero == val; }
+    inline constexpr bool cond_Z(bool val = true) const { return this->get_zero() == val; }
     inline constexpr bool cond_E(bool val = true) const { return this->cond_Z(val); }
-    inline constexpr bool cond_NZ(bool val = true) const { return this->zero != val; }
+    inline constexpr bool cond_NZ(bool val = true) const { return this->get_zero() != val; }
     inline constexpr bool cond_NE(bool val = true) const { return this->cond_NZ(val); }
-    inline constexpr bool cond_BE(bool val = true) const { return (this->carry | this->zero) == val; }
+    inline constexpr bool cond_BE(bool val = true) const { return (this->get_carry() | this->get_zero()) == val; }
     inline constexpr bool cond_NA(bool val = true) const { return this->cond_BE(val); }
-    inline constexpr bool cond_A(bool val = true) const { return (this->carry | this->zero) != val; }
+    inline constexpr bool cond_A(bool val = true) const { return (this->get_carry() | this->get_zero()) != val; }
     inline constexpr bool cond_NBE(bool val = true) const { return this->cond_A(val); }
-    inline constexpr bool cond_S(bool val = true) const { return this->sign == val; }
-    inline constexpr bool cond_NS(bool val = true) const { return this->sign != val; }
-    inline constexpr bool cond_P(bool val = true) const { return this->parity == val; }
+    inline constexpr bool cond_S(bool val = true) const { return this->get_sign() == val; }
+    inline constexpr bool cond_NS(bool val = true) const { return this->get_sign() != val; }
+    inline constexpr bool cond_P(bool val = true) const { return this->get_parity() == val; }
     inline constexpr bool cond_PE(bool val = true) const { return this->cond_P(val); }
-    inline constexpr bool cond_NP(bool val = true) const { return this->parity != val; }
+    inline constexpr bool cond_NP(bool val = true) const { return this->get_parity() != val; }
     inline constexpr bool cond_PO(bool val = true) const { return this->cond_NP(val); }
-    inline constexpr bool cond_L(bool val = true) const { return (this->sign ^ this->overflow) == val; }
+    inline constexpr bool cond_L(bool val = true) const { return (this->get_sign() ^ this->get_overflow()) == val; }
     inline constexpr bool cond_NGE(bool val = true) const { return this->cond_L(val); }
-    inline constexpr bool cond_GE(bool val = true) const { return (this->sign ^ this->overflow) != val; }
+    inline constexpr bool cond_GE(bool val = true) const { return (this->get_sign() ^ this->get_overflow()) != val; }
     inline constexpr bool cond_NL(bool val = true) const { return this->cond_GE(val); }
-    inline constexpr bool cond_LE(bool val = true) const { return (this->zero | (this->sign ^ this->overflow)) == val; }
+    inline constexpr bool cond_LE(bool val = true) const { return (this->get_zero() | (this->get_sign() ^ this->get_overflow())) == val; }
     inline constexpr bool cond_NG(bool val = true) const { return this->cond_LE(val); }
-    inline constexpr bool cond_G(bool val = true) const { return (this->zero | (this->sign ^ this->overflow)) != val; }
+    inline constexpr bool cond_G(bool val = true) const { return (this->get_zero() | (this->get_sign() ^ this->get_overflow())) != val; }
     inline constexpr bool cond_NLE(bool val = true) const { return this->cond_G(val); }
 
     template <CONDITION_CODE cc>
@@ -3683,6 +4415,9 @@ struct z86Base :
     }
 
     bool lock;
+    bool access_fault;
+    bool rep_yield; // REP run stopped with iterations left
+    size_t rep_limit; // Iterations a REP run may take before yielding
 
     int8_t seg_override;
     int8_t rep_type;
@@ -3720,7 +4455,7 @@ struct z86Base :
     }
 
     inline constexpr bool has_rep() const {
-        return this->rep_type >= NO_REP;
+        return this->rep_type > NO_REP;
     }
 
     inline constexpr bool is_repc() const {
@@ -3732,6 +4467,20 @@ struct z86Base :
         }
     }
 
+    // Whether a REPZ/REPNZ/REPC/REPNC compare run goes on
+    inline constexpr bool rep_condition() const {
+        if (this->is_repc()) {
+            return this->rep_type == this->get_carry() + 2;
+        }
+        return this->rep_type == this->get_zero();
+    }
+
+    // Iterations of count the current REP run may take
+    template <typename P>
+    inline constexpr P rep_chunk(P count) const {
+        return count > this->rep_limit ? (P)this->rep_limit : count;
+    }
+
     inline constexpr void set_seg_override(uint8_t seg) {
         this->seg_override = seg;
         if constexpr (LONG_MODE) {
@@ -3795,6 +4544,85 @@ struct z86Base :
         return this->bp;
     }
 
+    // Whether count elements of T starting at offset stay clear
+    // of the segment wrap, proving it once for a whole string instruction
+    template <typename T, typename P>
+    static inline constexpr bool run_fits(P offset, P count, intptr_t step) {
+        constexpr uint64_t end = (uint64_t)(std::numeric_limits<P>::max)() + 1;
+        uint64_t span = (uint64_t)count * z86DataProperites<T>::size;
+        if (step > 0) {
+            return offset + span <= end;
+        }
+        return offset + z86DataProperites<T>::size <= end && offset + z86DataProperites<T>::size >= span;
+    }
+
+    template <typename T, typename P>
+    static inline constexpr bool run_no_wrap(P offset, P count, intptr_t step) {
+        if constexpr (SINGLE_MEM_WRAPS) {
+            return run_fits<T, P>(offset, count, step);
+        }
+        return false;
+    }
+
+    // Element i in execution order of a REP run whose host memory starts at the lowest element
+    template <typename T>
+    static inline T string_element(const uint8_t* host, size_t i, size_t count, intptr_t step) {
+        T ret;
+        memcpy(&ret, &host[(step > 0 ? i : count - 1 - i) * sizeof(T)], sizeof(T));
+        return ret;
+    }
+
+    // Packed BCD helpers for ADD4S/SUB4S/CMP4S. The 64 bit forms do
+    // 16 digits at once and only agree with the byte form for valid digits.
+    static inline uint64_t bcd_invalid(uint64_t x) {
+        return ((x & 0x7777777777777777) + 0x6666666666666666) & x & 0x8888888888888888;
+    }
+
+    static inline uint64_t bcd_add(uint64_t dst, uint64_t src, bool& carry) {
+        uint64_t biased = dst + 0x6666666666666666;
+        uint64_t sum;
+        bool out = __builtin_add_overflow(biased, src, &sum);
+        out |= __builtin_add_overflow(sum, (uint64_t)carry, &sum);
+        // Digits that didn't carry out still hold the +6 bias
+        uint64_t no_carry = ~(sum ^ biased ^ src) & 0x1111111111111110;
+        carry = out;
+        return sum - ((no_carry >> 2) | (no_carry >> 3) | (out ? 0 : 0x6000000000000000));
+    }
+
+    static inline uint64_t bcd_sub(uint64_t dst, uint64_t src, bool& carry) {
+        uint64_t diff;
+        bool out = __builtin_sub_overflow(dst, src, &diff);
+        out |= __builtin_sub_overflow(diff, (uint64_t)carry, &diff);
+        // Digits that borrowed are 6 too high
+        uint64_t borrow = (diff ^ dst ^ src) & 0x1111111111111110;
+        carry = out;
+        return diff - ((borrow >> 2) | (borrow >> 3) | (out ? 0x6000000000000000 : 0));
+    }
+
+    // Works on the decimal value of each byte like the chip does,
+    // which matters for bytes that aren't valid BCD
+    template <bool is_sub>
+    static inline uint8_t bcd_byte(uint8_t dst, uint8_t src, bool& carry) {
+        uint32_t a = (dst >> 4) * 10 + (dst & 0xF);
+        uint32_t b = (src >> 4) * 10 + (src & 0xF) + carry;
+        uint32_t result;
+        if constexpr (is_sub) {
+            carry = a < b;
+            result = a + (carry ? 100 : 0) - b;
+        }
+        else {
+            result = a + b;
+            carry = result > 99;
+            result %= 100;
+        }
+        return (result / 10) << 4 | result % 10;
+    }
+
+    // Host memory for every element of a REP run, starting at the lowest one.
+    // NULL unless the run is a single span of RAM that doesn't wrap.
+    template <typename T, bool is_write, typename P, typename AT>
+    inline auto regcall string_span(const AT& addr, P count, intptr_t step);
+
     template <typename P = RT>
     inline constexpr DT str_src() const {
         return this->addr(DS, this->SI<P>());
@@ -3860,7 +4688,7 @@ struct z86Base :
         using S = std::make_signed_t<T>;
         this->update_parity(val);
         this->zero = !val;
-        this->sign = (S)val > 0;
+        this->sign = (S)val < 0;
     }
 
     template <typename T = RT>
@@ -4292,10 +5120,11 @@ struct z86Base :
     }
 
     template <CONDITION_CODE cc, bool is_byte = false, typename P>
-    inline void regcall JCC(const P& pc, bool val = true) {
+    inline bool regcall JCC(const P& pc, bool val = true) {
         if constexpr (is_byte) {
             auto new_ip = pc.offset + 1;
-            if (this->cond<cc>(val)) {
+            bool taken = this->cond<cc>(val);
+            if (taken) {
                 new_ip += pc.read<int8_t>();
             }
             if constexpr (bits > 16) {
@@ -4304,13 +5133,15 @@ struct z86Base :
                 }
             }
             this->rip = new_ip;
+            return taken;
         }
         else {
             auto new_ip = pc.offset + 2;
             if constexpr (bits > 16) {
                 new_ip += !this->data_size_16() * 2;
             }
-            if (this->cond<cc>(val)) {
+            bool taken = this->cond<cc>(val);
+            if (taken) {
                 if constexpr (bits > 16) {
                     if (!this->data_size_16()) {
                         new_ip += pc.read<int32_t>();
@@ -4326,13 +5157,15 @@ struct z86Base :
                 }
             }
             this->rip = new_ip;
+            return taken;
         }
     }
 
     template <typename T, typename P>
-    inline void regcall LOOP_impl(const P& pc, T& index) {
+    inline bool regcall LOOP_impl(const P& pc, T& index) {
         auto new_ip = pc.offset + 1;
-        if (--index) {
+        bool taken = --index;
+        if (taken) {
             new_ip += pc.read<int8_t>();
         }
         if constexpr (bits > 16) {
@@ -4341,10 +5174,11 @@ struct z86Base :
             }
         }
         this->rip = new_ip;
+        return taken;
     }
 
     template <typename P>
-    inline void regcall LOOP(const P& pc) {
+    inline bool regcall LOOP(const P& pc) {
         if constexpr (bits > 16) {
             if (this->addr_size_32()) {
                 return this->LOOP_impl(pc, this->ecx);
@@ -4359,9 +5193,10 @@ struct z86Base :
     }
 
     template <typename T, typename P>
-    inline void regcall LOOPCC_impl(const P& pc, T& index, bool val) {
+    inline bool regcall LOOPCC_impl(const P& pc, T& index, bool val) {
         auto new_ip = pc.offset + 1;
-        if (--index || this->cond_Z(val)) {
+        bool taken = --index && this->cond_Z(val);
+        if (taken) {
             new_ip += pc.read<int8_t>();
         }
         if constexpr (bits > 16) {
@@ -4370,10 +5205,11 @@ struct z86Base :
             }
         }
         this->rip = new_ip;
+        return taken;
     }
 
     template <typename P>
-    inline void regcall LOOPCC(const P& pc, bool val) {
+    inline bool regcall LOOPCC(const P& pc, bool val) {
         if constexpr (bits > 16) {
             if (this->addr_size_32()) {
                 return this->LOOPCC_impl(pc, this->ecx, val);
@@ -4388,9 +5224,10 @@ struct z86Base :
     }
 
     template <typename T, typename P>
-    inline void regcall JCXZ_impl(const P& pc, const T& index) {
+    inline bool regcall JCXZ_impl(const P& pc, const T& index) {
         auto new_ip = pc.offset + 1;
-        if (!index) {
+        bool taken = !index;
+        if (taken) {
             new_ip += pc.read<int8_t>();
         }
         if constexpr (bits > 16) {
@@ -4399,10 +5236,11 @@ struct z86Base :
             }
         }
         this->rip = new_ip;
+        return taken;
     }
 
     template <typename P>
-    inline void regcall JCXZ(const P& pc) {
+    inline bool regcall JCXZ(const P& pc) {
         if constexpr (bits > 16) {
             if (this->addr_size_32()) {
                 return this->JCXZ_impl(pc, this->ecx);
@@ -4445,6 +5283,11 @@ struct z86Base :
 
     template <typename T>
     inline void regcall ADD(T& dst, T src) {
+#if USE_LAZY_FLAGS
+        T res = dst + src;
+        this->set_lazy_flags(LazyAdd, dst, src, res);
+        dst = res;
+#else
         using U = std::make_unsigned_t<T>;
         using S = std::make_signed_t<T>;
         this->carry = add_would_overflow<U>(dst, src);
@@ -4453,6 +5296,7 @@ struct z86Base :
         this->auxiliary = (dst ^ src ^ res) & 0x10;
         dst = res;
         this->update_pzs(dst);
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4462,10 +5306,14 @@ struct z86Base :
 
     template <typename T>
     inline void regcall OR(T& dst, T src) {
+        dst |= src;
+#if USE_LAZY_FLAGS
+        this->set_lazy_logic(dst);
+#else
         this->carry = false;
         this->overflow = false;
-        dst |= src;
         this->update_pzs(dst);
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4477,11 +5325,18 @@ struct z86Base :
     inline void regcall ADC(T& dst, T src) {
         using U = std::make_unsigned_t<T>;
         using S = std::make_signed_t<T>;
+#if USE_LAZY_FLAGS
+        bool carry = this->get_carry();
+        T res = (U)dst + (U)src + carry;
+        this->set_lazy_flags(carry ? LazyAdc : LazyAdd, dst, src, res);
+        dst = res;
+#else
         T res = carry_add((U)dst, (U)src, this->carry);
         this->auxiliary = (dst ^ src ^ res) & 0x10;
         this->overflow = (S)(~(dst ^ src) & (dst ^ res)) < 0;
         dst = res;
         this->update_pzs(dst);
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4493,11 +5348,18 @@ struct z86Base :
     inline void regcall SBB(T& dst, T src) {
         using U = std::make_unsigned_t<T>;
         using S = std::make_signed_t<T>;
+#if USE_LAZY_FLAGS
+        bool carry = this->get_carry();
+        T res = (U)dst - (U)src - carry;
+        this->set_lazy_flags(carry ? LazySbb : LazySub, dst, src, res);
+        dst = res;
+#else
         T res = carry_sub<U>(dst, src, this->carry);
         this->auxiliary = (dst ^ src ^ res) & 0x10;
         this->overflow = (S)(~(dst ^ src) & (dst ^ res)) < 0;
         dst = res;
         this->update_pzs(dst);
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4507,10 +5369,14 @@ struct z86Base :
 
     template <typename T>
     inline void regcall AND(T& dst, T src) {
+        dst &= src;
+#if USE_LAZY_FLAGS
+        this->set_lazy_logic(dst);
+#else
         this->carry = false;
         this->overflow = false;
-        dst &= src;
         this->update_pzs(dst);
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4520,6 +5386,11 @@ struct z86Base :
 
     template <typename T>
     inline void regcall SUB(T& dst, T src) {
+#if USE_LAZY_FLAGS
+        T res = dst - src;
+        this->set_lazy_flags(LazySub, dst, src, res);
+        dst = res;
+#else
         using U = std::make_unsigned_t<T>;
         using S = std::make_signed_t<T>;
         this->carry = sub_would_overflow<U>(dst, src);
@@ -4528,6 +5399,7 @@ struct z86Base :
         this->auxiliary = (dst ^ src ^ res) & 0x10;
         dst = res;
         this->update_pzs(dst);
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4537,10 +5409,14 @@ struct z86Base :
 
     template <typename T>
     inline void regcall XOR(T& dst, T src) {
+        dst ^= src;
+#if USE_LAZY_FLAGS
+        this->set_lazy_logic(dst);
+#else
         this->carry = false;
         this->overflow = false;
-        dst ^= src;
         this->update_pzs(dst);
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4550,6 +5426,9 @@ struct z86Base :
 
     template <typename T>
     inline void regcall CMP(T dst, T src) {
+#if USE_LAZY_FLAGS
+        this->set_lazy_flags<T>(LazySub, dst, src, dst - src);
+#else
         using U = std::make_unsigned_t<T>;
         using S = std::make_signed_t<T>;
         this->carry = sub_would_overflow<U>(dst, src);
@@ -4557,6 +5436,7 @@ struct z86Base :
         T res = dst - src;
         this->auxiliary = (dst ^ src ^ res) & 0x10;
         this->update_pzs(res);
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4566,9 +5446,13 @@ struct z86Base :
 
     template <typename T>
     inline void regcall TEST(T dst, T src) {
+#if USE_LAZY_FLAGS
+        this->set_lazy_logic<T>(dst & src);
+#else
         this->carry = false;
         this->overflow = false;
         this->update_pzs((T)(dst & src));
+#endif
     }
 
     template <typename T1, typename T2>
@@ -4578,18 +5462,30 @@ struct z86Base :
 
     template <typename T>
     inline void regcall INC(T& dst) {
+#if USE_LAZY_FLAGS
+        this->carry = this->get_carry();
+        this->set_lazy_flags<T>(LazyInc, dst, 1, dst + 1);
+        ++dst;
+#else
         using S = std::make_signed_t<T>;
         this->overflow = dst == (std::numeric_limits<S>::max)();
         this->auxiliary = (dst ^ 1 ^ dst + 1) & 0x10; // BLCMSK
         this->update_pzs(++dst);
+#endif
     }
 
     template <typename T>
     inline void regcall DEC(T& dst) {
+#if USE_LAZY_FLAGS
+        this->carry = this->get_carry();
+        this->set_lazy_flags<T>(LazyDec, dst, 1, dst - 1);
+        --dst;
+#else
         using S = std::make_signed_t<T>;
-        this->overflow = dst == (std::numeric_limits<S>::max)();
+        this->overflow = dst == (std::numeric_limits<S>::min)();
         this->auxiliary = (dst ^ 1 ^ dst - 1) & 0x10; // BLSMSK
         this->update_pzs(--dst);
+#endif
     }
 
     template <typename T>
@@ -4599,12 +5495,17 @@ struct z86Base :
 
     template <typename T>
     inline void regcall NEG(T& dst) {
+#if USE_LAZY_FLAGS
+        this->set_lazy_flags<T>(LazySub, 0, dst, -dst);
+        dst = -dst;
+#else
         using S = std::make_signed_t<T>;
         this->carry = dst;
         this->overflow = (S)dst == (std::numeric_limits<S>::min)();
         this->auxiliary = dst & 0xF;
         dst = -dst;
         this->update_pzs(dst);
+#endif
     }
 
     template <typename T>
@@ -4652,6 +5553,7 @@ struct z86Base :
 
     template <typename T, typename R = std::make_unsigned_t<dbl_int_t<T>>>
     inline R MUL_impl(T lhs, T rhs) {
+        this->resolve_flags();
         using U = std::make_unsigned_t<T>;
 
         R ret = lhs;
@@ -4693,6 +5595,7 @@ struct z86Base :
 
     template <typename T, typename R = std::make_signed_t<dbl_int_t<T>>>
     inline R IMUL_impl(T lhs, T rhs) {
+        this->resolve_flags();
         using U = std::make_unsigned_t<T>;
         using S = std::make_signed_t<T>;
 
@@ -4817,7 +5720,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall ROL(T& dst, uint8_t count) {
-
+        this->resolve_flags();
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint64_t)) {
                 count &= 0x1F;
@@ -4839,7 +5742,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall ROR(T& dst, uint8_t count) {
-
+        this->resolve_flags();
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint64_t)) {
                 count &= 0x1F;
@@ -4861,7 +5764,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall RCL(T& dst, uint8_t count) {
-
+        this->resolve_flags();
         constexpr size_t total_bits = bitsof(T) + 1;
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint32_t)) {
@@ -4896,7 +5799,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall RCR(T& dst, uint8_t count) {
-
+        this->resolve_flags();
         constexpr size_t total_bits = bitsof(T) + 1;
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint32_t)) {
@@ -4931,6 +5834,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall SHL(T& dst, uint8_t count) {
+        this->resolve_flags();
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint64_t)) {
                 count &= 0x1F;
@@ -4951,6 +5855,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall SHR(T& dst, uint8_t count) {
+        this->resolve_flags();
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint64_t)) {
                 count &= 0x1F;
@@ -4992,6 +5897,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall SAR(T& dst, uint8_t count) {
+        this->resolve_flags();
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint64_t)) {
                 count &= 0x1F;
@@ -5010,6 +5916,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall SHLD(T& dst, T src, uint8_t count) {
+        this->resolve_flags();
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint64_t)) {
                 count &= 0x1F;
@@ -5033,6 +5940,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall SHRD(T& dst, T src, uint8_t count) {
+        this->resolve_flags();
         if constexpr (SHIFT_MASKING) {
             if constexpr (sizeof(T) < sizeof(uint64_t)) {
                 count &= 0x1F;
@@ -5056,6 +5964,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall BT(T dst, T src) {
+        this->resolve_flags();
         assume(src < bitsof(T));
         using U = std::make_unsigned_t<T>;
 
@@ -5065,6 +5974,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall BTS(T& dst, T src) {
+        this->resolve_flags();
         assume(src < bitsof(T));
         using U = std::make_unsigned_t<T>;
 
@@ -5074,6 +5984,7 @@ struct z86Base :
     }
     template <typename T>
     inline void regcall BTR(T& dst, T src) {
+        this->resolve_flags();
         assume(src < bitsof(T));
         using U = std::make_unsigned_t<T>;
 
@@ -5084,6 +5995,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall BTC(T& dst, T src) {
+        this->resolve_flags();
         assume(src < bitsof(T));
         using U = std::make_unsigned_t<T>;
 
@@ -5094,6 +6006,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall BSF(T& dst, T src) {
+        this->resolve_flags();
         if (!(this->zero = !src)) {
             for (size_t i = 0; i < bitsof(T); ++i) {
                 if (src >> i & 1) {
@@ -5106,6 +6019,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall BSR(T& dst, T src) {
+        this->resolve_flags();
         if (!(this->zero = !src)) {
             size_t i = bitsof(T) - 1;
             do {
@@ -5119,6 +6033,7 @@ struct z86Base :
 
     template <typename T>
     inline void regcall TEST1(T dst, uint8_t count) {
+        this->resolve_flags();
         if constexpr (sizeof(T) == sizeof(uint8_t)) {
             count &= 0x7;
         }
@@ -5133,7 +6048,7 @@ struct z86Base :
         }
         using U = std::make_unsigned_t<T>;
 
-        this->zero = dst & (U)1 << count;
+        this->zero = !(dst & (U)1 << count);
         // Some docs say carry/overflow are set to 0
         this->carry = this->overflow = false;
     }
@@ -5484,23 +6399,42 @@ struct z86Base :
         }
     }
 
-    template <typename P>
-    inline bool regcall ADD4S_impl();
+    template <bool is_sub, bool is_cmp, typename P>
+    inline bool regcall BCD4S_impl();
 
-    inline bool regcall ADD4S() {
+    template <bool is_sub, bool is_cmp>
+    inline bool regcall BCD4S() {
         if constexpr (bits > 16) {
             if (this->addr_size_32()) {
-                return this->ADD4S_impl<uint32_t>();
+                return this->BCD4S_impl<is_sub, is_cmp, uint32_t>();
             }
             if constexpr (bits == 64) {
                 if (this->addr_size_64()) {
-                    return this->ADD4S_impl<uint64_t>();
+                    return this->BCD4S_impl<is_sub, is_cmp, uint64_t>();
                 }
             }
         }
-        return this->ADD4S_impl<uint16_t>();
+        return this->BCD4S_impl<is_sub, is_cmp, uint16_t>();
+    }
+
+    inline bool regcall ADD4S() {
+        return this->BCD4S<false, false>();
+    }
+
+    inline bool regcall SUB4S() {
+        return this->BCD4S<true, false>();
     }
 
+    inline bool regcall CMP4S() {
+        return this->BCD4S<true, true>();
+    }
+
+    // Bit field ops take the field at the offset register's bit
+    // of DS:SI/ES:DI, length + 1 bits wide. The offset then moves
+    // past the field, stepping SI/DI a word when it wraps.
+    inline bool regcall EXT_BITS(uint8_t& offset, uint8_t length);
+    inline bool regcall INS_BITS(uint8_t& offset, uint8_t length);
+
     template <typename T>
     inline void regcall port_out_impl(uint16_t port, T value) const;
 
@@ -5791,6 +6725,7 @@ struct z86Base :
 
     // TODO: Read microcode dump to confirm accurate behavior of BCD, there's reason to doubt official docs here
     inline void regcall AAA() {
+        this->resolve_flags();
         if (this->auxiliary || (this->al & 0xF) > 9) {
             this->auxiliary = this->carry = true;
             if constexpr (!OLD_AAA) {
@@ -5806,6 +6741,7 @@ struct z86Base :
     }
 
     inline void regcall AAS() {
+        this->resolve_flags();
         if (this->auxiliary || (this->al & 0xF) > 9) {
             this->auxiliary = this->carry = true;
             this->ax -= 0x106; // Was this different on 8086 too?
@@ -5817,33 +6753,36 @@ struct z86Base :
 
     // Supposedly better implementation than official docs: https://www.righto.com/2023/01/understanding-x86s-decimal-adjust-after.html
     inline void regcall DAA() {
+        this->resolve_flags();
         uint8_t temp = this->al;
         if (this->auxiliary || (temp & 0xF) > 9) {
             this->auxiliary = true;
-            this->al -= 0x06;
+            this->al += 0x06;
         }
         if (this->carry || temp > 0x99) {
             this->carry = true;
-            this->al -= 0x60;
+            this->al += 0x60;
         }
         this->update_pzs(this->al);
     }
 
     inline void regcall DAS() {
+        this->resolve_flags();
         uint8_t temp = this->al;
         if (this->auxiliary || (temp & 0xF) > 9) {
             this->auxiliary = true;
-            this->al += 0x06;
+            this->al -= 0x06;
         }
         if (this->carry || temp > 0x99) {
             this->carry = true;
-            this->al += 0x60;
+            this->al -= 0x60;
         }
         this->update_pzs(this->al);
     }
 
     // Note: NEC only handles default imm of 10
     inline bool regcall AAM(uint8_t imm) {
+        this->resolve_flags();
         if (imm) {
             this->ah = this->al / imm;
             this->al %= imm;
@@ -5863,6 +6802,7 @@ struct z86Base :
     }
 
     inline void regcall AAD(uint8_t imm) {
+        this->resolve_flags();
         uint8_t temp = this->al + this->ah * imm;
         this->ax = temp;
         this->update_pzs(temp);
@@ -6177,6 +7117,53 @@ struct z86Base :
         return !FAULTS_ARE_TRAPS;
     }
 
+    // Memory accessors have no way to return a fault, so the
+    // dispatch loop abandons the instruction once this is set
+    inline void regcall set_access_fault(uint8_t index) {
+        if (!this->access_fault) {
+            this->access_fault = true;
+            this->set_fault(index == SS ? IntSS : IntGP);
+        }
+    }
+
+    // Selector outside its descriptor table
+    inline void regcall set_selector_fault() {
+        if (!this->access_fault) {
+            this->access_fault = true;
+            this->set_fault(IntGP);
+        }
+    }
+
+    inline void regcall set_page_fault(size_t addr) {
+        if (!this->access_fault) {
+            this->access_fault = true;
+            this->cr2 = addr;
+            this->set_fault(IntPF);
+        }
+    }
+
+    // Lets multi-access helpers stop at the first fault
+    inline constexpr bool access_faulted() const {
+        if constexpr (PROTECTED_MODE) {
+            return expect(this->access_fault, false);
+        }
+        return false;
+    }
+
+    // Linear address accesses once paging is on.
+    // page_entry returns NULL after raising #PF.
+    template <bool is_write>
+    inline bool regcall page_walk(size_t addr, z86PageTlb::Entry& entry);
+
+    template <bool is_write>
+    inline z86PageTlb::Entry* regcall page_entry(size_t addr);
+
+    template <typename T>
+    inline T regcall paged_read(size_t addr);
+
+    template <typename T>
+    inline void regcall paged_write(size_t addr, const T& value);
+
     inline void regcall set_trap(uint8_t number) {
         return this->software_interrupt(number);
     }
@@ -6551,14 +7538,18 @@ struct z86Core<z8086, flagsA> :
     z86Base<
         16, 16, flagsA |
         FLAG_PUSH_CS | FLAG_SAL_IS_SETMO | FLAG_REP_INVERT_MUL | FLAG_REP_INVERT_IDIV | FLAG_FAULTS_ARE_TRAPS | FLAG_NO_UD | FLAG_SINGLE_MEM_WRAPS | FLAG_UNMASK_SHIFTS | FLAG_OLD_PUSH_SP | FLAG_OLD_RESET_PC | FLAG_OLD_AAA | FLAG_WRAP_SEGMENT_MODRM
-    > {};
+    > {
+    static inline constexpr z86CoreType model = z8086;
+};
 
 template <uint64_t flagsA>
 struct z86Core<z80186, flagsA> :
     z86Base<16, 16, flagsA |
         FLAG_REP_INVERT_IDIV | FLAG_SINGLE_MEM_WRAPS | FLAG_UNMASK_SHIFTS | FLAG_OLD_PUSH_SP | FLAG_OLD_RESET_PC | FLAG_OLD_AAA | FLAG_AAM_NO_DE | FLAG_UNMASK_ENTER | FLAG_REP_BOUND | FLAG_REP_MUL_MISSTORE |
         FLAG_OPCODES_80186
-    > {};
+    > {
+    static inline constexpr z86CoreType model = z80186;
+};
 
 // Software exceptions
 // Trap flag
@@ -6572,7 +7563,9 @@ struct z86Core<z80286, flagsA> :
         16, 16, flagsA |
         FLAG_PROTECTED_MODE |
         FLAG_OPCODES_80186 | FLAG_OPCODES_80286
-    > {};
+    > {
+    static inline constexpr z86CoreType model = z80286;
+};
 
 template <uint64_t flagsA>
 struct z86Core<zNV30, flagsA> :
@@ -6580,14 +7573,18 @@ struct z86Core<zNV30, flagsA> :
         16, 16, flagsA |
         FLAG_UNMASK_SHIFTS | FLAG_OLD_PUSH_SP | FLAG_OLD_RESET_PC | FLAG_UNMASK_ENTER |
         FLAG_OPCODES_80186 | FLAG_OPCODES_80286 | FLAG_OPCODES_V20
-    > {};
+    > {
+    static inline constexpr z86CoreType model = zNV30;
+};
 
 template <uint64_t flagsA>
 struct z86Core<z80386, flagsA> :
     z86Base<
         32, 32, flagsA |
-        FLAG_PROTECTED_MODE |
+        FLAG_PROTECTED_MODE | FLAG_PAGING |
         FLAG_OPCODES_80186 | FLAG_OPCODES_80286 | FLAG_OPCODES_80386
-    > {};
+    > {
+    static inline constexpr z86CoreType model = z80386;
+};
 
 #endif
\ No newline at end of file
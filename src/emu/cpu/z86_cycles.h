@@ -0,0 +1,351 @@
+#pragma once
+
+#ifndef Z86_CYCLES_H
+#define Z86_CYCLES_H 1
+
+#include <stdint.h>
+
+#include "z86_core_internal_pre.h"
+
+// Clock counts per instruction, taken from the Intel 8086/80286
+// and NEC V20/V30 user manuals. Where a count depends on operands
+// (taken branches, REP counts, MUL/DIV, shift counts) the variable
+// part is charged separately by the execute loop. Data dependent
+// MUL/DIV timings use the midpoint of the documented range and the
+// 8086 odd address word access penalty isn't modeled.
+struct z86CycleTable {
+    uint8_t reg[256]; // Register or no operand form
+    uint8_t mem[256]; // Memory operand form, excluding EA calculation
+    uint8_t rep[256]; // Per iteration cost of REP string ops
+    uint8_t ea[3][8]; // EA calculation by mod/rm
+    uint8_t grp3[2][8]; // F6/F7 by reg field, byte then word
+    uint8_t shift_count; // Per bit cost of shifts by CL/Ib
+    uint8_t rep_base; // Setup cost of a REP string op
+    uint8_t prefix; // Any prefix byte, including 0F
+    uint8_t branch_taken; // Added to Jcc/LOOP/JCXZ when taken
+    uint8_t interrupt; // Any interrupt, including INT n
+    uint8_t extended; // Any 0F xx opcode
+    uint8_t bcd_string; // Per byte cost of ADD4S/SUB4S/CMP4S
+};
+
+namespace z86CyclesImpl {
+    static inline constexpr void set(z86CycleTable& table, uint8_t first, uint8_t last, uint8_t reg, uint8_t mem = 0) {
+        for (size_t i = first; i <= last; ++i) {
+            table.reg[i] = reg;
+            table.mem[i] = mem ? mem : reg;
+        }
+    }
+
+    static inline constexpr void set_alu(z86CycleTable& table, uint8_t rr, uint8_t mr, uint8_t rm, uint8_t ai, uint8_t cmp_mr) {
+        for (size_t op = 0x00; op <= 0x38; op += 8) {
+            set(table, op, op + 1, rr, op == 0x38 ? cmp_mr : mr);
+            set(table, op + 2, op + 3, rr, rm);
+            set(table, op + 4, op + 5, ai);
+        }
+    }
+
+    static inline constexpr void set_string(z86CycleTable& table, uint8_t first, uint8_t single, uint8_t per_rep) {
+        set(table, first, first + 1, single);
+        table.rep[first] = table.rep[first + 1] = per_rep;
+    }
+
+    static inline constexpr z86CycleTable make_8086() {
+        z86CycleTable table = {};
+        set_alu(table, 3, 16, 9, 4, 9);
+        set(table, 0x06, 0x06, 10); set(table, 0x0E, 0x0E, 10); set(table, 0x16, 0x16, 10); set(table, 0x1E, 0x1E, 10); // PUSH seg
+        set(table, 0x07, 0x07, 8); set(table, 0x0F, 0x0F, 8); set(table, 0x17, 0x17, 8); set(table, 0x1F, 0x1F, 8); // POP seg
+        set(table, 0x26, 0x26, 2); set(table, 0x2E, 0x2E, 2); set(table, 0x36, 0x36, 2); set(table, 0x3E, 0x3E, 2); // SEG:
+        set(table, 0x27, 0x27, 4); set(table, 0x2F, 0x2F, 4); set(table, 0x37, 0x37, 4); set(table, 0x3F, 0x3F, 4); // DAA, DAS, AAA, AAS
+        set(table, 0x40, 0x4F, 2); // INC/DEC reg
+        set(table, 0x50, 0x57, 11); // PUSH reg
+        set(table, 0x58, 0x5F, 8); // POP reg
+        set(table, 0x60, 0x7F, 4); // Jcc
+        set(table, 0x80, 0x83, 4, 17); // GRP1
+        set(table, 0x84, 0x85, 3, 9); // TEST
+        set(table, 0x86, 0x87, 4, 17); // XCHG
+        set(table, 0x88, 0x89, 2, 9); // MOV M, R
+        set(table, 0x8A, 0x8B, 2, 8); // MOV R, M
+        set(table, 0x8C, 0x8C, 2, 9); // MOV M, seg
+        set(table, 0x8D, 0x8D, 2); // LEA
+        set(table, 0x8E, 0x8E, 2, 8); // MOV seg, M
+        set(table, 0x8F, 0x8F, 8, 17); // POP M
+        set(table, 0x90, 0x97, 3); // XCHG AX, reg
+        set(table, 0x98, 0x98, 2); // CBW
+        set(table, 0x99, 0x99, 5); // CWD
+        set(table, 0x9A, 0x9A, 28); // CALL far
+        set(table, 0x9B, 0x9B, 4); // WAIT
+        set(table, 0x9C, 0x9C, 10); // PUSHF
+        set(table, 0x9D, 0x9D, 8); // POPF
+        set(table, 0x9E, 0x9F, 4); // SAHF, LAHF
+        set(table, 0xA0, 0xA3, 10); // MOV A, O
+        set_string(table, 0xA4, 18, 17); // MOVS
+        set_string(table, 0xA6, 22, 22); // CMPS
+        set(table, 0xA8, 0xA9, 4); // TEST A, I
+        set_string(table, 0xAA, 11, 10); // STOS
+        set_string(table, 0xAC, 12, 13); // LODS
+        set_string(table, 0xAE, 15, 15); // SCAS
+        set(table, 0xB0, 0xBF, 4); // MOV reg, I
+        set(table, 0xC0, 0xC0, 12); set(table, 0xC2, 0xC2, 12); // RET Iw
+        set(table, 0xC1, 0xC1, 8); set(table, 0xC3, 0xC3, 8); // RET
+        set(table, 0xC4, 0xC5, 16); // LES, LDS
+        set(table, 0xC6, 0xC7, 4, 10); // MOV M, I
+        set(table, 0xC8, 0xC8, 17); set(table, 0xCA, 0xCA, 17); // RETF Iw
+        set(table, 0xC9, 0xC9, 18); set(table, 0xCB, 0xCB, 18); // RETF
+        set(table, 0xCC, 0xCD, 0); // INT3, INT Ib
+        set(table, 0xCE, 0xCE, 4); // INTO
+        set(table, 0xCF, 0xCF, 24); // IRET
+        set(table, 0xD0, 0xD1, 2, 15); // GRP2 M, 1
+        set(table, 0xD2, 0xD3, 8, 20); // GRP2 M, CL
+        set(table, 0xD4, 0xD4, 83); // AAM
+        set(table, 0xD5, 0xD5, 60); // AAD
+        set(table, 0xD6, 0xD6, 4); // SALC
+        set(table, 0xD7, 0xD7, 11); // XLAT
+        set(table, 0xD8, 0xDF, 2, 8); // ESC
+        set(table, 0xE0, 0xE0, 5); // LOOPNZ
+        set(table, 0xE1, 0xE1, 6); // LOOPZ
+        set(table, 0xE2, 0xE2, 5); // LOOP
+        set(table, 0xE3, 0xE3, 6); // JCXZ
+        set(table, 0xE4, 0xE7, 10); // IN/OUT Ib
+        set(table, 0xE8, 0xE8, 19); // CALL near
+        set(table, 0xE9, 0xEB, 15); // JMP
+        set(table, 0xEC, 0xEF, 8); // IN/OUT DX
+        set(table, 0xF0, 0xF3, 2); // LOCK, REP
+        set(table, 0xF4, 0xF5, 2); // HLT, CMC
+        set(table, 0xF6, 0xF7, 0, 6); // GRP3, the rest is in grp3
+        set(table, 0xF8, 0xFD, 2); // Flag ops
+        set(table, 0xFE, 0xFF, 3, 15); // GRP4, GRP5
+        constexpr uint8_t ea[3][8] = {
+            { 7, 8, 8, 7, 5, 5, 6, 5 },
+            { 11, 12, 12, 11, 9, 9, 9, 9 },
+            { 11, 12, 12, 11, 9, 9, 9, 9 }
+        };
+        constexpr uint8_t grp3[2][8] = {
+            { 5, 5, 3, 3, 77, 89, 85, 107 },
+            { 5, 5, 3, 3, 128, 141, 153, 175 }
+        };
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 8; ++j) {
+                table.ea[i][j] = ea[i][j];
+            }
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            for (size_t j = 0; j < 8; ++j) {
+                table.grp3[i][j] = grp3[i][j];
+            }
+        }
+        table.shift_count = 4;
+        table.rep_base = 9;
+        table.prefix = 2;
+        table.branch_taken = 12;
+        table.interrupt = 51;
+        table.extended = 0;
+        return table;
+    }
+
+    // The V30 computes EAs in dedicated hardware, so the memory
+    // forms have a flat cost instead of a per mode one.
+    static inline constexpr z86CycleTable make_V30() {
+        z86CycleTable table = make_8086();
+        set_alu(table, 2, 16, 11, 4, 11);
+        set(table, 0x06, 0x06, 9); set(table, 0x0E, 0x0E, 9); set(table, 0x16, 0x16, 9); set(table, 0x1E, 0x1E, 9); // PUSH seg
+        set(table, 0x07, 0x07, 8); set(table, 0x17, 0x17, 8); set(table, 0x1F, 0x1F, 8); // POP seg
+        set(table, 0x0F, 0x0F, 2); // Extended opcode map
+        set(table, 0x27, 0x27, 3); set(table, 0x2F, 0x2F, 7); set(table, 0x37, 0x37, 3); set(table, 0x3F, 0x3F, 7); // DAA, DAS, AAA, AAS
+        set(table, 0x50, 0x57, 8); // PUSH reg
+        set(table, 0x58, 0x5F, 8); // POP reg
+        set(table, 0x60, 0x60, 35); // PUSHA
+        set(table, 0x61, 0x61, 43); // POPA
+        set(table, 0x62, 0x62, 18); // BOUND
+        set(table, 0x63, 0x67, 2); // Undefined
+        set(table, 0x68, 0x68, 8); // PUSH Is
+        set(table, 0x69, 0x69, 38, 40); // IMUL Rv, Mv, Is
+        set(table, 0x6A, 0x6A, 7); // PUSH Ib
+        set(table, 0x6B, 0x6B, 31, 33); // IMUL Rv, Mv, Ib
+        set_string(table, 0x6C, 10, 9); // INS
+        set_string(table, 0x6E, 10, 9); // OUTS
+        set(table, 0x70, 0x7F, 4); // Jcc
+        set(table, 0x80, 0x83, 4, 18); // GRP1
+        set(table, 0x84, 0x85, 2, 10); // TEST
+        set(table, 0x86, 0x87, 3, 16); // XCHG
+        set(table, 0x88, 0x89, 2, 9); // MOV M, R
+        set(table, 0x8A, 0x8B, 2, 11); // MOV R, M
+        set(table, 0x8C, 0x8C, 2, 10); // MOV M, seg
+        set(table, 0x8D, 0x8D, 4); // LEA
+        set(table, 0x8E, 0x8E, 2, 11); // MOV seg, M
+        set(table, 0x8F, 0x8F, 8, 17); // POP M
+        set(table, 0x90, 0x97, 3); // XCHG AX, reg
+        set(table, 0x98, 0x98, 2); // CBW
+        set(table, 0x99, 0x99, 4); // CWD
+        set(table, 0x9A, 0x9A, 29); // CALL far
+        set(table, 0x9C, 0x9C, 8); // PUSHF
+        set(table, 0x9D, 0x9D, 8); // POPF
+        set(table, 0x9E, 0x9F, 2); // SAHF, LAHF
+        set_string(table, 0xA4, 11, 8); // MOVS
+        set_string(table, 0xA6, 14, 14); // CMPS
+        set_string(table, 0xAA, 7, 4); // STOS
+        set_string(table, 0xAC, 7, 9); // LODS
+        set_string(table, 0xAE, 10, 10); // SCAS
+        set(table, 0xC0, 0xC1, 7, 19); // GRP2 M, Ib
+        set(table, 0xC2, 0xC2, 20); // RET Iw
+        set(table, 0xC3, 0xC3, 15); // RET
+        set(table, 0xC4, 0xC5, 18); // LES, LDS
+        set(table, 0xC6, 0xC7, 4, 11); // MOV M, I
+        set(table, 0xC8, 0xC8, 16); // ENTER
+        set(table, 0xC9, 0xC9, 6); // LEAVE
+        set(table, 0xCA, 0xCA, 24); // RETF Iw
+        set(table, 0xCB, 0xCB, 21); // RETF
+        set(table, 0xCE, 0xCE, 3); // INTO
+        set(table, 0xCF, 0xCF, 27); // IRET
+        set(table, 0xD0, 0xD1, 2, 16); // GRP2 M, 1
+        set(table, 0xD2, 0xD3, 7, 19); // GRP2 M, CL
+        set(table, 0xD4, 0xD4, 15); // AAM
+        set(table, 0xD5, 0xD5, 7); // AAD
+        set(table, 0xD7, 0xD7, 9); // XLAT
+        set(table, 0xE0, 0xE0, 5); // LOOPNZ
+        set(table, 0xE1, 0xE1, 5); // LOOPZ
+        set(table, 0xE2, 0xE2, 5); // LOOP
+        set(table, 0xE3, 0xE3, 5); // JCXZ
+        set(table, 0xE4, 0xE7, 9); // IN/OUT Ib
+        set(table, 0xE8, 0xE8, 16); // CALL near
+        set(table, 0xE9, 0xE9, 13); // JMP near
+        set(table, 0xEA, 0xEA, 15); // JMP far
+        set(table, 0xEB, 0xEB, 12); // JMP short
+        set(table, 0xEC, 0xEF, 8); // IN/OUT DX
+        set(table, 0xFE, 0xFF, 2, 16); // GRP4, GRP5
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 8; ++j) {
+                table.ea[i][j] = 0;
+            }
+        }
+        constexpr uint8_t grp3[2][8] = {
+            { 4, 4, 2, 2, 22, 36, 15, 31 },
+            { 4, 4, 2, 2, 30, 44, 23, 41 }
+        };
+        for (size_t i = 0; i < 2; ++i) {
+            for (size_t j = 0; j < 8; ++j) {
+                table.grp3[i][j] = grp3[i][j];
+            }
+        }
+        table.shift_count = 1;
+        table.rep_base = 9;
+        table.prefix = 2;
+        table.branch_taken = 10;
+        table.interrupt = 50;
+        table.extended = 12;
+        table.bcd_string = 19;
+        return table;
+    }
+
+    // The 80286 only has an extra clock for base+index+displacement
+    static inline constexpr z86CycleTable make_80286() {
+        z86CycleTable table = make_V30();
+        set_alu(table, 2, 7, 7, 3, 6);
+        set(table, 0x06, 0x06, 3); set(table, 0x0E, 0x0E, 3); set(table, 0x16, 0x16, 3); set(table, 0x1E, 0x1E, 3); // PUSH seg
+        set(table, 0x07, 0x07, 5); set(table, 0x17, 0x17, 5); set(table, 0x1F, 0x1F, 5); // POP seg
+        set(table, 0x0F, 0x0F, 0); // Extended opcode map
+        set(table, 0x26, 0x26, 0); set(table, 0x2E, 0x2E, 0); set(table, 0x36, 0x36, 0); set(table, 0x3E, 0x3E, 0); // SEG:
+        set(table, 0x27, 0x27, 3); set(table, 0x2F, 0x2F, 3); set(table, 0x37, 0x37, 3); set(table, 0x3F, 0x3F, 3); // DAA, DAS, AAA, AAS
+        set(table, 0x40, 0x4F, 2); // INC/DEC reg
+        set(table, 0x50, 0x57, 3); // PUSH reg
+        set(table, 0x58, 0x5F, 5); // POP reg
+        set(table, 0x60, 0x60, 17); // PUSHA
+        set(table, 0x61, 0x61, 19); // POPA
+        set(table, 0x62, 0x62, 13); // BOUND
+        set(table, 0x68, 0x68, 3); // PUSH Is
+        set(table, 0x69, 0x69, 21, 24); // IMUL Rv, Mv, Is
+        set(table, 0x6A, 0x6A, 3); // PUSH Ib
+        set(table, 0x6B, 0x6B, 21, 24); // IMUL Rv, Mv, Ib
+        set_string(table, 0x6C, 5, 4); // INS
+        set_string(table, 0x6E, 5, 4); // OUTS
+        set(table, 0x70, 0x7F, 3); // Jcc
+        set(table, 0x80, 0x83, 3, 7); // GRP1
+        set(table, 0x84, 0x85, 2, 6); // TEST
+        set(table, 0x86, 0x87, 3, 5); // XCHG
+        set(table, 0x88, 0x89, 2, 3); // MOV M, R
+        set(table, 0x8A, 0x8B, 2, 5); // MOV R, M
+        set(table, 0x8C, 0x8C, 2, 3); // MOV M, seg
+        set(table, 0x8D, 0x8D, 3); // LEA
+        set(table, 0x8E, 0x8E, 2, 5); // MOV seg, M
+        set(table, 0x8F, 0x8F, 5); // POP M
+        set(table, 0x90, 0x97, 3); // XCHG AX, reg
+        set(table, 0x98, 0x99, 2); // CBW, CWD
+        set(table, 0x9A, 0x9A, 13); // CALL far
+        set(table, 0x9B, 0x9B, 3); // WAIT
+        set(table, 0x9C, 0x9C, 3); // PUSHF
+        set(table, 0x9D, 0x9D, 5); // POPF
+        set(table, 0x9E, 0x9F, 2); // SAHF, LAHF
+        set(table, 0xA0, 0xA3, 5); // MOV A, O
+        set_string(table, 0xA4, 5, 4); // MOVS
+        set_string(table, 0xA6, 8, 9); // CMPS
+        set(table, 0xA8, 0xA9, 3); // TEST A, I
+        set_string(table, 0xAA, 3, 3); // STOS
+        set_string(table, 0xAC, 5, 4); // LODS
+        set_string(table, 0xAE, 7, 8); // SCAS
+        set(table, 0xB0, 0xBF, 2); // MOV reg, I
+        set(table, 0xC0, 0xC1, 5, 8); // GRP2 M, Ib
+        set(table, 0xC2, 0xC3, 11); // RET
+        set(table, 0xC4, 0xC5, 7); // LES, LDS
+        set(table, 0xC6, 0xC7, 2, 3); // MOV M, I
+        set(table, 0xC8, 0xC8, 11); // ENTER
+        set(table, 0xC9, 0xC9, 5); // LEAVE
+        set(table, 0xCA, 0xCB, 15); // RETF
+        set(table, 0xCE, 0xCE, 3); // INTO
+        set(table, 0xCF, 0xCF, 17); // IRET
+        set(table, 0xD0, 0xD1, 2, 7); // GRP2 M, 1
+        set(table, 0xD2, 0xD3, 5, 8); // GRP2 M, CL
+        set(table, 0xD4, 0xD4, 16); // AAM
+        set(table, 0xD5, 0xD5, 14); // AAD
+        set(table, 0xD6, 0xD6, 3); // SALC
+        set(table, 0xD7, 0xD7, 5); // XLAT
+        set(table, 0xD8, 0xDF, 2, 2); // ESC
+        set(table, 0xE0, 0xE2, 4); // LOOPNZ, LOOPZ, LOOP
+        set(table, 0xE3, 0xE3, 4); // JCXZ
+        set(table, 0xE4, 0xE7, 5); // IN/OUT Ib
+        set(table, 0xE8, 0xE8, 7); // CALL near
+        set(table, 0xE9, 0xEB, 7); // JMP
+        set(table, 0xEC, 0xEF, 5); // IN/OUT DX
+        set(table, 0xF0, 0xF3, 0); // LOCK, REP
+        set(table, 0xF4, 0xF5, 2); // HLT, CMC
+        set(table, 0xF8, 0xFD, 2); // Flag ops
+        set(table, 0xFE, 0xFF, 2, 7); // GRP4, GRP5
+        for (size_t j = 0; j < 4; ++j) {
+            table.ea[1][j] = table.ea[2][j] = 1;
+        }
+        constexpr uint8_t grp3[2][8] = {
+            { 3, 3, 2, 2, 13, 13, 14, 17 },
+            { 3, 3, 2, 2, 21, 21, 22, 25 }
+        };
+        for (size_t i = 0; i < 2; ++i) {
+            for (size_t j = 0; j < 8; ++j) {
+                table.grp3[i][j] = grp3[i][j];
+            }
+        }
+        set(table, 0xF6, 0xF7, 0, 3); // GRP3
+        table.shift_count = 1;
+        table.rep_base = 5;
+        table.prefix = 0;
+        table.branch_taken = 4;
+        table.interrupt = 23;
+        table.extended = 10;
+        return table;
+    }
+}
+
+template <z86CoreType model>
+inline constexpr z86CycleTable z86_cycles = z86CyclesImpl::make_8086();
+
+// The 80186 is close enough to the V30 for scheduling purposes
+template <>
+inline constexpr z86CycleTable z86_cycles<z80186> = z86CyclesImpl::make_V30();
+
+template <>
+inline constexpr z86CycleTable z86_cycles<zNV30> = z86CyclesImpl::make_V30();
+
+template <>
+inline constexpr z86CycleTable z86_cycles<z80286> = z86CyclesImpl::make_80286();
+
+// No 386 table yet, the 286 counts are a closer estimate than the 8086
+template <>
+inline constexpr z86CycleTable z86_cycles<z80386> = z86CyclesImpl::make_80286();
+
+#endif
@@ -0,0 +1,694 @@
+#pragma once
+
+#ifndef Z86_JIT_H
+#define Z86_JIT_H 1
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <initializer_list>
+
+#include <sys/mman.h>
+
+#include "../zero/util.h"
+
+#if !__x86_64__ || _WIN32
+#error "The JIT only supports x86-64 POSIX hosts"
+#endif
+
+#if !USE_DECODE_CACHE || !USE_LAZY_FLAGS
+#error "USE_JIT requires USE_DECODE_CACHE and USE_LAZY_FLAGS"
+#endif
+
+// Translates hot straight line runs of instructions into x86-64
+// that operates directly on the core's register file. Effective
+// addresses are computed inline, while the data accesses call back
+// into the core's address types so MMIO, segment wrap and A20 behave
+// exactly as they do in the interpreter. A block ends after the first
+// Jcc, JMP or LOOP or before anything it can't translate, which the
+// interpreter then executes. Blocks never loop internally, so they
+// overshoot the deadline by at most one block.
+//
+// Blocks are keyed by physical address and IP and validated with the
+// same code generation as the decode cache, so writes to translated
+// code make its blocks miss. A store that rewrites the running
+// block's own code leaves the block right after the store.
+//
+// Only code in RAM or ROM is translated, and only 16-bit real mode
+// cores get a translator, the rest get the empty specialization below.
+template <typename C, typename M, size_t entries = 4096, size_t code_size = 1_MB, bool enabled = C::max_bits == 16 && !C::PROTECTED_MODE>
+struct z86Jit {
+    static_assert((entries & entries - 1) == 0);
+
+    // Returns the cycles taken, with IP left at the next instruction
+    using BlockFunc = uint32_t(*)(C* cpu, M* memory);
+    using Addr = z86AddrImpl<C::max_bits, C::PROTECTED_MODE>;
+
+    static inline constexpr uint16_t hot_threshold = 32;
+    static inline constexpr size_t max_instructions = 64;
+    // Longest host sequence emitted for a single guest instruction,
+    // including the block exits of a store or branch
+    static inline constexpr size_t max_emit_length = 256;
+    static inline constexpr size_t max_block_length = (max_instructions + 1) * max_emit_length;
+
+    struct Block {
+        uint32_t tag; // Physical address + 1, 0 when empty
+        uint32_t generation;
+        uint16_t ip;
+        uint16_t hits;
+        BlockFunc code; // NULL if not translated
+    };
+
+    // Block being translated
+    struct Translation {
+        uint8_t* out;
+        const uint8_t* code;
+        size_t length; // Guest bytes translated so far
+        size_t limit;
+        uint16_t ip; // Of the next instruction
+        uint32_t cycles; // Taken by everything translated so far
+        Block* entry;
+    };
+
+    Block block[entries];
+    uint8_t* code;
+    size_t code_used;
+
+    inline ~z86Jit() {
+        if (this->code) {
+            munmap(this->code, code_size);
+        }
+    }
+
+    inline bool init() {
+        if (this->code) {
+            munmap(this->code, code_size);
+        }
+        // Never writable and executable at once, translate
+        // flips it to writable for as long as it emits
+        void* ret = mmap(NULL, code_size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ret == MAP_FAILED) {
+            this->code = NULL;
+            return false;
+        }
+        this->code = (uint8_t*)ret;
+        this->flush();
+        return true;
+    }
+
+    inline void flush() {
+        memset(this->block, 0, sizeof(this->block));
+        this->code_used = 0;
+    }
+
+    // Runs the block at addr if it's been translated and returns
+    // true, otherwise counts towards translating it.
+    inline bool regcall execute(size_t addr, uint16_t ip, C& cpu, M& memory) {
+        Block& entry = this->block[addr & (entries - 1)];
+        if (expect(entry.tag == addr + 1 && entry.ip == ip && entry.generation == memory.code_generation(addr), true)) {
+            if (expect(entry.code != NULL, true)) {
+                cpu.clock += entry.code(&cpu, &memory);
+                return true;
+            }
+            if (entry.hits == hot_threshold || ++entry.hits != hot_threshold) {
+                return false;
+            }
+        }
+        else {
+            entry.tag = addr + 1;
+            entry.generation = memory.code_generation(addr);
+            entry.ip = ip;
+            entry.hits = 1;
+            entry.code = NULL;
+            return false;
+        }
+        if (!this->code) {
+            return false;
+        }
+        if (this->code_used + max_block_length > code_size) {
+            // Out of space, start over
+            this->flush();
+            entry.tag = addr + 1;
+            entry.ip = ip;
+            entry.hits = hot_threshold;
+        }
+        if (this->translate(entry, addr, ip, cpu, memory)) {
+            cpu.clock += entry.code(&cpu, &memory);
+            return true;
+        }
+        return false;
+    }
+
+    inline bool translate(Block& entry, size_t addr, uint16_t ip, C& cpu, M& memory) {
+        if (mprotect(this->code, code_size, PROT_READ | PROT_WRITE)) {
+            return false;
+        }
+        bool ret = this->translate_block(entry, addr, ip, cpu, memory);
+        if (mprotect(this->code, code_size, PROT_READ | PROT_EXEC)) {
+            // Nothing in the buffer can run, give up on it
+            munmap(this->code, code_size);
+            this->code = NULL;
+            this->flush();
+            return false;
+        }
+        return ret;
+    }
+
+    inline bool translate_block(Block& entry, size_t addr, uint16_t ip, C& cpu, M& memory) {
+        // Only translate bytes that are contiguous in a single page
+        // of RAM or ROM, never device memory
+        size_t limit = (std::min)(M::page_size - (addr & M::page_mask), (size_t)0x10000 - ip);
+        const uint8_t* code = memory.read_page[memory.wrap(addr) >> M::page_bits];
+        if (code) {
+            code += addr & M::page_mask;
+        }
+
+        uint8_t* start = &this->code[this->code_used];
+        Translation block = { start, code, 0, code ? limit : 0, ip, 0, &entry };
+        emit(block.out, {
+            0x53,             // PUSH RBX
+            0x41, 0x54,       // PUSH R12
+            0x41, 0x55,       // PUSH R13
+            0x48, 0x89, 0xFB, // MOV RBX, RDI
+            0x49, 0x89, 0xF4  // MOV R12, RSI
+        });
+        bool ended = false;
+        for (size_t i = 0; i < max_instructions && !ended; ++i) {
+            if (!translate_instruction(block, ended, cpu)) {
+                break;
+            }
+        }
+        // Failed translations are retried once their first byte changes
+        entry.generation = memory.mark_code(addr, block.length ? block.length : 1);
+        if (!block.length) {
+            return false;
+        }
+        if (!ended) {
+            emit_exit(block.out, cpu, block.ip, block.cycles);
+        }
+        this->code_used += block.out - start;
+        entry.code = (BlockFunc)start;
+        return true;
+    }
+
+    // Data accesses of translated code. Stores return whether
+    // they changed the code of the block that made them.
+    template <typename T, bool checked>
+    static uint32_t load(C* cpu, uint32_t segment, uint32_t offset) {
+        Addr addr = cpu->addr_force(segment, offset);
+        if constexpr (checked) {
+            return addr.template read<T>();
+        }
+        else {
+            return addr.template read_nowrap<T>();
+        }
+    }
+
+    template <typename T, bool checked>
+    static bool store(C* cpu, uint32_t segment, uint32_t offset, uint32_t value, M* memory, const Block* entry) {
+        Addr addr = cpu->addr_force(segment, offset);
+        if constexpr (checked) {
+            addr.template write<T>(value);
+        }
+        else {
+            addr.template write_nowrap<T>(value);
+        }
+        return entry->generation != memory->code_generation(entry->tag - 1);
+    }
+
+    // Same condition pairs as the interpreter's Jcc handlers
+    static bool condition(C* cpu, uint32_t opcode) {
+        bool val = opcode & 1;
+        switch (opcode >> 1 & 7) {
+            default: unreachable;
+            case 0: return cpu->template cond<CondNO>(val);
+            case 1: return cpu->template cond<CondNC>(val);
+            case 2: return cpu->template cond<CondNZ>(val);
+            case 3: return cpu->template cond<CondA>(val);
+            case 4: return cpu->template cond<CondNS>(val);
+            case 5: return cpu->template cond<CondNP>(val);
+            case 6: return cpu->template cond<CondGE>(val);
+            case 7: return cpu->template cond<CondG>(val);
+        }
+    }
+
+    template <typename T>
+    static inline int32_t field(C& cpu, const T& member) {
+        return (const uint8_t*)&member - (const uint8_t*)&cpu;
+    }
+
+    static inline int32_t word_reg(C& cpu, uint8_t index) {
+        return field(cpu, cpu.index_word_reg_raw(index));
+    }
+
+    static inline int32_t byte_reg(C& cpu, uint8_t index) {
+        return field(cpu, cpu.template index_byte_regR<true>(index));
+    }
+
+    static inline void emit(uint8_t*& out, std::initializer_list<uint8_t> bytes) {
+        for (uint8_t byte : bytes) {
+            *out++ = byte;
+        }
+    }
+
+    template <typename T>
+    static inline void emit_value(uint8_t*& out, T value) {
+        memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+
+    // op reg, [rbx+disp32]
+    static inline void emit_rbx(uint8_t*& out, std::initializer_list<uint8_t> op, uint8_t reg, int32_t disp) {
+        emit(out, op);
+        *out++ = 0x83 | reg << 3;
+        emit_value(out, disp);
+    }
+
+    // MOVZX reg, [rbx+disp32]
+    static inline void emit_load(uint8_t*& out, bool word, uint8_t reg, int32_t disp) {
+        emit_rbx(out, { 0x0F, (uint8_t)(word ? 0xB7 : 0xB6) }, reg, disp);
+    }
+
+    // MOV [rbx+disp32], reg
+    static inline void emit_store(uint8_t*& out, bool word, uint8_t reg, int32_t disp) {
+        if (word) {
+            emit_rbx(out, { 0x66, 0x89 }, reg, disp);
+        }
+        else {
+            emit_rbx(out, { 0x88 }, reg, disp);
+        }
+    }
+
+    // MOV [rbx+disp32], imm
+    static inline void emit_store_imm(uint8_t*& out, bool word, int32_t disp, uint16_t imm) {
+        if (word) {
+            emit_rbx(out, { 0x66, 0xC7 }, 0, disp);
+            emit_value<uint16_t>(out, imm);
+        }
+        else {
+            emit_rbx(out, { 0xC6 }, 0, disp);
+            emit_value<uint8_t>(out, imm);
+        }
+    }
+
+    // Returns from the block with IP at ip
+    static inline void emit_exit(uint8_t*& out, C& cpu, uint16_t ip, uint32_t cycles) {
+        emit_store_imm(out, true, field(cpu, cpu.ip), ip);
+        *out++ = 0xB8; // MOV EAX, imm32
+        emit_value(out, cycles);
+        emit(out, {
+            0x41, 0x5D, // POP R13
+            0x41, 0x5C, // POP R12
+            0x5B,       // POP RBX
+            0xC3        // RET
+        });
+    }
+
+    // Calls func(cpu, ESI, EDX, ECX, R8, R9)
+    static inline void emit_call(uint8_t*& out, const void* func) {
+        emit(out, { 0x48, 0x89, 0xDF }); // MOV RDI, RBX
+        emit(out, { 0x48, 0xB8 }); // MOV RAX, imm64
+        emit_value(out, func);
+        emit(out, { 0xFF, 0xD0 }); // CALL RAX
+    }
+
+    // EAX = segment:EDX
+    static inline void emit_load_call(uint8_t*& out, bool word, uint8_t segment, bool checked) {
+        *out++ = 0xBE; // MOV ESI, imm32
+        emit_value<uint32_t>(out, segment);
+        if (!word) {
+            emit_call(out, (const void*)&load<uint8_t, true>);
+        }
+        else if (checked) {
+            emit_call(out, (const void*)&load<uint16_t, true>);
+        }
+        else {
+            emit_call(out, (const void*)&load<uint16_t, false>);
+        }
+    }
+
+    // segment:EDX = ECX, then leaves the block at the
+    // next instruction if that rewrote the block
+    static inline void emit_store_call(Translation& block, C& cpu, bool word, uint8_t segment, bool checked, uint16_t next_ip, uint32_t cycles) {
+        uint8_t*& out = block.out;
+        *out++ = 0xBE; // MOV ESI, imm32
+        emit_value<uint32_t>(out, segment);
+        emit(out, { 0x4D, 0x89, 0xE0 }); // MOV R8, R12
+        emit(out, { 0x49, 0xB9 }); // MOV R9, imm64
+        emit_value(out, (const Block*)block.entry);
+        if (!word) {
+            emit_call(out, (const void*)&store<uint8_t, true>);
+        }
+        else if (checked) {
+            emit_call(out, (const void*)&store<uint16_t, true>);
+        }
+        else {
+            emit_call(out, (const void*)&store<uint16_t, false>);
+        }
+        emit(out, { 0x84, 0xC0, 0x74, 0x00 }); // TEST AL, AL; JZ rel8
+        uint8_t* skip = out;
+        emit_exit(out, cpu, next_ip, cycles);
+        skip[-1] = out - skip;
+    }
+
+    // Leaves the offset of a ModRM memory operand in EDX
+    // and returns its default segment
+    static inline uint8_t emit_ea(uint8_t*& out, C& cpu, uint8_t modrm, uint16_t disp) {
+        constexpr uint8_t EAX = 0, EDX = 2;
+        static constexpr uint8_t first_reg16[] = { BX, BX, BP, BP, SI, DI, BP, BX };
+        uint8_t mod = modrm >> 6;
+        uint8_t m = modrm & 7;
+        if (mod == 0 && m == 6) {
+            *out++ = 0xBA; // MOV EDX, imm32
+            emit_value<uint32_t>(out, disp);
+            return DS;
+        }
+        emit_load(out, true, EDX, word_reg(cpu, first_reg16[m]));
+        if (m < 4) {
+            emit_load(out, true, EAX, word_reg(cpu, SI | (m & 1)));
+            emit(out, { 0x01, 0xC2 }); // ADD EDX, EAX
+        }
+        if (disp) {
+            emit(out, { 0x81, 0xC2 }); // ADD EDX, imm32
+            emit_value<uint32_t>(out, disp);
+        }
+        if (m < 4 || disp) {
+            emit(out, { 0x0F, 0xB7, 0xD2 }); // MOVZX EDX, DX
+        }
+        return m == 2 || m == 3 || m == 6 ? SS : DS;
+    }
+
+    // ADD/SUB/CMP of ECX into EAX with the result in EDX, leaving
+    // the same lazy flag state as the interpreter
+    static inline void emit_arith(uint8_t*& out, C& cpu, uint8_t lazy_op, bool word) {
+        constexpr uint8_t EAX = 0, ECX = 1, EDX = 2;
+        emit(out, { 0x89, 0xC2 }); // MOV EDX, EAX
+        if (lazy_op == C::LazyAdd) {
+            emit(out, { 0x01, 0xCA }); // ADD EDX, ECX
+        }
+        else {
+            emit(out, { 0x29, 0xCA }); // SUB EDX, ECX
+        }
+        emit(out, { 0x0F, (uint8_t)(word ? 0xB7 : 0xB6), 0xD2 }); // MOVZX EDX, DX/DL
+        emit_store_imm(out, false, field(cpu, cpu.lazy_op), lazy_op);
+        emit_store(out, true, EAX, field(cpu, cpu.lazy_dst));
+        emit_store(out, true, ECX, field(cpu, cpu.lazy_src));
+        emit_store(out, true, EDX, field(cpu, cpu.lazy_res));
+        emit_store_imm(out, true, field(cpu, cpu.lazy_msb), word ? 0x8000 : 0x80);
+    }
+
+    // Bytes taken by a 16-bit ModRM and its displacement
+    static inline size_t modrm_length(uint8_t modrm) {
+        switch (modrm >> 6) {
+            default: unreachable;
+            case 0: return (modrm & 7) == 6 ? 3 : 1;
+            case 1: return 2;
+            case 2: return 3;
+            case 3: return 1;
+        }
+    }
+
+    static inline uint16_t modrm_disp(const uint8_t* code, uint8_t modrm) {
+        switch (modrm >> 6) {
+            default: unreachable;
+            case 0:
+                if ((modrm & 7) != 6) {
+                    return 0;
+                }
+            case 2:
+                return code[1] | code[2] << 8;
+            case 1:
+                return (int8_t)code[1];
+        }
+    }
+
+    // Displacement only operands that can't cross the segment end
+    static inline bool proven_no_wrap(uint8_t modrm, uint16_t disp, bool word) {
+        return modrm >> 6 == 0 && (modrm & 7) == 6 && (!word || disp != 0xFFFF);
+    }
+
+    // Emits the guest instruction at block.ip, returns false if it can't be
+    // translated. Sets ended for branches, which emit their own exits.
+    static inline bool translate_instruction(Translation& block, bool& ended, C& cpu) {
+        constexpr uint8_t EAX = 0, ECX = 1, EDX = 2;
+        const uint8_t* code = block.code + block.length;
+        size_t avail = block.limit - block.length;
+        if (!avail) {
+            return false;
+        }
+        auto read_word = [&](size_t index) {
+            return (uint16_t)(code[index] | code[index + 1] << 8);
+        };
+        uint8_t*& out = block.out;
+        uint8_t opcode = code[0];
+        size_t length;
+        uint32_t cycles = C::cycles.reg[opcode];
+        switch (opcode) {
+            default:
+                return false;
+            case 0x90: // NOP
+                length = 1;
+                break;
+            case 0xB0: case 0xB1: case 0xB2: case 0xB3: case 0xB4: case 0xB5: case 0xB6: case 0xB7: // MOV reg, Ib
+                length = 2;
+                if (avail < length) {
+                    return false;
+                }
+                emit_store_imm(out, false, byte_reg(cpu, opcode & 7), code[1]);
+                break;
+            case 0xB8: case 0xB9: case 0xBA: case 0xBB: case 0xBC: case 0xBD: case 0xBE: case 0xBF: // MOV reg, Iv
+                length = 3;
+                if (avail < length) {
+                    return false;
+                }
+                emit_store_imm(out, true, word_reg(cpu, opcode & 7), read_word(1));
+                break;
+            case 0x91: case 0x92: case 0x93: case 0x94: case 0x95: case 0x96: case 0x97: // XCHG AX, reg
+                length = 1;
+                emit_load(out, true, EAX, word_reg(cpu, 0));
+                emit_load(out, true, ECX, word_reg(cpu, opcode & 7));
+                emit_store(out, true, ECX, word_reg(cpu, 0));
+                emit_store(out, true, EAX, word_reg(cpu, opcode & 7));
+                break;
+            case 0x88: case 0x89: case 0x8A: case 0x8B: // MOV Mb, Rb; MOV Mv, Rv; MOV Rb, Mb; MOV Rv, Mv
+            case 0x00: case 0x01: case 0x02: case 0x03: // ADD
+            case 0x28: case 0x29: case 0x2A: case 0x2B: // SUB
+            case 0x38: case 0x39: case 0x3A: case 0x3B: { // CMP
+                if (avail < 2) {
+                    return false;
+                }
+                uint8_t modrm = code[1];
+                length = 1 + modrm_length(modrm);
+                if (avail < length) {
+                    return false;
+                }
+                bool word = opcode & 1;
+                bool to_reg = opcode & 2;
+                auto reg = word ? word_reg : byte_reg;
+                uint8_t lazy_op = opcode < 0x28 ? C::LazyAdd : C::LazySub;
+                bool writes = opcode < 0x38 || opcode >= 0x88;
+                if (modrm >> 6 == 3) {
+                    int32_t dst = reg(cpu, modrm & 7);
+                    int32_t src = reg(cpu, modrm >> 3 & 7);
+                    if (to_reg) {
+                        std::swap(dst, src);
+                    }
+                    if (opcode >= 0x88) {
+                        emit_load(out, word, EAX, src);
+                        emit_store(out, word, EAX, dst);
+                        break;
+                    }
+                    emit_load(out, word, EAX, dst);
+                    emit_load(out, word, ECX, src);
+                    emit_arith(out, cpu, lazy_op, word);
+                    if (writes) {
+                        emit_store(out, word, EDX, dst);
+                    }
+                    break;
+                }
+                cycles = C::cycles.mem[opcode] + C::cycles.ea[modrm >> 6][modrm & 7];
+                uint16_t disp = modrm_disp(code + 1, modrm);
+                bool checked = !proven_no_wrap(modrm, disp, word);
+                int32_t r = reg(cpu, modrm >> 3 & 7);
+                uint8_t segment = emit_ea(out, cpu, modrm, disp);
+                if (opcode >= 0x88) {
+                    if (to_reg) {
+                        emit_load_call(out, word, segment, checked);
+                        emit_store(out, word, EAX, r);
+                    }
+                    else {
+                        emit_load(out, word, ECX, r);
+                        emit_store_call(block, cpu, word, segment, checked, block.ip + length, block.cycles + cycles);
+                    }
+                    break;
+                }
+                if (to_reg) {
+                    emit_load_call(out, word, segment, checked);
+                    emit(out, { 0x89, 0xC1 }); // MOV ECX, EAX
+                    emit_load(out, word, EAX, r);
+                    emit_arith(out, cpu, lazy_op, word);
+                    if (writes) {
+                        emit_store(out, word, EDX, r);
+                    }
+                    break;
+                }
+                emit(out, { 0x41, 0x89, 0xD5 }); // MOV R13D, EDX
+                emit_load_call(out, word, segment, checked);
+                emit_load(out, word, ECX, r);
+                emit_arith(out, cpu, lazy_op, word);
+                if (writes) {
+                    emit(out, { 0x89, 0xD1 }); // MOV ECX, EDX
+                    emit(out, { 0x44, 0x89, 0xEA }); // MOV EDX, R13D
+                    emit_store_call(block, cpu, word, segment, checked, block.ip + length, block.cycles + cycles);
+                }
+                break;
+            }
+            case 0x04: case 0x2C: case 0x3C: // ADD/SUB/CMP AL, Ib
+            case 0x05: case 0x2D: case 0x3D: { // ADD/SUB/CMP AX, Iv
+                bool word = opcode & 1;
+                length = word ? 3 : 2;
+                if (avail < length) {
+                    return false;
+                }
+                emit_load(out, word, EAX, word_reg(cpu, AX));
+                *out++ = 0xB9; // MOV ECX, imm32
+                emit_value<uint32_t>(out, word ? read_word(1) : code[1]);
+                emit_arith(out, cpu, opcode < 0x28 ? C::LazyAdd : C::LazySub, word);
+                if (opcode < 0x38) {
+                    emit_store(out, word, EDX, word_reg(cpu, AX));
+                }
+                break;
+            }
+            case 0x80: case 0x81: case 0x83: // GRP1
+            case 0xC6: case 0xC7: { // MOV Mb, Ib; MOV Mv, Iv
+                if (avail < 2) {
+                    return false;
+                }
+                uint8_t modrm = code[1];
+                uint8_t r = modrm >> 3 & 7;
+                if (opcode >= 0xC6 ? r != 0 : r != 0 && r != 5 && r != 7) {
+                    return false;
+                }
+                size_t imm_index = 1 + modrm_length(modrm);
+                bool word = opcode & 1;
+                length = imm_index + (opcode == 0x81 || opcode == 0xC7 ? 2 : 1);
+                if (avail < length) {
+                    return false;
+                }
+                uint16_t imm = opcode == 0x83 ? (uint16_t)(int8_t)code[imm_index] : word ? read_word(imm_index) : code[imm_index];
+                uint8_t lazy_op = r == 0 ? C::LazyAdd : C::LazySub;
+                bool writes = r != 7;
+                if (modrm >> 6 == 3) {
+                    int32_t dst = word ? word_reg(cpu, modrm & 7) : byte_reg(cpu, modrm & 7);
+                    if (opcode >= 0xC6) {
+                        emit_store_imm(out, word, dst, imm);
+                        break;
+                    }
+                    emit_load(out, word, EAX, dst);
+                    *out++ = 0xB9; // MOV ECX, imm32
+                    emit_value<uint32_t>(out, imm);
+                    emit_arith(out, cpu, lazy_op, word);
+                    if (writes) {
+                        emit_store(out, word, EDX, dst);
+                    }
+                    break;
+                }
+                cycles = C::cycles.mem[opcode] + C::cycles.ea[modrm >> 6][modrm & 7];
+                uint16_t disp = modrm_disp(code + 1, modrm);
+                bool checked = !proven_no_wrap(modrm, disp, word);
+                uint8_t segment = emit_ea(out, cpu, modrm, disp);
+                if (opcode >= 0xC6) {
+                    *out++ = 0xB9; // MOV ECX, imm32
+                    emit_value<uint32_t>(out, imm);
+                    emit_store_call(block, cpu, word, segment, checked, block.ip + length, block.cycles + cycles);
+                    break;
+                }
+                emit(out, { 0x41, 0x89, 0xD5 }); // MOV R13D, EDX
+                emit_load_call(out, word, segment, checked);
+                *out++ = 0xB9; // MOV ECX, imm32
+                emit_value<uint32_t>(out, imm);
+                emit_arith(out, cpu, lazy_op, word);
+                if (writes) {
+                    emit(out, { 0x89, 0xD1 }); // MOV ECX, EDX
+                    emit(out, { 0x44, 0x89, 0xEA }); // MOV EDX, R13D
+                    emit_store_call(block, cpu, word, segment, checked, block.ip + length, block.cycles + cycles);
+                }
+                break;
+            }
+            case 0xA0: case 0xA1: case 0xA2: case 0xA3: { // MOV AL/AX, mem; MOV mem, AL/AX
+                length = 3;
+                if (avail < length) {
+                    return false;
+                }
+                bool word = opcode & 1;
+                uint16_t disp = read_word(1);
+                bool checked = !proven_no_wrap(0x06, disp, word);
+                *out++ = 0xBA; // MOV EDX, imm32
+                emit_value<uint32_t>(out, disp);
+                if (opcode < 0xA2) {
+                    emit_load_call(out, word, DS, checked);
+                    emit_store(out, word, EAX, word_reg(cpu, AX));
+                }
+                else {
+                    emit_load(out, word, ECX, word_reg(cpu, AX));
+                    emit_store_call(block, cpu, word, DS, checked, block.ip + length, block.cycles + cycles);
+                }
+                break;
+            }
+            case 0x70: case 0x71: case 0x72: case 0x73: case 0x74: case 0x75: case 0x76: case 0x77: // Jcc Jb
+            case 0x78: case 0x79: case 0x7A: case 0x7B: case 0x7C: case 0x7D: case 0x7E: case 0x7F:
+            case 0xE2: { // LOOP Jb
+                length = 2;
+                if (avail < length) {
+                    return false;
+                }
+                if (opcode == 0xE2) {
+                    emit_rbx(out, { 0x66, 0xFF }, 1, word_reg(cpu, CX)); // DEC WORD [rbx+disp32]
+                    emit(out, { 0x74, 0x00 }); // JZ rel8
+                }
+                else {
+                    *out++ = 0xBE; // MOV ESI, imm32
+                    emit_value<uint32_t>(out, opcode);
+                    emit_call(out, (const void*)&condition);
+                    emit(out, { 0x84, 0xC0, 0x74, 0x00 }); // TEST AL, AL; JZ rel8
+                }
+                uint8_t* skip = out;
+                uint16_t next_ip = block.ip + length;
+                emit_exit(out, cpu, next_ip + (int8_t)code[1], block.cycles + cycles + C::cycles.branch_taken);
+                skip[-1] = out - skip;
+                emit_exit(out, cpu, next_ip, block.cycles + cycles);
+                ended = true;
+                break;
+            }
+            case 0xE9: case 0xEB: { // JMP Jz; JMP Jb
+                length = opcode == 0xE9 ? 3 : 2;
+                if (avail < length) {
+                    return false;
+                }
+                uint16_t next_ip = block.ip + length;
+                emit_exit(out, cpu, next_ip + (opcode == 0xE9 ? read_word(1) : (int8_t)code[1]), block.cycles + cycles);
+                ended = true;
+                break;
+            }
+        }
+        block.length += length;
+        block.ip += length;
+        block.cycles += cycles;
+        return true;
+    }
+};
+
+template <typename C, typename M, size_t entries, size_t code_size>
+struct z86Jit<C, M, entries, code_size, false> {
+    inline bool init() {
+        return true;
+    }
+
+    inline bool regcall execute(size_t addr, uint16_t ip, C& cpu, M& memory) {
+        return false;
+    }
+};
+
+#endif
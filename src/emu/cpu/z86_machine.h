@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef Z86_MACHINE_H
+#define Z86_MACHINE_H 1
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "8086_cpu.h"
+
+// One emulated PC. Every CPU model has its own build of the core
+// and execute loop behind this, so the model is picked when the
+// machine is created and never checked while it runs. Methods
+// match the z86_* functions of the same name and have to be
+// called with the machine selected.
+struct z86Machine {
+    virtual ~z86Machine() {}
+
+    // Makes this the machine its model's core uses on the calling thread
+    virtual void select() = 0;
+
+    virtual size_t mem_write(size_t dst, const void* src, size_t size) = 0;
+    virtual size_t mem_read(void* dst, size_t src, size_t size) = 0;
+    virtual void map_memory_device(MemoryDevice* device, size_t first, size_t length) = 0;
+    virtual void map_ram(size_t first, size_t length) = 0;
+    virtual bool set_memory_size(size_t bytes) = 0;
+    virtual void set_a20(bool enabled) = 0;
+    virtual bool a20() = 0;
+    virtual void map_rom(size_t first, const void* data, size_t length) = 0;
+    virtual void load_rom(size_t first, const void* data, size_t length) = 0;
+    virtual void add_dword_device(PortDwordDevice* device) = 0;
+    virtual void add_word_device(PortWordDevice* device) = 0;
+    virtual void add_byte_device(PortByteDevice* device) = 0;
+    virtual bool map_dword_ports(PortDwordDevice* device, uint16_t first, uint16_t last, uint16_t stride) = 0;
+    virtual bool map_word_ports(PortWordDevice* device, uint16_t first, uint16_t last, uint16_t stride) = 0;
+    virtual bool map_byte_ports(PortByteDevice* device, uint16_t first, uint16_t last, uint16_t stride) = 0;
+    virtual size_t unhandled_port_accesses() = 0;
+    virtual void reset() = 0;
+    virtual void jump(uint16_t cs, uint16_t ip) = 0;
+    virtual void get_registers(z86Registers& registers) = 0;
+    virtual void nmi() = 0;
+    virtual void interrupt(uint8_t number) = 0;
+    virtual void cancel_interrupt() = 0;
+    virtual void stop() = 0;
+    virtual uint32_t run_events() = 0;
+    virtual size_t clock() = 0;
+    virtual uint32_t schedule(size_t clock, SchedulerCallback callback, void* data) = 0;
+    virtual bool deschedule(uint32_t id) = 0;
+    virtual void init() = 0;
+    virtual size_t run_until(uint32_t events, size_t cycles) = 0;
+};
+
+// Defined by each model's build of 8086.cpp, NULL when out of memory
+z86Machine* z86_new_machine_8086();
+z86Machine* z86_new_machine_80186();
+z86Machine* z86_new_machine_v30();
+z86Machine* z86_new_machine_80286();
+z86Machine* z86_new_machine_80386();
+
+#endif
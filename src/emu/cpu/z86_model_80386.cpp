@@ -0,0 +1,4 @@
+// Execute loop and core built for the 80386
+#define Z86_MODEL z80386
+#define Z86_MODEL_FACTORY z86_new_machine_80386
+#include "8086.cpp"
@@ -0,0 +1,4 @@
+// Execute loop and core built for the NEC V30
+#define Z86_MODEL zNV30
+#define Z86_MODEL_FACTORY z86_new_machine_v30
+#include "8086.cpp"
@@ -0,0 +1,125 @@
+#pragma once
+
+#ifndef Z86_PORTS_H
+#define Z86_PORTS_H 1
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "8086_cpu.h"
+#include "../zero/util.h"
+
+// Port number to device lookup for one access width.
+//
+// Ports mapped explicitly always go straight to their device.
+// Any other port caches which device handled it, found the first
+// time the port is accessed by asking every probed device in order.
+// Either way an access is a single indirect call. Ports nobody claims
+// map to a default constructed device, whose handlers all return false.
+template <typename D>
+struct z86PortMap {
+    // 0 means not probed yet, 1 is the unhandled device
+    static inline constexpr size_t first_device = 2;
+    static inline constexpr size_t max_devices = UINT8_MAX + 1 - first_device;
+
+    D* slots[UINT8_MAX + 1];
+    uint8_t out_index[0x10000];
+    uint8_t in_index[0x10000];
+    uint8_t mapped[0x10000];
+    uint8_t probe[max_devices];
+    size_t device_count;
+    size_t probe_count;
+    size_t unhandled;
+    D none;
+
+    inline z86PortMap() {
+        this->slots[0] = NULL;
+        this->slots[1] = &this->none;
+        this->device_count = 0;
+        this->probe_count = 0;
+        this->unhandled = 0;
+        memset(this->mapped, 0, sizeof(this->mapped));
+        this->flush();
+    }
+
+    inline void flush() {
+        memcpy(this->out_index, this->mapped, sizeof(this->mapped));
+        memcpy(this->in_index, this->mapped, sizeof(this->mapped));
+    }
+
+    // Returns 0 when out of slots
+    inline uint8_t slot(D* device) {
+        for (size_t i = first_device; i < first_device + this->device_count; ++i) {
+            if (this->slots[i] == device) {
+                return i;
+            }
+        }
+        if (this->device_count == max_devices) {
+            return 0;
+        }
+        size_t i = first_device + this->device_count++;
+        this->slots[i] = device;
+        return i;
+    }
+
+    // Device is asked about every port that isn't mapped
+    inline bool add(D* device) {
+        uint8_t i = this->slot(device);
+        if (!i) {
+            return false;
+        }
+        this->probe[this->probe_count++] = i;
+        // Ports that were already probed might belong to the new device
+        this->flush();
+        return true;
+    }
+
+    // Routes first, first + stride, ... up to last to device
+    inline bool map(D* device, uint16_t first, uint16_t last, uint16_t stride) {
+        uint8_t i = this->slot(device);
+        if (!i || !stride) {
+            return false;
+        }
+        for (size_t port = first; port <= last; port += stride) {
+            this->mapped[port] = i;
+            this->out_index[port] = i;
+            this->in_index[port] = i;
+        }
+        return true;
+    }
+
+    template <typename F>
+    inline bool regcall dispatch(uint8_t* index, uint16_t port, const F& func) {
+        if (D* device = this->slots[index[port]]) {
+            if (expect(func(device), true)) {
+                return true;
+            }
+            ++this->unhandled;
+            return false;
+        }
+        for (size_t i = 0; i < this->probe_count; ++i) {
+            if (func(this->slots[this->probe[i]])) {
+                index[port] = this->probe[i];
+                return true;
+            }
+        }
+        index[port] = 1;
+        ++this->unhandled;
+        return false;
+    }
+
+    template <typename F>
+    inline bool regcall out(uint16_t port, const F& func) {
+        return this->dispatch(this->out_index, port, func);
+    }
+
+    template <typename F>
+    inline bool regcall in(uint16_t port, const F& func) {
+        return this->dispatch(this->in_index, port, func);
+    }
+};
+
+#endif
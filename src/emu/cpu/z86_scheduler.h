@@ -0,0 +1,129 @@
+#pragma once
+
+#ifndef Z86_SCHEDULER_H
+#define Z86_SCHEDULER_H 1
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "8086_cpu.h"
+#include "../zero/util.h"
+
+// Min-heap of device callbacks keyed on the CPU clock.
+//
+// The execute loop only compares the clock against deadline,
+// which is the earlier of the first event and the end of the
+// current slice, so nothing is polled per instruction.
+// Requests from outside the loop raise attention, which pulls
+// the deadline in to 0 until the next poll.
+struct z86Scheduler {
+    struct Event {
+        size_t when;
+        uint32_t id;
+        SchedulerCallback callback;
+        void* data;
+
+        inline bool operator<(const Event& rhs) const {
+            // Reversed for a min-heap, ties fire in scheduling order
+            return this->when != rhs.when ? this->when > rhs.when : this->id > rhs.id;
+        }
+    };
+
+    std::vector<Event> queue;
+    std::vector<Event> due;
+    std::atomic<size_t> deadline = SIZE_MAX;
+    std::atomic<bool> attention = false;
+    size_t slice_end = SIZE_MAX;
+    uint32_t last_id = 0;
+
+    inline size_t next_event() const {
+        return !this->queue.empty() ? this->queue.front().when : SIZE_MAX;
+    }
+
+    // The store and load have to stay ordered against
+    // raise_attention on another thread
+    inline void set_deadline(size_t when) {
+        this->deadline = when;
+        if (this->attention) {
+            this->deadline = 0;
+        }
+    }
+
+    inline void update_deadline() {
+        this->set_deadline((std::min)(this->slice_end, this->next_event()));
+    }
+
+    // Safe from any thread
+    inline void raise_attention() {
+        this->attention = true;
+        this->deadline = 0;
+    }
+
+    inline void begin_slice(size_t end) {
+        this->slice_end = end;
+        this->update_deadline();
+    }
+
+    inline uint32_t schedule(size_t when, SchedulerCallback callback, void* data) {
+        uint32_t id = ++this->last_id;
+        if (expect(!id, false)) {
+            id = ++this->last_id;
+        }
+        this->queue.push_back({ when, id, callback, data });
+        std::push_heap(this->queue.begin(), this->queue.end());
+        if (when < this->deadline.load(std::memory_order_relaxed)) {
+            this->set_deadline(when);
+        }
+        return id;
+    }
+
+    inline bool cancel(uint32_t id) {
+        auto it = std::find_if(this->queue.begin(), this->queue.end(), [=](const Event& event) {
+            return event.id == id;
+        });
+        if (it == this->queue.end()) {
+            // Might be in the batch poll is firing
+            for (Event& event : this->due) {
+                if (event.id == id && event.callback) {
+                    event.callback = NULL;
+                    return true;
+                }
+            }
+            return false;
+        }
+        *it = this->queue.back();
+        this->queue.pop_back();
+        std::make_heap(this->queue.begin(), this->queue.end());
+        this->update_deadline();
+        return true;
+    }
+
+    // Fires everything due by clock and returns
+    // whether the current slice has time left
+    inline bool regcall poll(size_t clock) {
+        this->attention = false;
+        // Events scheduled by the callbacks wait for the next poll,
+        // even when already due, so a callback that keeps
+        // rescheduling itself can't hold up the CPU
+        while (!this->queue.empty() && this->queue.front().when <= clock) {
+            std::pop_heap(this->queue.begin(), this->queue.end());
+            this->due.push_back(this->queue.back());
+            this->queue.pop_back();
+        }
+        for (size_t i = 0; i < this->due.size(); ++i) {
+            Event event = this->due[i];
+            if (event.callback) {
+                event.callback(event.data, clock);
+            }
+        }
+        this->due.clear();
+        this->update_deadline();
+        return clock < this->slice_end;
+    }
+};
+
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef Z86_TLB_H
+#define Z86_TLB_H 1
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <bit>
+
+#include "../zero/util.h"
+
+// Direct mapped cache of linear page translations.
+//
+// Entries hold the host memory behind the physical page so a hit
+// never touches the page tables or the memory map. Reads and writes
+// are cached separately since a write has to set the dirty bit and
+// may be refused on a page that can still be read.
+template <size_t entries>
+struct z86Tlb {
+    static_assert(std::has_single_bit(entries));
+
+    static inline constexpr size_t page_bits = 12;
+    static inline constexpr size_t page_mask = ((size_t)1 << page_bits) - 1;
+
+    struct Entry {
+        size_t tag; // Linear page + 1, 0 when empty
+        size_t phys; // Physical address of the page
+        uint8_t* host; // NULL when a device handles the page
+        bool user; // Whether CPL 3 is allowed the access
+    };
+
+    Entry read[entries];
+    Entry write[entries];
+
+    static inline constexpr size_t regcall tag(size_t addr) {
+        return (addr >> page_bits) + 1;
+    }
+
+    inline Entry& regcall read_entry(size_t addr) {
+        return this->read[(addr >> page_bits) & (entries - 1)];
+    }
+
+    inline Entry& regcall write_entry(size_t addr) {
+        return this->write[(addr >> page_bits) & (entries - 1)];
+    }
+
+    static inline bool regcall hit(const Entry& entry, size_t addr, bool user) {
+        return entry.tag == tag(addr) && (entry.user || !user);
+    }
+
+    inline void flush() {
+        memset(this->read, 0, sizeof(this->read));
+        memset(this->write, 0, sizeof(this->write));
+    }
+
+    inline void regcall flush_page(size_t addr) {
+        Entry& read = this->read_entry(addr);
+        if (read.tag == tag(addr)) {
+            read.tag = 0;
+        }
+        Entry& write = this->write_entry(addr);
+        if (write.tag == tag(addr)) {
+            write.tag = 0;
+        }
+    }
+};
+
+#endif
@@ -6,9 +6,18 @@ class HW_8255 : public PortByteDevice {
         bool out_byte(uint32_t port, uint8_t value);
         bool in_byte(uint8_t& value, uint32_t port);
 
+        // System port mapping, the bus routes these
+        // to the device so it only decodes the register
+        enum {
+            first_port = 0x31,
+            last_port = 0x37,
+            port_stride = 2
+        };
+
         enum {
             port_a = 0x0,
             port_b = 0x1,
-            port_c = 0x2 
+            port_c = 0x2,
+            control = 0x3
         };
 };
\ No newline at end of file
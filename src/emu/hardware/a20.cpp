@@ -0,0 +1,20 @@
+#include "a20.h"
+
+bool HW_A20::out_byte(uint32_t port, uint8_t value) {
+    if (port == enable_port) {
+        z86_set_a20(true);
+    }
+    else {
+        switch (value) {
+            case 0x02: z86_set_a20(true); break;
+            case 0x03: z86_set_a20(false); break;
+        }
+    }
+    return true;
+}
+
+bool HW_A20::in_byte(uint8_t& value, uint32_t port) {
+    // Bit 0 is set while the address line is masked
+    value = 0xFE | !z86_a20();
+    return true;
+}
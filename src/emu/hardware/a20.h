@@ -0,0 +1,20 @@
+#include "../cpu/8086_cpu.h"
+
+// PC-98 A20 gate. Writing anything to F2h unmasks address
+// bit 20, F6h takes 02h to unmask it and 03h to mask it.
+class HW_A20 : public PortByteDevice {
+    public:
+        bool out_byte(uint32_t port, uint8_t value);
+        bool in_byte(uint8_t& value, uint32_t port);
+
+        enum {
+            first_port = 0xF2,
+            last_port = 0xF6,
+            port_stride = 4
+        };
+
+        enum {
+            enable_port = 0xF2,
+            control_port = 0xF6
+        };
+};
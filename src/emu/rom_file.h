@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stddef.h>
+
+// Maps a ROM image copy on write so every running instance shares
+// the page cache copy. The mapping is left open for the process.
+// Returns NULL if the file can't be mapped.
+const void* map_rom_file(const char* path, size_t& size);
@@ -1,31 +1,33 @@
 #include <stdio.h>
 #include <SDL2/SDL.h>
 
+#include <chrono>
+#include <thread>
+
 #include "emu/cpu/8086_cpu.h"
 #include "emu/hardware/8255.h"
+#include "emu/hardware/a20.h"
+#include "emu/rom_file.h"
 
 int main(int argc, char* argv[]) {
     SDL_Window* window = NULL;
     SDL_Surface* screenSurface = NULL;
 
-    // Read BIOS.ROM into memory
-    FILE* bios = fopen("BIOS.ROM", "rb");
-    
+    size_t bios_size;
+    const void* bios = map_rom_file("BIOS.ROM", bios_size);
+
     if (bios == NULL) {
         printf("BIOS.ROM not found\n");
         return 1;
     }
 
-    fseek(bios, 0, SEEK_END);
-    size_t bios_size = ftell(bios);
-    fseek(bios, 0, SEEK_SET);
-
-    uint8_t* bios_data = (uint8_t*)malloc(bios_size);
-    fread(bios_data, 1, bios_size, bios);
+    z86_map_rom(0xE8000, bios, bios_size);
 
-    fclose(bios);
-
-    z86_mem_write(0xE8000, bios_data, bios_size);
+    // Optional sound board BIOS
+    size_t sound_size;
+    if (const void* sound = map_rom_file("SOUND.ROM", sound_size)) {
+        z86_map_rom(0xCC000, sound, sound_size);
+    }
 
 
     // uint8_t program[] = {
@@ -36,9 +38,26 @@ int main(int argc, char* argv[]) {
 
     PortByteDevice* device = new HW_8255();
 
-    z86_add_byte_device(device);
+    z86_map_byte_ports(device, HW_8255::first_port, HW_8255::last_port, HW_8255::port_stride);
 
-    z86_execute();
+    PortByteDevice* a20 = new HW_A20();
+
+    z86_map_byte_ports(a20, HW_A20::first_port, HW_A20::last_port, HW_A20::port_stride);
+
+    z86_init();
+
+    // 8 MHz at the 56.4 Hz refresh rate, the host
+    // gets control back between frames
+    const size_t cycles_per_frame = 8000000 * 10 / 564;
+    const auto frame_time = std::chrono::microseconds(1000000 * 10 / 564);
+    auto next_frame = std::chrono::steady_clock::now();
+    for (;;) {
+        z86_run(cycles_per_frame);
+        // A halted guest finishes its slice early, so
+        // pace to real time instead of spinning
+        next_frame += frame_time;
+        std::this_thread::sleep_until(next_frame);
+    }
 
     // printf("%s", cpu.GetRegisterState().c_str());
 